@@ -0,0 +1,193 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/async_sink.h"
+
+#include <array>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "rst/check/check.h"
+#include "rst/strings/format.h"
+#include "rst/threading/notification.h"
+
+namespace rst {
+
+AsyncSink::Item::Item(const LogLevel level, const std::string_view message)
+    : level(level) {
+  if (message.size() <= kInlineMessageSize) {
+    inline_size = static_cast<uint32_t>(message.size());
+    std::memcpy(inline_message, message.data(), message.size());
+  } else {
+    long_message = message;
+  }
+}
+
+AsyncSink::Item::Item(Item&& other) noexcept { *this = std::move(other); }
+
+AsyncSink::Item& AsyncSink::Item::operator=(Item&& other) noexcept {
+  type = other.type;
+  level = other.level;
+  flushed = other.flushed;
+  inline_size = other.inline_size;
+  long_message = std::move(other.long_message);
+  std::memcpy(inline_message, other.inline_message, inline_size);
+  return *this;
+}
+
+std::string_view AsyncSink::Item::message() const {
+  if (inline_size != 0)
+    return std::string_view(inline_message, inline_size);
+  return long_message;
+}
+
+AsyncSink::AsyncSink(NotNull<std::unique_ptr<Sink>> sink,
+                     const size_t capacity, const OverflowPolicy policy)
+    : sink_(std::move(sink)), policy_(policy), queue_(capacity) {
+  thread_ = std::thread(&AsyncSink::WriteMessages, this);
+}
+
+AsyncSink::~AsyncSink() {
+  Item item;
+  item.type = Item::Type::kExit;
+  queue_.Push(std::move(item));
+  thread_.join();
+}
+
+void AsyncSink::Log(const std::string_view message) {
+  LogRecord record;
+  record.message = message;
+  Emit(record);
+}
+
+void AsyncSink::Emit(const LogRecord& record) {
+  Item item(record.level, record.message);
+  if (policy_ == OverflowPolicy::kBlock) {
+    queue_.Push(std::move(item));
+    return;
+  }
+
+  if (!queue_.TryPush(std::move(item)))
+    dropped_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AsyncSink::Flush() {
+  Notification flushed;
+
+  Item item;
+  item.type = Item::Type::kFlush;
+  item.flushed = &flushed;
+  queue_.Push(std::move(item));
+
+  flushed.WaitForNotification();
+}
+
+void AsyncSink::EmitAndFlush(const LogRecord& record) {
+  Flush();
+  sink_->EmitAndFlush(record);
+}
+
+void AsyncSink::EmergencyLog(const std::string_view message) {
+  EmergencyFlush();
+  sink_->EmergencyLog(message);
+}
+
+void AsyncSink::EmergencyFlush() {
+  while (true) {
+    // The popped items are never destroyed since freeing memory isn't
+    // async-signal-safe.
+    alignas(Item) unsigned char storage[sizeof(Item)];
+    const auto item = new (storage) Item;
+    if (!queue_.TryPop(item))
+      break;
+
+    if (item->type == Item::Type::kExit) {
+      // Leaves it for the writer thread.
+      (void)queue_.TryPush(std::move(*item));
+      break;
+    }
+    if (item->type == Item::Type::kMessage)
+      sink_->EmergencyLog(item->message());
+  }
+
+  sink_->EmergencyFlush();
+}
+
+void AsyncSink::WriteMessages() {
+  std::array<Item, kBatchSize> items;
+  uint64_t reported_count = 0;
+
+  while (true) {
+    queue_.Pop(&items[0]);
+    const auto n = 1 + queue_.TryPopBatch(&items[1], kBatchSize - 1);
+
+    if (policy_ == OverflowPolicy::kDropAndCount)
+      ReportDropped(&reported_count);
+
+    auto should_exit = false;
+    for (size_t i = 0; i < n; i++) {
+      auto& item = items[i];
+      switch (item.type) {
+        case Item::Type::kMessage: {
+          LogRecord record;
+          record.level = item.level;
+          record.message = item.message();
+          sink_->Emit(record);
+          break;
+        }
+        case Item::Type::kFlush: {
+          RST_DCHECK(item.flushed != nullptr);
+          sink_->Flush();
+          item.flushed->Notify();
+          break;
+        }
+        case Item::Type::kExit: {
+          should_exit = true;
+          break;
+        }
+      }
+      item = Item();
+    }
+
+    sink_->Flush();
+    if (should_exit)
+      return;
+  }
+}
+
+void AsyncSink::ReportDropped(const NotNull<uint64_t*> reported_count) {
+  const auto dropped_count = dropped_count_.load(std::memory_order_relaxed);
+  if (dropped_count == *reported_count)
+    return;
+
+  sink_->Log(Format("AsyncSink dropped {} messages",
+                    {dropped_count - *reported_count}));
+  *reported_count = dropped_count;
+}
+
+}  // namespace rst
@@ -0,0 +1,154 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_LOGGER_ASYNC_SINK_H_
+#define RST_LOGGER_ASYNC_SINK_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "rst/logger/sink.h"
+#include "rst/macros/macros.h"
+#include "rst/not_null/not_null.h"
+#include "rst/threading/mpmc_ring.h"
+
+namespace rst {
+
+class Notification;
+
+// The sink that moves writing to another sink off the logging threads. Log()
+// copies the message to a lock-free queue, a background writer thread takes
+// the messages in batches, passes them to the wrapped sink and flushes it once
+// per batch. Messages up to |kInlineMessageSize| bytes are stored right in the
+// queue slots, so logging them doesn't allocate.
+//
+// Example:
+//
+//   auto file_sink = FileNameSink::Create("log.txt");
+//   ...
+//   Logger logger(std::make_unique<AsyncSink>(
+//       std::move(*file_sink), 4096, AsyncSink::OverflowPolicy::kDrop));
+//
+class AsyncSink : public Sink {
+ public:
+  // What Log() does when the queue is full.
+  enum class OverflowPolicy {
+    // Waits for the writer thread to free some space.
+    kBlock,
+    // Discards the message.
+    kDrop,
+    // Discards the message and periodically logs the number of the discarded
+    // ones to the wrapped sink.
+    kDropAndCount,
+  };
+
+  static constexpr size_t kDefaultCapacity = 8192;
+  static constexpr size_t kInlineMessageSize = 192;
+
+  // Starts the writer thread. The queue capacity is rounded up to a power of
+  // two.
+  explicit AsyncSink(NotNull<std::unique_ptr<Sink>> sink,
+                     size_t capacity = kDefaultCapacity,
+                     OverflowPolicy policy = OverflowPolicy::kBlock);
+  // Writes all the queued messages and stops the writer thread.
+  ~AsyncSink() final;
+
+  // Thread safe logging functions.
+  void Log(std::string_view message) final;
+  void Emit(const LogRecord& record) final;
+
+  // Blocks until all the messages logged before the call are written to the
+  // wrapped sink and it's flushed.
+  void Flush() final;
+
+  // Writes all the queued messages and passes |record| to the wrapped sink's
+  // EmitAndFlush() from the calling thread regardless of the overflow policy,
+  // so the record keeps its metadata.
+  void EmitAndFlush(const LogRecord& record) final;
+
+  // Write out the queued messages through the wrapped sink's EmergencyLog()
+  // from the calling thread.
+  void EmergencyLog(std::string_view message) final;
+  void EmergencyFlush() final;
+
+  // Total number of the discarded messages.
+  uint64_t dropped_count() const {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Item {
+    enum class Type {
+      kMessage,
+      kFlush,
+      kExit,
+    };
+
+    Item() = default;
+    Item(LogLevel level, std::string_view message);
+    // Copy only the used part of |inline_message|.
+    Item(Item&& other) noexcept;
+    Item& operator=(Item&& other) noexcept;
+
+    std::string_view message() const;
+
+    Type type = Type::kMessage;
+    LogLevel level = LogLevel::kAll;
+    // Notified after the flush for kFlush items.
+    Nullable<Notification*> flushed;
+    // The message is either in |inline_message| or in |long_message| if it
+    // doesn't fit.
+    uint32_t inline_size = 0;
+    std::string long_message;
+    char inline_message[kInlineMessageSize];
+  };
+
+  // Maximum number of items the writer thread takes at once.
+  static constexpr size_t kBatchSize = 64;
+
+  void WriteMessages();
+  void ReportDropped(NotNull<uint64_t*> reported_count);
+
+  const NotNull<std::unique_ptr<Sink>> sink_;
+  const OverflowPolicy policy_;
+
+  MpmcRing<Item> queue_;
+  std::atomic<uint64_t> dropped_count_{0};
+
+  std::thread thread_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(AsyncSink);
+};
+
+}  // namespace rst
+
+#endif  // RST_LOGGER_ASYNC_SINK_H_
@@ -0,0 +1,236 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/async_sink.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "rst/check/check.h"
+#include "rst/logger/file_name_sink.h"
+#include "rst/logger/logger.h"
+#include "rst/macros/macros.h"
+#include "rst/threading/notification.h"
+
+namespace rst {
+namespace {
+
+// Collects the messages to an external vector that can be read after
+// AsyncSink::Flush() or the sink destruction. Optionally blocks the writer
+// thread until released.
+class CollectingSink : public Sink {
+ public:
+  explicit CollectingSink(const NotNull<std::vector<std::string>*> messages,
+                          const Nullable<Notification*> release = nullptr)
+      : messages_(messages), release_(release) {}
+
+  void Log(const std::string_view message) final {
+    if (release_ != nullptr)
+      release_->WaitForNotification();
+    messages_->emplace_back(message);
+  }
+
+  void EmitAndFlush(const LogRecord& record) final {
+    if (record.level == LogLevel::kFatal)
+      Log("FATAL " + std::string(record.message));
+  }
+
+ private:
+  const NotNull<std::vector<std::string>*> messages_;
+  const Nullable<Notification*> release_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(CollectingSink);
+};
+
+}  // namespace
+
+TEST(AsyncSink, Log) {
+  std::vector<std::string> messages;
+  AsyncSink sink(std::make_unique<CollectingSink>(&messages));
+  sink.Log("Message1");
+  sink.Log("Message2");
+  sink.Log("Message3");
+  sink.Flush();
+
+  const std::vector<std::string> expected_messages = {"Message1", "Message2",
+                                                      "Message3"};
+  EXPECT_EQ(messages, expected_messages);
+  EXPECT_EQ(sink.dropped_count(), 0U);
+}
+
+TEST(AsyncSink, Destruction) {
+  std::vector<std::string> messages;
+  {
+    AsyncSink sink(std::make_unique<CollectingSink>(&messages), 2);
+    for (auto i = 0; i < 100; i++)
+      sink.Log("Message");
+  }
+
+  EXPECT_EQ(messages, std::vector<std::string>(100, "Message"));
+}
+
+TEST(AsyncSink, LogThreadSafe) {
+  static constexpr size_t kThreadNumber = 4;
+  static constexpr size_t kMessageNumber = 1000;
+
+  std::vector<std::string> messages;
+  AsyncSink sink(std::make_unique<CollectingSink>(&messages), 16);
+
+  std::vector<std::thread> threads;
+  threads.reserve(kThreadNumber);
+  for (size_t i = 0; i < kThreadNumber; i++) {
+    threads.emplace_back([&sink, i]() {
+      for (size_t j = 0; j < kMessageNumber; j++)
+        sink.Log(std::to_string(i));
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+  sink.Flush();
+
+  ASSERT_EQ(messages.size(), kThreadNumber * kMessageNumber);
+  for (size_t i = 0; i < kThreadNumber; i++) {
+    EXPECT_EQ(std::count(messages.cbegin(), messages.cend(), std::to_string(i)),
+              static_cast<std::ptrdiff_t>(kMessageNumber));
+  }
+}
+
+TEST(AsyncSink, Drop) {
+  std::vector<std::string> messages;
+  Notification release;
+  AsyncSink sink(std::make_unique<CollectingSink>(&messages, &release), 4,
+                 AsyncSink::OverflowPolicy::kDrop);
+
+  // The writer thread takes at most one batch and blocks in the wrapped sink,
+  // the rest fills the queue.
+  for (auto i = 0; i < 100; i++)
+    sink.Log("Message");
+  release.Notify();
+  sink.Flush();
+
+  EXPECT_NE(sink.dropped_count(), 0U);
+  EXPECT_EQ(messages.size() + sink.dropped_count(), 100U);
+  for (const auto& message : messages)
+    EXPECT_EQ(message, "Message");
+}
+
+TEST(AsyncSink, DropAndCount) {
+  std::vector<std::string> messages;
+  Notification release;
+  AsyncSink sink(std::make_unique<CollectingSink>(&messages, &release), 4,
+                 AsyncSink::OverflowPolicy::kDropAndCount);
+
+  for (auto i = 0; i < 100; i++)
+    sink.Log("Message");
+  release.Notify();
+  // The report is written with the next batch.
+  sink.Log("Last");
+  sink.Flush();
+
+  const auto dropped_count = sink.dropped_count();
+  ASSERT_NE(dropped_count, 0U);
+
+  const auto report =
+      "AsyncSink dropped " + std::to_string(dropped_count) + " messages";
+  EXPECT_NE(std::find(messages.cbegin(), messages.cend(), report),
+            messages.cend());
+}
+
+TEST(AsyncSink, LogAndFlush) {
+  std::vector<std::string> messages;
+  Notification release;
+  AsyncSink sink(std::make_unique<CollectingSink>(&messages, &release), 2,
+                 AsyncSink::OverflowPolicy::kDrop);
+
+  // Fills the queue so that Log() would drop the message.
+  for (auto i = 0; i < 10; i++)
+    sink.Log("Filler");
+  std::thread thread([&release]() { release.Notify(); });
+  sink.LogAndFlush("Message");
+  thread.join();
+
+  // The queued messages go first and the fatal one reaches the wrapped sink as
+  // such.
+  ASSERT_FALSE(messages.empty());
+  EXPECT_EQ(messages.back(), "FATAL Message");
+  for (size_t i = 0; i + 1 < messages.size(); i++)
+    EXPECT_EQ(messages[i], "Filler");
+}
+
+TEST(AsyncSink, LongMessage) {
+  std::vector<std::string> messages;
+  AsyncSink sink(std::make_unique<CollectingSink>(&messages));
+
+  const std::string inline_message(AsyncSink::kInlineMessageSize, 'A');
+  const std::string long_message(AsyncSink::kInlineMessageSize + 1, 'B');
+  sink.Log(inline_message);
+  sink.Log(long_message);
+  sink.Log("");
+  sink.Flush();
+
+  const std::vector<std::string> expected_messages = {inline_message,
+                                                      long_message, ""};
+  EXPECT_EQ(messages, expected_messages);
+}
+
+TEST(AsyncSink, FatalReachesFile) {
+  char filename[L_tmpnam];
+  ASSERT_NE(std::tmpnam(filename), nullptr);
+
+  EXPECT_DEATH(
+      {
+        auto file_sink = FileNameSink::Create(filename);
+        RST_CHECK(!file_sink.err());
+        Logger logger(std::make_unique<AsyncSink>(
+            std::move(*file_sink), 2, AsyncSink::OverflowPolicy::kDrop));
+        Logger::SetGlobalLogger(&logger);
+        RST_LOG_FATAL("Fatal message");
+      },
+      "");
+
+  std::ifstream f(filename);
+  ASSERT_TRUE(f.is_open());
+  std::string line;
+  ASSERT_TRUE(std::getline(f, line));
+  EXPECT_NE(line.find("Fatal message"), std::string::npos);
+
+  f.close();
+  std::remove(filename);
+}
+
+}  // namespace rst
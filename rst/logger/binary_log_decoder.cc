@@ -0,0 +1,284 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/binary_log_decoder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "rst/logger/binary_logger.h"
+#include "rst/logger/log_error.h"
+#include "rst/logger/log_level.h"
+#include "rst/not_null/not_null.h"
+#include "rst/strings/arg.h"
+#include "rst/strings/str_cat.h"
+
+namespace rst {
+namespace {
+
+struct Site {
+  LogLevel level = LogLevel::kAll;
+  std::string_view filename;
+  int line = 0;
+  std::string_view format;
+  std::vector<internal::BinaryArgType> arg_types;
+};
+
+struct Record {
+  uint64_t timestamp = 0;
+  std::string line;
+};
+
+// Reads values from the log checking its bounds.
+class Reader {
+ public:
+  explicit Reader(const std::string_view data) : data_(data) {}
+
+  bool empty() const { return data_.empty(); }
+
+  template <class T>
+  bool Read(const NotNull<T*> value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (data_.size() < sizeof(T))
+      return false;
+    std::memcpy(value.get(), data_.data(), sizeof(T));
+    data_.remove_prefix(sizeof(T));
+    return true;
+  }
+
+  bool ReadString(const NotNull<std::string_view*> value) {
+    uint32_t size = 0;
+    if (!Read(NotNull(&size)) || data_.size() < size)
+      return false;
+    *value = data_.substr(0, size);
+    data_.remove_prefix(size);
+    return true;
+  }
+
+ private:
+  std::string_view data_;
+};
+
+bool ReadSite(const NotNull<Reader*> reader, const NotNull<Site*> site) {
+  uint8_t level = 0;
+  int32_t line = 0;
+  uint8_t arg_number = 0;
+  if (!reader->Read(NotNull(&level)) || !reader->Read(NotNull(&line)) ||
+      !reader->ReadString(&site->filename) ||
+      !reader->ReadString(&site->format) ||
+      !reader->Read(NotNull(&arg_number))) {
+    return false;
+  }
+
+  if (level <= static_cast<uint8_t>(LogLevel::kAll) ||
+      level >= static_cast<uint8_t>(LogLevel::kOff)) {
+    return false;
+  }
+  site->level = static_cast<LogLevel>(level);
+  site->line = line;
+
+  site->arg_types.resize(arg_number);
+  for (auto& type : site->arg_types) {
+    uint8_t value = 0;
+    if (!reader->Read(NotNull(&value)) ||
+        value > static_cast<uint8_t>(internal::BinaryArgType::kString)) {
+      return false;
+    }
+    type = static_cast<internal::BinaryArgType>(value);
+  }
+
+  return true;
+}
+
+// Appends the text form of the next argument of |type|.
+bool AppendArg(const NotNull<Reader*> reader,
+               const internal::BinaryArgType type,
+               const NotNull<std::string*> output) {
+  switch (type) {
+    case internal::BinaryArgType::kBool: {
+      char value = 0;
+      if (!reader->Read(NotNull(&value)))
+        return false;
+      output->append(internal::Arg(value != 0).view());
+      return true;
+    }
+    case internal::BinaryArgType::kChar: {
+      char value = 0;
+      if (!reader->Read(NotNull(&value)))
+        return false;
+      output->push_back(value);
+      return true;
+    }
+    case internal::BinaryArgType::kInt: {
+      int64_t value = 0;
+      if (!reader->Read(NotNull(&value)))
+        return false;
+      output->append(internal::Arg(static_cast<long long>(value)).view());
+      return true;
+    }
+    case internal::BinaryArgType::kUnsigned: {
+      uint64_t value = 0;
+      if (!reader->Read(NotNull(&value)))
+        return false;
+      output->append(
+          internal::Arg(static_cast<unsigned long long>(value)).view());
+      return true;
+    }
+    case internal::BinaryArgType::kDouble: {
+      double value = 0;
+      if (!reader->Read(NotNull(&value)))
+        return false;
+      output->append(internal::Arg(value).view());
+      return true;
+    }
+    case internal::BinaryArgType::kString: {
+      std::string_view value;
+      if (!reader->ReadString(&value))
+        return false;
+      output->append(value);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Formats a record of |site| with the Format() rules.
+bool ReadRecord(const NotNull<Reader*> reader, const Site& site,
+                const NotNull<Record*> record) {
+  if (!reader->Read(NotNull(&record->timestamp)))
+    return false;
+
+  auto& line = record->line;
+  line = StrCat({"[", LogLevelToString(site.level), ":", site.filename, "(",
+                 site.line, ")] "});
+
+  size_t arg_idx = 0;
+  const auto format = site.format;
+  for (size_t i = 0; i < format.size(); i++) {
+    const auto c = format[i];
+    if ((c == '{' || c == '}') && i + 1 < format.size() &&
+        format[i + 1] == c) {
+      line.push_back(c);
+      i++;
+      continue;
+    }
+
+    if (c == '{' && i + 1 < format.size() && format[i + 1] == '}') {
+      // A placeholder without an argument is kept as is, so a bad site
+      // doesn't make the rest of the file unreadable.
+      if (arg_idx == site.arg_types.size()) {
+        line.append("{}");
+      } else {
+        if (!AppendArg(reader, site.arg_types[arg_idx], &line))
+          return false;
+        arg_idx++;
+      }
+      i++;
+      continue;
+    }
+
+    line.push_back(c);
+  }
+
+  // Skips the arguments without placeholders to stay in sync.
+  std::string unused;
+  for (; arg_idx < site.arg_types.size(); arg_idx++) {
+    if (!AppendArg(reader, site.arg_types[arg_idx], &unused))
+      return false;
+  }
+
+  return true;
+}
+
+// Reads the next site or record. Returns false if the entry is partial or
+// malformed.
+bool ReadEntry(const NotNull<Reader*> reader,
+               const NotNull<std::vector<Site>*> sites,
+               const NotNull<std::vector<Record>*> records) {
+  char tag = 0;
+  uint32_t id = 0;
+  if (!reader->Read(NotNull(&tag)) || !reader->Read(NotNull(&id)))
+    return false;
+
+  switch (tag) {
+    case BinaryLogger::kSiteTag: {
+      Site site;
+      if (id != sites->size() || !ReadSite(reader, &site))
+        return false;
+      sites->emplace_back(std::move(site));
+      return true;
+    }
+    case BinaryLogger::kRecordTag: {
+      Record record;
+      if (id >= sites->size() || !ReadRecord(reader, (*sites)[id], &record))
+        return false;
+      records->emplace_back(std::move(record));
+      return true;
+    }
+  }
+
+  return false;
+}
+
+}  // namespace
+
+StatusOr<std::string> DecodeBinaryLog(std::string_view data,
+                                      const Nullable<bool*> is_truncated) {
+  if (data.substr(0, BinaryLogger::kMagic.size()) != BinaryLogger::kMagic)
+    return MakeStatus<LogError>("Not a binary log");
+  data.remove_prefix(BinaryLogger::kMagic.size());
+
+  std::vector<Site> sites;
+  std::vector<Record> records;
+
+  Reader reader(data);
+  auto is_complete = true;
+  while (is_complete && !reader.empty())
+    is_complete = ReadEntry(&reader, &sites, &records);
+  if (is_truncated != nullptr)
+    *is_truncated = !is_complete;
+
+  std::stable_sort(records.begin(), records.end(),
+                   [](const Record& lhs, const Record& rhs) {
+                     return lhs.timestamp < rhs.timestamp;
+                   });
+
+  std::string output;
+  for (const auto& record : records) {
+    output += record.line;
+    output += '\n';
+  }
+
+  return output;
+}
+
+}  // namespace rst
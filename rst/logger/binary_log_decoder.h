@@ -0,0 +1,50 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_LOGGER_BINARY_LOG_DECODER_H_
+#define RST_LOGGER_BINARY_LOG_DECODER_H_
+
+#include <string>
+#include <string_view>
+
+#include "rst/not_null/not_null.h"
+#include "rst/status/status_or.h"
+
+namespace rst {
+
+// Converts the contents of a file written by BinaryLogger to text lines in the
+// "[LEVEL:file(line)] message" format, each followed by a newline. Records are
+// ordered by their timestamps. A partial or malformed entry, like the one a
+// crashed writer leaves at the end, stops the decoding: the records before it
+// are returned and |is_truncated| is set to true if it's not null. Returns
+// LogError if |data| is not a binary log.
+StatusOr<std::string> DecodeBinaryLog(std::string_view data,
+                                      Nullable<bool*> is_truncated = nullptr);
+
+}  // namespace rst
+
+#endif  // RST_LOGGER_BINARY_LOG_DECODER_H_
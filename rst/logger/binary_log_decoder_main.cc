@@ -0,0 +1,61 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Prints a binary log written by BinaryLogger as text.
+//
+// Usage: rst_binary_log_decoder <file>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "rst/files/file_utils.h"
+#include "rst/logger/binary_log_decoder.h"
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::fprintf(stderr, "Usage: %s <file>\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  auto data = rst::ReadFile(argv[1]);
+  if (data.err()) {
+    std::fprintf(stderr, "%s\n", data.status().GetError()->AsString().c_str());
+    return EXIT_FAILURE;
+  }
+
+  auto is_truncated = false;
+  auto text = rst::DecodeBinaryLog(*data, &is_truncated);
+  if (text.err()) {
+    std::fprintf(stderr, "%s\n", text.status().GetError()->AsString().c_str());
+    return EXIT_FAILURE;
+  }
+
+  std::fwrite(text->data(), 1, text->size(), stdout);
+  if (is_truncated)
+    std::fprintf(stderr, "Warning: the log ends with a partial entry\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,334 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/binary_logger.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#include "rst/check/check.h"
+#include "rst/logger/file_descriptor.h"
+#include "rst/logger/log_error.h"
+#include "rst/macros/optimization.h"
+#include "rst/memory/memory.h"
+#include "rst/no_destructor/no_destructor.h"
+#include "rst/strings/str_cat.h"
+#include "rst/threading/ring_slot.h"
+
+namespace chrono = std::chrono;
+
+namespace rst {
+namespace internal {
+
+std::atomic<LogLevel> g_binary_log_level{LogLevel::kAll};
+
+}  // namespace internal
+
+namespace {
+
+constexpr auto kDrainInterval = chrono::milliseconds(10);
+
+BinaryLogger* g_binary_logger = nullptr;
+std::atomic<uint64_t> g_last_logger_id{0};
+
+struct Site {
+  LogLevel level;
+  const char* filename;
+  int line;
+  const char* format;
+  std::vector<internal::BinaryArgType> arg_types;
+};
+
+// All the registered call sites. Their IDs are the indices.
+class SiteRegistry {
+ public:
+  SiteRegistry() = default;
+
+  uint32_t Add(Site&& site) {
+    MutexLock lock(&mutex_);
+    sites_.emplace_back(std::move(site));
+    return static_cast<uint32_t>(sites_.size() - 1);
+  }
+
+  // Appends the definitions of the sites starting from |first| to |output|.
+  // Returns the number of the sites.
+  size_t Serialize(const size_t first, const NotNull<std::string*> output) {
+    MutexLock lock(&mutex_);
+    for (auto i = first; i < sites_.size(); i++) {
+      const auto& site = sites_[i];
+      const std::string_view filename(site.filename);
+      const std::string_view format(site.format);
+
+      Append(output, BinaryLogger::kSiteTag);
+      Append(output, static_cast<uint32_t>(i));
+      Append(output, static_cast<uint8_t>(site.level));
+      Append(output, static_cast<int32_t>(site.line));
+      Append(output, static_cast<uint32_t>(filename.size()));
+      output->append(filename);
+      Append(output, static_cast<uint32_t>(format.size()));
+      output->append(format);
+      Append(output, static_cast<uint8_t>(site.arg_types.size()));
+      for (const auto type : site.arg_types)
+        Append(output, static_cast<uint8_t>(type));
+    }
+
+    return sites_.size();
+  }
+
+ private:
+  template <class T>
+  static void Append(const NotNull<std::string*> output, const T value) {
+    output->append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  Mutex mutex_{"SiteRegistry"};
+  std::vector<Site> sites_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(SiteRegistry);
+};
+
+SiteRegistry& GetSiteRegistry() {
+  static NoDestructor<SiteRegistry> registry;
+  return *registry;
+}
+
+// The buffer of the current thread. Marks it abandoned on the thread exit so
+// the logger can release it once drained.
+struct ThreadBufferHolder {
+  ThreadBufferHolder() = default;
+  ~ThreadBufferHolder() {
+    if (buffer != nullptr)
+      buffer->Abandon();
+  }
+
+  uint64_t logger_id = 0;
+  std::shared_ptr<internal::BinaryLogBuffer> buffer;
+};
+
+ThreadBufferHolder& GetThreadBufferHolder() {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+  thread_local ThreadBufferHolder holder;
+#pragma clang diagnostic pop
+  return holder;
+}
+
+}  // namespace
+
+namespace internal {
+
+uint32_t RegisterBinaryLogSite(
+    const LogLevel level, const NotNull<const char*> filename, const int line,
+    const NotNull<const char*> format,
+    const std::initializer_list<BinaryArgType> arg_types) {
+  RST_DCHECK(arg_types.size() <= UINT8_MAX);
+  return GetSiteRegistry().Add(
+      {level, filename.get(), line, format.get(), arg_types});
+}
+
+BinaryLogBuffer::BinaryLogBuffer(const size_t capacity)
+    : capacity_(capacity), data_(new char[capacity]) {
+  RST_DCHECK(RoundUpToPowerOfTwo(capacity) == capacity);
+}
+
+BinaryLogBuffer::~BinaryLogBuffer() = default;
+
+void BinaryLogBuffer::WaitForRoom(const size_t pos, const size_t size) {
+  while (true) {
+    cached_head_ = head_.load(std::memory_order_acquire);
+    if (pos - cached_head_ + size <= capacity())
+      return;
+
+    BinaryLogger::RequestDrain();
+    std::this_thread::yield();
+  }
+}
+
+}  // namespace internal
+
+BinaryLogger::BinaryLogger(const int fd, const size_t thread_buffer_size)
+    : fd_(fd),
+      thread_buffer_size_(internal::RoundUpToPowerOfTwo(thread_buffer_size)),
+      id_(g_last_logger_id.fetch_add(1, std::memory_order_relaxed) + 1) {
+  thread_ = std::thread(&BinaryLogger::WriteRecords, this);
+}
+
+BinaryLogger::~BinaryLogger() {
+  {
+    MutexLock lock(&thread_mutex_);
+    should_exit_ = true;
+  }
+  thread_cv_.NotifyOne();
+  thread_.join();
+
+  Drain();
+  internal::CloseFile(fd_);
+
+  if (g_binary_logger == this) {
+    g_binary_logger = nullptr;
+    internal::g_binary_log_level.store(LogLevel::kOff,
+                                       std::memory_order_relaxed);
+  }
+}
+
+// static
+StatusOr<NotNull<std::unique_ptr<BinaryLogger>>> BinaryLogger::Create(
+    const NotNull<const char*> filename, const size_t thread_buffer_size) {
+  const auto fd = internal::OpenForWriting(filename);
+  if (fd == -1)
+    return MakeStatus<LogError>(StrCat({"Can't open file ", filename}));
+
+  auto magic = kMagic;
+  if (!internal::WriteAll(fd, &magic, 1)) {
+    internal::CloseFile(fd);
+    return MakeStatus<LogError>(StrCat({"Can't write file ", filename}));
+  }
+
+  return WrapUnique(NotNull(new BinaryLogger(fd, thread_buffer_size)));
+}
+
+// static
+void BinaryLogger::SetGlobalBinaryLogger(const NotNull<BinaryLogger*> logger) {
+  g_binary_logger = logger.get();
+  internal::g_binary_log_level.store(g_binary_logger->level_,
+                                     std::memory_order_relaxed);
+}
+
+void BinaryLogger::set_level(const LogLevel level) {
+  level_ = level;
+  if (g_binary_logger == this)
+    internal::g_binary_log_level.store(level_, std::memory_order_relaxed);
+}
+
+void BinaryLogger::Flush() { Drain(); }
+
+// static
+NotNull<internal::BinaryLogBuffer*> BinaryLogger::GetThreadBuffer() {
+  RST_DCHECK(g_binary_logger != nullptr);
+
+  auto& holder = GetThreadBufferHolder();
+  if (RST_LIKELY(holder.logger_id == g_binary_logger->id_))
+    return holder.buffer.get();
+
+  if (holder.buffer != nullptr)
+    holder.buffer->Abandon();
+  holder.logger_id = g_binary_logger->id_;
+  return g_binary_logger->AddThreadBuffer(&holder.buffer);
+}
+
+// static
+void BinaryLogger::FlushAndAbort() {
+  RST_DCHECK(g_binary_logger != nullptr);
+  g_binary_logger->Flush();
+  std::abort();
+}
+
+// static
+void BinaryLogger::RequestDrain() {
+  RST_DCHECK(g_binary_logger != nullptr);
+  g_binary_logger->thread_cv_.NotifyOne();
+}
+
+NotNull<internal::BinaryLogBuffer*> BinaryLogger::AddThreadBuffer(
+    const NotNull<std::shared_ptr<internal::BinaryLogBuffer>*> holder) {
+  *holder = std::make_shared<internal::BinaryLogBuffer>(thread_buffer_size_);
+
+  MutexLock lock(&buffers_mutex_);
+  buffers_.emplace_back(*holder);
+  return holder->get();
+}
+
+void BinaryLogger::WriteRecords() {
+  while (true) {
+    {
+      MutexLock lock(&thread_mutex_);
+      if (should_exit_)
+        return;
+      thread_cv_.WaitFor(&lock, kDrainInterval);
+      if (should_exit_)
+        return;
+    }
+
+    Drain();
+  }
+}
+
+void BinaryLogger::Drain() {
+  MutexLock drain_lock(&drain_mutex_);
+
+  std::vector<std::shared_ptr<internal::BinaryLogBuffer>> buffers;
+  {
+    MutexLock lock(&buffers_mutex_);
+    buffers = buffers_;
+  }
+
+  // The abandoned flags and the positions are loaded before the sites, so
+  // every site used by the loaded records is already registered.
+  std::vector<bool> is_abandoned;
+  std::vector<size_t> tails;
+  is_abandoned.reserve(buffers.size());
+  tails.reserve(buffers.size());
+  for (const auto& buffer : buffers) {
+    is_abandoned.emplace_back(
+        buffer->is_abandoned_.load(std::memory_order_acquire));
+    tails.emplace_back(buffer->tail_.load(std::memory_order_acquire));
+  }
+
+  std::string sites;
+  written_site_count_ =
+      GetSiteRegistry().Serialize(written_site_count_, &sites);
+
+  std::vector<std::string_view> pieces;
+  pieces.reserve(1 + buffers.size() * 2);
+  pieces.emplace_back(sites);
+  for (size_t i = 0; i < buffers.size(); i++) {
+    const auto& buffer = *buffers[i];
+    const auto head = buffer.head_.load(std::memory_order_relaxed);
+    const auto mask = buffer.capacity() - 1;
+    const auto size = tails[i] - head;
+    const auto offset = head & mask;
+    const auto first = std::min(size, buffer.capacity() - offset);
+    pieces.emplace_back(buffer.data_.get() + offset, first);
+    pieces.emplace_back(buffer.data_.get(), size - first);
+  }
+
+  RST_CHECK(internal::WriteAll(fd_, pieces.data(), pieces.size()));
+
+  for (size_t i = 0; i < buffers.size(); i++)
+    buffers[i]->head_.store(tails[i], std::memory_order_release);
+
+  MutexLock lock(&buffers_mutex_);
+  for (size_t i = 0; i < buffers.size(); i++) {
+    if (is_abandoned[i]) {
+      buffers_.erase(std::find(buffers_.begin(), buffers_.end(), buffers[i]));
+    }
+  }
+}
+
+}  // namespace rst
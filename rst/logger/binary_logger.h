@@ -0,0 +1,430 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_LOGGER_BINARY_LOGGER_H_
+#define RST_LOGGER_BINARY_LOGGER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "rst/logger/log_level.h"
+#include "rst/macros/macros.h"
+#include "rst/not_null/not_null.h"
+#include "rst/status/status_or.h"
+#include "rst/strings/format.h"
+#include "rst/threading/cache_line.h"
+#include "rst/threading/mutex.h"
+
+// Binary logging for the hottest paths. Every call site registers its level,
+// location, format string and argument types once. A log call then appends
+// only the site ID, a timestamp and the raw argument bytes to a per-thread
+// buffer, a background thread moves the buffers to the file. Use
+// DecodeBinaryLog() or the rst_binary_log_decoder tool to get the usual
+// "[LEVEL:file(line)] message" text back.
+//
+// Example:
+//
+//   auto logger = BinaryLogger::Create("log.bin");
+//   ...
+//   BinaryLogger::SetGlobalBinaryLogger(logger->get());
+//
+//   RST_BLOG_INFO("Request {} took {} us", id, duration);
+//
+// Supported argument types are bool, char, integers, floating point numbers,
+// enums and strings. Floating point numbers are stored as double, the strings
+// of a record larger than the thread buffer are truncated. The levels below
+// RST_MIN_LOG_LEVEL generate no code. The format string must be a literal and
+// its placeholders must match the arguments, otherwise it doesn't compile.
+#if RST_MIN_LOG_LEVEL <= 1
+#define RST_BLOG_DEBUG(...) \
+  RST_BLOG_INTERNAL(::rst::LogLevel::kDebug, __VA_ARGS__)
+#else
+#define RST_BLOG_DEBUG(...) \
+  RST_BLOG_STRIPPED_INTERNAL(::rst::LogLevel::kDebug, __VA_ARGS__)
+#endif
+
+#if RST_MIN_LOG_LEVEL <= 2
+#define RST_BLOG_INFO(...) \
+  RST_BLOG_INTERNAL(::rst::LogLevel::kInfo, __VA_ARGS__)
+#else
+#define RST_BLOG_INFO(...) \
+  RST_BLOG_STRIPPED_INTERNAL(::rst::LogLevel::kInfo, __VA_ARGS__)
+#endif
+
+#if RST_MIN_LOG_LEVEL <= 3
+#define RST_BLOG_WARNING(...) \
+  RST_BLOG_INTERNAL(::rst::LogLevel::kWarning, __VA_ARGS__)
+#else
+#define RST_BLOG_WARNING(...) \
+  RST_BLOG_STRIPPED_INTERNAL(::rst::LogLevel::kWarning, __VA_ARGS__)
+#endif
+
+#if RST_MIN_LOG_LEVEL <= 4
+#define RST_BLOG_ERROR(...) \
+  RST_BLOG_INTERNAL(::rst::LogLevel::kError, __VA_ARGS__)
+#else
+#define RST_BLOG_ERROR(...) \
+  RST_BLOG_STRIPPED_INTERNAL(::rst::LogLevel::kError, __VA_ARGS__)
+#endif
+
+#define RST_BLOG_FATAL(...) \
+  RST_BLOG_INTERNAL(::rst::LogLevel::kFatal, __VA_ARGS__)
+
+#define RST_BLOG_STRIPPED_INTERNAL(level, ...)                          \
+  do {                                                                    \
+    RST_BLOG_CHECK_FORMAT_INTERNAL(__VA_ARGS__);                          \
+    if (false) {                                                          \
+      ::rst::BinaryLogger::Log([]() {}, level, __FILE__, __LINE__,        \
+                               __VA_ARGS__);                              \
+    }                                                                     \
+  } while (false)
+
+// The lambda has a unique type, so every call site gets its own instantiation
+// of BinaryLogger::Log() and its own site ID.
+#define RST_BLOG_INTERNAL(level, ...)                                     \
+  do {                                                                    \
+    RST_BLOG_CHECK_FORMAT_INTERNAL(__VA_ARGS__);                          \
+    if (::rst::BinaryLogger::IsEnabled(level)) {                          \
+      ::rst::BinaryLogger::Log([]() {}, level, __FILE__, __LINE__,        \
+                               __VA_ARGS__);                              \
+    }                                                                     \
+  } while (false)
+
+// A record whose placeholders don't match its arguments can't be decoded, so
+// the format string is checked at compile time. The extra argument keeps the
+// variadic part of RST_BLOG_FORMAT_INTERNAL non-empty.
+#define RST_BLOG_CHECK_FORMAT_INTERNAL(...)                                  \
+  static_assert(                                                             \
+      ::rst::internal::CountFormat(RST_BLOG_FORMAT_INTERNAL(__VA_ARGS__, 0))  \
+          .is_valid,                                                         \
+      "Invalid format string");                                              \
+  static_assert(                                                             \
+      ::rst::internal::CountFormat(RST_BLOG_FORMAT_INTERNAL(__VA_ARGS__, 0))  \
+              .placeholder_count ==                                          \
+          decltype(::rst::internal::CountBinaryLogArgs(__VA_ARGS__))::value, \
+      "Numbers of placeholders and arguments should match")
+
+#define RST_BLOG_FORMAT_INTERNAL(format, ...) format
+
+namespace rst {
+
+class BinaryLogger;
+
+namespace internal {
+
+// The level of the global binary logger.
+extern std::atomic<LogLevel> g_binary_log_level;
+
+// Types of the arguments as stored in the binary log.
+enum class BinaryArgType : uint8_t {
+  kBool = 0,
+  kChar,
+  kInt,
+  kUnsigned,
+  kDouble,
+  kString,
+};
+
+template <class T>
+constexpr BinaryArgType GetBinaryArgType() {
+  using U = std::decay_t<T>;
+  if constexpr (std::is_same_v<U, bool>) {
+    return BinaryArgType::kBool;
+  } else if constexpr (std::is_same_v<U, char>) {
+    return BinaryArgType::kChar;
+  } else if constexpr (std::is_enum_v<U>) {
+    return GetBinaryArgType<std::underlying_type_t<U>>();
+  } else if constexpr (std::is_integral_v<U>) {
+    return std::is_signed_v<U> ? BinaryArgType::kInt
+                               : BinaryArgType::kUnsigned;
+  } else if constexpr (std::is_floating_point_v<U>) {
+    return BinaryArgType::kDouble;
+  } else {
+    static_assert(std::is_convertible_v<const T&, std::string_view>,
+                  "Unsupported binary log argument type");
+    return BinaryArgType::kString;
+  }
+}
+
+// Only used in decltype() to count the arguments after the format string.
+template <size_t N, class... Args>
+std::integral_constant<size_t, sizeof...(Args)> CountBinaryLogArgs(
+    const char (&format)[N], const Args&... args);
+
+// Registers a call site and returns its ID. |filename| and |format| must be
+// string literals.
+uint32_t RegisterBinaryLogSite(LogLevel level, NotNull<const char*> filename,
+                               int line, NotNull<const char*> format,
+                               std::initializer_list<BinaryArgType> arg_types);
+
+// Lock-free single-producer single-consumer byte queue. The owning thread
+// appends records, the background thread of BinaryLogger drains them.
+class BinaryLogBuffer {
+ public:
+  // |capacity| must be a power of two.
+  explicit BinaryLogBuffer(size_t capacity);
+  ~BinaryLogBuffer();
+
+  // Waits until |size| bytes are free and returns the position to write
+  // them at. Returns false if |size| is larger than the buffer.
+  bool Reserve(size_t size, NotNull<size_t*> pos) {
+    if (size > capacity())
+      return false;
+
+    *pos = tail_.load(std::memory_order_relaxed);
+    if (*pos - cached_head_ + size > capacity())
+      WaitForRoom(*pos, size);
+    return true;
+  }
+
+  // Copies |size| bytes at |pos| and advances it.
+  void Put(const NotNull<size_t*> pos, const NotNull<const void*> data,
+           const size_t size) {
+    const auto offset = *pos & (capacity() - 1);
+    const auto first = size < capacity() - offset ? size : capacity() - offset;
+    const auto bytes = static_cast<const char*>(data.get());
+    std::memcpy(data_.get() + offset, bytes, first);
+    std::memcpy(data_.get(), bytes + first, size - first);
+    *pos += size;
+  }
+
+  template <class T>
+  void Put(const NotNull<size_t*> pos, const T value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    Put(pos, &value, sizeof(value));
+  }
+
+  // Makes the bytes before |pos| visible to the background thread.
+  void Commit(const size_t pos) { tail_.store(pos, std::memory_order_release); }
+
+  // Called when the owning thread exits.
+  void Abandon() { is_abandoned_.store(true, std::memory_order_release); }
+
+  size_t capacity() const { return capacity_; }
+
+ private:
+  friend class rst::BinaryLogger;
+
+  void WaitForRoom(size_t pos, size_t size);
+
+  alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+  size_t cached_head_ = 0;
+
+  alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+  std::atomic<bool> is_abandoned_{false};
+
+  alignas(kCacheLineSize) const size_t capacity_;
+  const std::unique_ptr<char[]> data_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(BinaryLogBuffer);
+};
+
+template <class T>
+size_t BinaryArgSize(const T& value) {
+  constexpr auto type = GetBinaryArgType<T>();
+  if constexpr (type == BinaryArgType::kString) {
+    return sizeof(uint32_t) + std::string_view(value).size();
+  } else if constexpr (type == BinaryArgType::kBool ||
+                       type == BinaryArgType::kChar) {
+    return 1;
+  } else {
+    return 8;
+  }
+}
+
+// Returns the size of the string bytes of |value|, zero for other types.
+template <class T>
+size_t BinaryStringSize(const T& value) {
+  if constexpr (GetBinaryArgType<T>() == BinaryArgType::kString) {
+    return std::string_view(value).size();
+  } else {
+    (void)value;
+    return 0;
+  }
+}
+
+// Puts at most |strings_left| bytes of a string |value| and subtracts the put
+// number from |strings_left|.
+template <class T>
+void PutBinaryArg(const NotNull<BinaryLogBuffer*> buffer,
+                  const NotNull<size_t*> pos, const T& value,
+                  const NotNull<size_t*> strings_left) {
+  constexpr auto type = GetBinaryArgType<T>();
+  if constexpr (type == BinaryArgType::kString) {
+    const auto str = std::string_view(value).substr(0, *strings_left);
+    *strings_left -= str.size();
+    buffer->Put(pos, static_cast<uint32_t>(str.size()));
+    buffer->Put(pos, str.data(), str.size());
+  } else if constexpr (type == BinaryArgType::kBool ||
+                       type == BinaryArgType::kChar) {
+    buffer->Put(pos, static_cast<char>(value));
+  } else if constexpr (type == BinaryArgType::kInt) {
+    buffer->Put(pos, static_cast<int64_t>(value));
+  } else if constexpr (type == BinaryArgType::kUnsigned) {
+    buffer->Put(pos, static_cast<uint64_t>(value));
+  } else {
+    buffer->Put(pos, static_cast<double>(value));
+  }
+}
+
+}  // namespace internal
+
+// Writes the binary log to a file, see the RST_BLOG_* macros.
+class BinaryLogger {
+ public:
+  static constexpr size_t kDefaultThreadBufferSize = 1 << 20;
+
+  // Opens a |filename| for writing and starts the background thread. Every
+  // logging thread gets a buffer of |thread_buffer_size| rounded up to a power
+  // of two. Returns LogError on error.
+  static StatusOr<NotNull<std::unique_ptr<BinaryLogger>>> Create(
+      NotNull<const char*> filename,
+      size_t thread_buffer_size = kDefaultThreadBufferSize);
+
+  // Writes the rest of the records and stops the background thread.
+  ~BinaryLogger();
+
+  // Sets |logger| as a global binary logger instance.
+  static void SetGlobalBinaryLogger(NotNull<BinaryLogger*> logger);
+
+  static bool IsEnabled(const LogLevel level) {
+    return static_cast<int>(level) >=
+           static_cast<int>(
+               internal::g_binary_log_level.load(std::memory_order_relaxed));
+  }
+
+  void set_level(LogLevel level);
+
+  // Writes all the records logged before the call.
+  void Flush();
+
+  // Use the RST_BLOG_* macros instead.
+  template <class Tag, size_t N, class... Args>
+  static void Log(Tag, const LogLevel level,
+                  const NotNull<const char*> filename, const int line,
+                  const char (&format)[N], const Args&... args) {
+    static const auto site_id = internal::RegisterBinaryLogSite(
+        level, filename, line, format,
+        {internal::GetBinaryArgType<Args>()...});
+
+    auto size = sizeof(char) + sizeof(site_id) + sizeof(uint64_t) +
+                (size_t{0} + ... + internal::BinaryArgSize(args));
+    const auto buffer = GetThreadBuffer();
+
+    // A record that doesn't fit the buffer gets its strings cut from the end.
+    auto strings_left = std::numeric_limits<size_t>::max();
+    if (size > buffer->capacity()) {
+      const auto strings_size =
+          (size_t{0} + ... + internal::BinaryStringSize(args));
+      const auto excess = std::min(size - buffer->capacity(), strings_size);
+      strings_left = strings_size - excess;
+      size -= excess;
+    }
+
+    size_t pos = 0;
+    if (!buffer->Reserve(size, &pos)) {
+      if (level == LogLevel::kFatal)
+        FlushAndAbort();
+      return;
+    }
+
+    buffer->Put(&pos, kRecordTag);
+    buffer->Put(&pos, site_id);
+    buffer->Put(&pos, Now());
+    (internal::PutBinaryArg(buffer, &pos, args, &strings_left), ...);
+    buffer->Commit(pos);
+
+    if (level == LogLevel::kFatal)
+      FlushAndAbort();
+  }
+
+  // Tags of the file entries.
+  static constexpr char kSiteTag = 'S';
+  static constexpr char kRecordTag = 'R';
+
+  // Written at the beginning of the file.
+  static constexpr std::string_view kMagic = "RSTBLOG1";
+
+ private:
+  friend class internal::BinaryLogBuffer;
+
+  BinaryLogger(int fd, size_t thread_buffer_size);
+
+  static NotNull<internal::BinaryLogBuffer*> GetThreadBuffer();
+  static uint64_t Now() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+  }
+  [[noreturn]] static void FlushAndAbort();
+  // Wakes up the background thread of the global logger.
+  static void RequestDrain();
+
+  NotNull<internal::BinaryLogBuffer*> AddThreadBuffer(
+      NotNull<std::shared_ptr<internal::BinaryLogBuffer>*> holder);
+
+  void WriteRecords();
+  // Moves the committed records of all the buffers to the file.
+  void Drain();
+
+  const int fd_;
+  const size_t thread_buffer_size_;
+  // Distinguishes buffers of this logger from buffers of the destroyed ones.
+  const uint64_t id_;
+
+  Mutex buffers_mutex_{"BinaryLogger::buffers_"};
+  std::vector<std::shared_ptr<internal::BinaryLogBuffer>> buffers_;
+
+  // Serializes Drain().
+  Mutex drain_mutex_{"BinaryLogger::drain_"};
+  size_t written_site_count_ = 0;
+
+  Mutex thread_mutex_{"BinaryLogger::thread_"};
+  ConditionVariable thread_cv_;
+  bool should_exit_ = false;
+  std::thread thread_;
+
+  LogLevel level_ = LogLevel::kAll;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(BinaryLogger);
+};
+
+}  // namespace rst
+
+#endif  // RST_LOGGER_BINARY_LOGGER_H_
@@ -0,0 +1,289 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/binary_logger.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "rst/check/check.h"
+#include "rst/files/file_utils.h"
+#include "rst/logger/binary_log_decoder.h"
+#include "rst/macros/macros.h"
+
+namespace rst {
+namespace {
+
+class File {
+ public:
+  File() { RST_CHECK(std::tmpnam(buffer_) != nullptr); }
+  ~File() { std::remove(buffer_); }
+
+  NotNull<const char*> FileName() const { return buffer_; }
+
+  std::string Decode() const {
+    auto data = ReadFile(buffer_);
+    RST_CHECK(!data.err());
+    auto text = DecodeBinaryLog(*data);
+    RST_CHECK(!text.err());
+    return std::move(*text);
+  }
+
+ private:
+  char buffer_[L_tmpnam];
+
+  RST_DISALLOW_COPY_AND_ASSIGN(File);
+};
+
+enum class Color : int16_t { kRed = -1 };
+
+std::string Prefix(const char* level, const int line) {
+  return std::string("[") + level + ":" + __FILE__ + "(" +
+         std::to_string(line) + ")] ";
+}
+
+}  // namespace
+
+TEST(BinaryLogger, Log) {
+  File file;
+  int line = 0;
+  {
+    auto logger = BinaryLogger::Create(file.FileName());
+    ASSERT_FALSE(logger.err());
+    BinaryLogger::SetGlobalBinaryLogger(logger->get());
+
+    const std::string str = "str";
+    line = __LINE__ + 1;
+    RST_BLOG_INFO("Message");
+    RST_BLOG_WARNING("b={} c={} i={} u={} d={} e={}", true, 'c', -42, 42U,
+                     1.5, Color::kRed);
+    RST_BLOG_ERROR("s={} v={} {{}}", str, "literal");
+  }
+
+  EXPECT_EQ(file.Decode(),
+            Prefix("INFO", line) + "Message\n" + Prefix("WARNING", line + 1) +
+                "b=true c=c i=-42 u=42 d=1.5 e=-1\n" +
+                Prefix("ERROR", line + 3) + "s=str v=literal {}\n");
+}
+
+TEST(BinaryLogger, Level) {
+  File file;
+  int line = 0;
+  {
+    auto logger = BinaryLogger::Create(file.FileName());
+    ASSERT_FALSE(logger.err());
+    BinaryLogger::SetGlobalBinaryLogger(logger->get());
+    (*logger)->set_level(LogLevel::kInfo);
+
+    auto evaluation_count = 0;
+    RST_BLOG_DEBUG("{}", evaluation_count++);
+    line = __LINE__ + 1;
+    RST_BLOG_INFO("{}", evaluation_count++);
+    EXPECT_EQ(evaluation_count, 1);
+  }
+
+  EXPECT_EQ(file.Decode(), Prefix("INFO", line) + "0\n");
+}
+
+TEST(BinaryLogger, FlushAndWrap) {
+  File file;
+  auto logger = BinaryLogger::Create(file.FileName(), 64);
+  ASSERT_FALSE(logger.err());
+  BinaryLogger::SetGlobalBinaryLogger(logger->get());
+
+  // Many times more than the buffer size.
+  std::string expected;
+  for (auto i = 0; i < 100; i++) {
+    const auto line = __LINE__ + 1;
+    RST_BLOG_INFO("Message {}", i);
+    expected += Prefix("INFO", line) + "Message " + std::to_string(i) + "\n";
+  }
+
+  (*logger)->Flush();
+  EXPECT_EQ(file.Decode(), expected);
+}
+
+TEST(BinaryLogger, Threads) {
+  static constexpr size_t kThreadNumber = 4;
+  static constexpr size_t kMessageNumber = 1000;
+
+  File file;
+  {
+    auto logger = BinaryLogger::Create(file.FileName(), 1024);
+    ASSERT_FALSE(logger.err());
+    BinaryLogger::SetGlobalBinaryLogger(logger->get());
+
+    std::vector<std::thread> threads;
+    threads.reserve(kThreadNumber);
+    for (size_t i = 0; i < kThreadNumber; i++) {
+      threads.emplace_back([]() {
+        for (size_t j = 0; j < kMessageNumber; j++)
+          RST_BLOG_INFO("{}", j);
+      });
+    }
+
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+  const auto text = file.Decode();
+  size_t line_count = 0;
+  for (const auto c : text) {
+    if (c == '\n')
+      line_count++;
+  }
+  EXPECT_EQ(line_count, kThreadNumber * kMessageNumber);
+}
+
+TEST(BinaryLogger, Fatal) {
+  File file;
+
+  // The logger is created in the child process, so its background thread
+  // isn't lost by fork().
+  EXPECT_DEATH(
+      {
+        auto logger = BinaryLogger::Create(file.FileName());
+        RST_CHECK(!logger.err());
+        BinaryLogger::SetGlobalBinaryLogger(logger->get());
+        RST_BLOG_FATAL("Fatal {}", 1);
+      },
+      "");
+  const auto text = file.Decode();
+  EXPECT_EQ(text.find("[FATAL:"), 0U);
+  EXPECT_NE(text.find(")] Fatal 1\n"), std::string::npos);
+}
+
+TEST(BinaryLogger, Truncation) {
+  File file;
+  auto logger = BinaryLogger::Create(file.FileName(), 64);
+  ASSERT_FALSE(logger.err());
+  BinaryLogger::SetGlobalBinaryLogger(logger->get());
+
+  // The record takes 13 bytes of the header, 8 bytes of the integer and 2
+  // strings with their 4 byte sizes, so 35 bytes are left for the strings.
+  const auto line = __LINE__ + 1;
+  RST_BLOG_INFO("{} {} {}", "abc", 1, std::string(100, 'A'));
+  (*logger)->Flush();
+  EXPECT_EQ(file.Decode(),
+            Prefix("INFO", line) + "abc 1 " + std::string(32, 'A') + "\n");
+}
+
+TEST(BinaryLogger, FatalTruncation) {
+  File file;
+
+  EXPECT_DEATH(
+      {
+        auto logger = BinaryLogger::Create(file.FileName(), 64);
+        RST_CHECK(!logger.err());
+        BinaryLogger::SetGlobalBinaryLogger(logger->get());
+        RST_BLOG_FATAL("Fatal {}", std::string(100, 'A'));
+      },
+      "");
+  const auto text = file.Decode();
+  EXPECT_EQ(text.find("[FATAL:"), 0U);
+  EXPECT_NE(text.find(")] Fatal " + std::string(47, 'A') + "\n"),
+            std::string::npos);
+}
+
+TEST(BinaryLogDecoder, MissingArgument) {
+  File file;
+  int line = 0;
+  {
+    auto logger = BinaryLogger::Create(file.FileName());
+    ASSERT_FALSE(logger.err());
+    BinaryLogger::SetGlobalBinaryLogger(logger->get());
+
+    // The macros don't compile such a call, a file written by another
+    // version can still have it.
+    line = __LINE__ + 1;
+    BinaryLogger::Log([]() {}, LogLevel::kInfo, __FILE__, __LINE__,
+                      "use {} and {} here", 1);
+    RST_BLOG_INFO("Next");
+  }
+
+  EXPECT_EQ(file.Decode(), Prefix("INFO", line) + "use 1 and {} here\n" +
+                               Prefix("INFO", line + 2) + "Next\n");
+}
+
+TEST(BinaryLogDecoder, Malformed) {
+  EXPECT_TRUE(DecodeBinaryLog("").err());
+  EXPECT_TRUE(DecodeBinaryLog("RSTBLOG").err());
+
+  auto is_truncated = true;
+  auto empty = DecodeBinaryLog("RSTBLOG1", &is_truncated);
+  ASSERT_FALSE(empty.err());
+  EXPECT_EQ(*empty, "");
+  EXPECT_FALSE(is_truncated);
+
+  for (const auto& data :
+       {std::string("RSTBLOG1R"), std::string("RSTBLOG1R\0\0\0\0", 13),
+        std::string("RSTBLOG1X\0\0\0\0", 13)}) {
+    is_truncated = false;
+    auto text = DecodeBinaryLog(data, &is_truncated);
+    ASSERT_FALSE(text.err());
+    EXPECT_EQ(*text, "");
+    EXPECT_TRUE(is_truncated);
+  }
+}
+
+TEST(BinaryLogDecoder, PartialTail) {
+  File file;
+  int line = 0;
+  {
+    auto logger = BinaryLogger::Create(file.FileName());
+    ASSERT_FALSE(logger.err());
+    BinaryLogger::SetGlobalBinaryLogger(logger->get());
+
+    line = __LINE__ + 1;
+    RST_BLOG_INFO("First {}", 1);
+    RST_BLOG_INFO("Second {}", "record");
+  }
+
+  auto data = ReadFile(file.FileName());
+  ASSERT_FALSE(data.err());
+
+  // Cuts the last record in the middle of its string, as a crash in the
+  // middle of a write does.
+  data->resize(data->size() - 3);
+  auto is_truncated = false;
+  auto text = DecodeBinaryLog(*data, &is_truncated);
+  ASSERT_FALSE(text.err());
+  EXPECT_EQ(*text, Prefix("INFO", line) + "First 1\n");
+  EXPECT_TRUE(is_truncated);
+
+  // The flag is optional.
+  text = DecodeBinaryLog(*data);
+  ASSERT_FALSE(text.err());
+  EXPECT_EQ(*text, Prefix("INFO", line) + "First 1\n");
+}
+
+}  // namespace rst
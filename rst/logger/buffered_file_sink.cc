@@ -0,0 +1,168 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/buffered_file_sink.h"
+
+#include <cstring>
+#include <iterator>
+
+#include "rst/check/check.h"
+#include "rst/logger/file_descriptor.h"
+#include "rst/logger/log_error.h"
+#include "rst/memory/memory.h"
+#include "rst/strings/str_cat.h"
+
+namespace chrono = std::chrono;
+
+namespace rst {
+
+BufferedFileSink::BufferedFileSink(const int fd, const Options& options)
+    : fd_(fd),
+      options_(options),
+      buffer_(new char[options.buffer_size]),
+      last_flush_time_(chrono::steady_clock::now()) {
+  RST_DCHECK(fd_ != -1);
+  RST_DCHECK(options_.buffer_size != 0);
+
+  if (options_.flush_interval != chrono::milliseconds::zero())
+    thread_ = std::thread(&BufferedFileSink::FlushPeriodically, this);
+}
+
+BufferedFileSink::~BufferedFileSink() {
+  if (thread_.joinable()) {
+    {
+      MutexLock lock(&mutex_);
+      should_exit_ = true;
+    }
+    cv_.NotifyOne();
+    thread_.join();
+  }
+
+  FlushLocked();
+  internal::CloseFile(fd_);
+}
+
+// static
+StatusOr<NotNull<std::unique_ptr<BufferedFileSink>>> BufferedFileSink::Create(
+    const NotNull<const char*> filename) {
+  return Create(filename, Options());
+}
+
+// static
+StatusOr<NotNull<std::unique_ptr<BufferedFileSink>>> BufferedFileSink::Create(
+    const NotNull<const char*> filename, const Options& options) {
+  const auto fd = internal::OpenForWriting(filename);
+  if (fd == -1)
+    return MakeStatus<LogError>(StrCat({"Can't open file ", filename}));
+
+  return WrapUnique(NotNull(new BufferedFileSink(fd, options)));
+}
+
+void BufferedFileSink::Log(const std::string_view message) {
+  LogRecord record;
+  record.message = message;
+  Emit(record);
+}
+
+void BufferedFileSink::Emit(const LogRecord& record) {
+  MutexLock lock(&mutex_);
+
+  const auto& message = record.message;
+  if (buffer_used_ + message.size() + 1 > options_.buffer_size) {
+    std::string_view pieces[] = {
+        std::string_view(buffer_.get(), buffer_used_), message, "\n"};
+    Write(pieces, std::size(pieces));
+    return;
+  }
+
+  std::memcpy(buffer_.get() + buffer_used_, message.data(), message.size());
+  buffer_used_ += message.size();
+  buffer_[buffer_used_++] = '\n';
+
+  if (static_cast<int>(record.level) >=
+      static_cast<int>(options_.flush_level)) {
+    FlushLocked();
+    return;
+  }
+
+  if (options_.flush_interval != chrono::milliseconds::zero() &&
+      chrono::steady_clock::now() - last_flush_time_ >=
+          options_.flush_interval) {
+    FlushLocked();
+  }
+}
+
+void BufferedFileSink::Flush() {
+  MutexLock lock(&mutex_);
+  FlushLocked();
+}
+
+void BufferedFileSink::EmergencyLog(const std::string_view message) {
+  std::string_view pieces[] = {std::string_view(buffer_.get(), buffer_used_),
+                               message, "\n"};
+  (void)internal::WriteAll(fd_, pieces, std::size(pieces));
+  buffer_used_ = 0;
+}
+
+void BufferedFileSink::EmergencyFlush() {
+  std::string_view piece(buffer_.get(), buffer_used_);
+  (void)internal::WriteAll(fd_, &piece, 1);
+  buffer_used_ = 0;
+}
+
+void BufferedFileSink::FlushPeriodically() {
+  MutexLock lock(&mutex_);
+  while (!should_exit_) {
+    const auto elapsed = chrono::steady_clock::now() - last_flush_time_;
+    if (buffer_used_ != 0 && elapsed >= options_.flush_interval) {
+      FlushLocked();
+      continue;
+    }
+
+    // An empty buffer waits for a whole interval, so a message that arrives
+    // meanwhile is written at most one interval later.
+    cv_.WaitFor(&lock, buffer_used_ == 0 ? options_.flush_interval
+                                          : options_.flush_interval - elapsed);
+  }
+}
+
+void BufferedFileSink::FlushLocked() {
+  if (buffer_used_ == 0)
+    return;
+
+  std::string_view piece(buffer_.get(), buffer_used_);
+  Write(&piece, 1);
+}
+
+void BufferedFileSink::Write(const NotNull<std::string_view*> pieces,
+                             const size_t count) {
+  RST_CHECK(internal::WriteAll(fd_, pieces, count));
+  buffer_used_ = 0;
+  last_flush_time_ = chrono::steady_clock::now();
+}
+
+}  // namespace rst
@@ -0,0 +1,121 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_LOGGER_BUFFERED_FILE_SINK_H_
+#define RST_LOGGER_BUFFERED_FILE_SINK_H_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <thread>
+
+#include "rst/logger/log_level.h"
+#include "rst/logger/sink.h"
+#include "rst/macros/macros.h"
+#include "rst/not_null/not_null.h"
+#include "rst/status/status_or.h"
+#include "rst/threading/mutex.h"
+
+namespace rst {
+
+// The file sink that collects messages in a large buffer and writes it with a
+// single system call instead of flushing after every message. The buffer is
+// written when the next message doesn't fit into it, when a message of a high
+// enough level arrives, on Flush() and on destruction. A background thread
+// writes it once the flush interval has passed since the previous write, so a
+// message logged before an idle period isn't kept in the buffer.
+//
+// Example:
+//
+//   BufferedFileSink::Options options;
+//   options.flush_level = LogLevel::kWarning;
+//   auto sink = BufferedFileSink::Create("log.txt", options);
+//   if (sink.err())
+//     ...
+//   Logger logger(std::move(*sink));
+//
+class BufferedFileSink : public Sink {
+ public:
+  struct Options {
+    size_t buffer_size = 64 * 1024;
+    // Zero means no flushing by time and no background thread.
+    std::chrono::milliseconds flush_interval = std::chrono::seconds(1);
+    // Messages of this level or above are written immediately.
+    LogLevel flush_level = LogLevel::kError;
+  };
+
+  // Opens a |filename| for writing. Returns LogError on error.
+  static StatusOr<NotNull<std::unique_ptr<BufferedFileSink>>> Create(
+      NotNull<const char*> filename);
+  static StatusOr<NotNull<std::unique_ptr<BufferedFileSink>>> Create(
+      NotNull<const char*> filename, const Options& options);
+
+  // Stops the background thread and writes the buffered messages.
+  ~BufferedFileSink() final;
+
+  // Thread safe logging functions. Messages logged with Log() have no level
+  // and are written immediately only by size or time.
+  void Log(std::string_view message) final;
+  void Emit(const LogRecord& record) final;
+
+  void Flush() final;
+
+  // Write out the buffer without taking the lock.
+  void EmergencyLog(std::string_view message) final;
+  void EmergencyFlush() final;
+
+ private:
+  BufferedFileSink(int fd, const Options& options);
+
+  // Writes the buffer when the flush interval has passed.
+  void FlushPeriodically();
+
+  // Called with |mutex_| held.
+  void FlushLocked();
+  // Writes |pieces| which start with the buffer contents and empties the
+  // buffer. Called with |mutex_| held.
+  void Write(NotNull<std::string_view*> pieces, size_t count);
+
+  const int fd_;
+  const Options options_;
+
+  Mutex mutex_{"BufferedFileSink"};
+  ConditionVariable cv_;
+  const std::unique_ptr<char[]> buffer_;
+  size_t buffer_used_ = 0;
+  std::chrono::steady_clock::time_point last_flush_time_;
+  bool should_exit_ = false;
+
+  std::thread thread_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(BufferedFileSink);
+};
+
+}  // namespace rst
+
+#endif  // RST_LOGGER_BUFFERED_FILE_SINK_H_
@@ -0,0 +1,213 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/buffered_file_sink.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "rst/check/check.h"
+#include "rst/logger/logger.h"
+#include "rst/macros/macros.h"
+
+namespace chrono = std::chrono;
+
+namespace rst {
+namespace {
+
+class File {
+ public:
+  File() { RST_CHECK(std::tmpnam(buffer_) != nullptr); }
+  ~File() { std::remove(buffer_); }
+
+  NotNull<const char*> FileName() const { return buffer_; }
+
+  std::string Read() const {
+    std::ifstream f(buffer_);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+  }
+
+ private:
+  char buffer_[L_tmpnam];
+
+  RST_DISALLOW_COPY_AND_ASSIGN(File);
+};
+
+BufferedFileSink::Options NeverFlushOptions() {
+  BufferedFileSink::Options options;
+  options.flush_interval = chrono::milliseconds::zero();
+  options.flush_level = LogLevel::kOff;
+  return options;
+}
+
+}  // namespace
+
+TEST(BufferedFileSink, Flush) {
+  File file;
+  auto sink = BufferedFileSink::Create(file.FileName(), NeverFlushOptions());
+  ASSERT_FALSE(sink.err());
+
+  (*sink)->Log("Message1");
+  (*sink)->Log("Message2");
+  EXPECT_EQ(file.Read(), "");
+
+  (*sink)->Flush();
+  EXPECT_EQ(file.Read(), "Message1\nMessage2\n");
+
+  (*sink)->Log("Message3");
+  (*sink)->Flush();
+  EXPECT_EQ(file.Read(), "Message1\nMessage2\nMessage3\n");
+}
+
+TEST(BufferedFileSink, Destruction) {
+  File file;
+  {
+    auto sink = BufferedFileSink::Create(file.FileName(), NeverFlushOptions());
+    ASSERT_FALSE(sink.err());
+    (*sink)->Log("Message");
+  }
+
+  EXPECT_EQ(file.Read(), "Message\n");
+}
+
+TEST(BufferedFileSink, FlushBySize) {
+  File file;
+  auto options = NeverFlushOptions();
+  options.buffer_size = 16;
+  auto sink = BufferedFileSink::Create(file.FileName(), options);
+  ASSERT_FALSE(sink.err());
+
+  (*sink)->Log("Message1");
+  EXPECT_EQ(file.Read(), "");
+  (*sink)->Log("Message2");
+  EXPECT_EQ(file.Read(), "Message1\nMessage2\n");
+  (*sink)->Log("Message3");
+  EXPECT_EQ(file.Read(), "Message1\nMessage2\n");
+}
+
+TEST(BufferedFileSink, LongMessage) {
+  File file;
+  auto options = NeverFlushOptions();
+  options.buffer_size = 4;
+  auto sink = BufferedFileSink::Create(file.FileName(), options);
+  ASSERT_FALSE(sink.err());
+
+  (*sink)->Log("A");
+  const std::string message(1000, 'B');
+  (*sink)->Log(message);
+  EXPECT_EQ(file.Read(), "A\n" + message + "\n");
+}
+
+TEST(BufferedFileSink, FlushByLevel) {
+  File file;
+  auto options = NeverFlushOptions();
+  options.flush_level = LogLevel::kWarning;
+  auto sink = BufferedFileSink::Create(file.FileName(), options);
+  ASSERT_FALSE(sink.err());
+
+  LogRecord record;
+  record.level = LogLevel::kInfo;
+  record.message = "Info";
+  (*sink)->Emit(record);
+  EXPECT_EQ(file.Read(), "");
+
+  record.level = LogLevel::kWarning;
+  record.message = "Warning";
+  (*sink)->Emit(record);
+  EXPECT_EQ(file.Read(), "Info\nWarning\n");
+}
+
+TEST(BufferedFileSink, FlushByInterval) {
+  File file;
+  auto options = NeverFlushOptions();
+  options.flush_interval = chrono::milliseconds(1);
+  auto sink = BufferedFileSink::Create(file.FileName(), options);
+  ASSERT_FALSE(sink.err());
+
+  std::this_thread::sleep_for(chrono::milliseconds(2));
+  (*sink)->Log("Message");
+  EXPECT_EQ(file.Read(), "Message\n");
+}
+
+TEST(BufferedFileSink, FlushByIntervalWhenIdle) {
+  File file;
+  auto options = NeverFlushOptions();
+  options.flush_interval = chrono::milliseconds(10);
+  auto sink = BufferedFileSink::Create(file.FileName(), options);
+  ASSERT_FALSE(sink.err());
+
+  (*sink)->Log("Message");
+  // No more messages arrive, the background thread writes the buffer.
+  const auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+  while (file.Read().empty() && chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(chrono::milliseconds(1));
+  EXPECT_EQ(file.Read(), "Message\n");
+}
+
+TEST(BufferedFileSink, Logger) {
+  File file;
+  auto sink = BufferedFileSink::Create(file.FileName(), NeverFlushOptions());
+  ASSERT_FALSE(sink.err());
+
+  Logger logger(std::move(*sink));
+  Logger::SetGlobalLogger(&logger);
+
+  EXPECT_DEATH(RST_LOG_FATAL("Fatal"), "");
+  EXPECT_NE(file.Read().find("Fatal"), std::string::npos);
+}
+
+TEST(BufferedFileSink, Emergency) {
+  File file;
+  auto sink = BufferedFileSink::Create(file.FileName(), NeverFlushOptions());
+  ASSERT_FALSE(sink.err());
+
+  (*sink)->Log("Message1");
+  (*sink)->EmergencyLog("Message2");
+  EXPECT_EQ(file.Read(), "Message1\nMessage2\n");
+
+  (*sink)->Log("Message3");
+  EXPECT_EQ(file.Read(), "Message1\nMessage2\n");
+  (*sink)->EmergencyFlush();
+  EXPECT_EQ(file.Read(), "Message1\nMessage2\nMessage3\n");
+}
+
+TEST(BufferedFileSink, InvalidFilename) {
+  auto sink = BufferedFileSink::Create("/nonexistent/directory/file");
+  EXPECT_TRUE(sink.err());
+}
+
+}  // namespace rst
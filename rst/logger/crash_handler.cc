@@ -0,0 +1,209 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/crash_handler.h"
+
+#include "rst/macros/macros.h"
+#include "rst/macros/os.h"
+
+#if !RST_BUILDFLAG(OS_WIN)
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+
+#include "rst/logger/logger.h"
+#endif
+
+namespace rst {
+
+#if RST_BUILDFLAG(OS_WIN)
+void InstallCrashHandler() {}
+#else
+namespace {
+
+constexpr int kSignals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+constexpr int kMaxFrameNumber = 64;
+
+// The alternate signal stack for the stack overflow.
+alignas(16) char g_signal_stack[64 * 1024];
+
+std::string_view GetSignalName(const int signal_number) {
+  switch (signal_number) {
+    case SIGSEGV:
+      return "SIGSEGV";
+    case SIGBUS:
+      return "SIGBUS";
+    case SIGFPE:
+      return "SIGFPE";
+    case SIGILL:
+      return "SIGILL";
+    case SIGABRT:
+      return "SIGABRT";
+    default:
+      return "unknown";
+  }
+}
+
+// Builds a line in a fixed buffer, truncating it if needed.
+class LineWriter {
+ public:
+  LineWriter() = default;
+
+  void Append(const std::string_view str) {
+    const auto size = std::min(str.size(), std::size(buffer_) - size_);
+    std::memcpy(buffer_ + size_, str.data(), size);
+    size_ += size;
+  }
+
+  void AppendDecimal(uint64_t value) {
+    char digits[20];
+    auto begin = std::end(digits);
+    do {
+      *--begin = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value != 0);
+    Append(std::string_view(begin, static_cast<size_t>(std::end(digits) -
+                                                       begin)));
+  }
+
+  void AppendHex(uintptr_t value) {
+    char digits[2 + 2 * sizeof(value)];
+    auto begin = std::end(digits);
+    do {
+      *--begin = "0123456789abcdef"[value % 16];
+      value /= 16;
+    } while (value != 0);
+    *--begin = 'x';
+    *--begin = '0';
+    Append(std::string_view(begin, static_cast<size_t>(std::end(digits) -
+                                                       begin)));
+  }
+
+  std::string_view view() const { return std::string_view(buffer_, size_); }
+
+ private:
+  char buffer_[512];
+  size_t size_ = 0;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(LineWriter);
+};
+
+void WriteLine(const std::string_view line) {
+  if (Logger::EmergencyLog(line))
+    return;
+
+  (void)::write(STDERR_FILENO, line.data(), line.size());
+  (void)::write(STDERR_FILENO, "\n", 1);
+}
+
+void WriteFrame(const int index, void* const address) {
+  LineWriter line;
+  line.Append("    #");
+  line.AppendDecimal(static_cast<uint64_t>(index));
+  line.Append(" ");
+  line.AppendHex(reinterpret_cast<uintptr_t>(address));
+
+  Dl_info info = {};
+  if (::dladdr(address, &info) != 0) {
+    if (info.dli_sname != nullptr) {
+      line.Append(" ");
+      line.Append(info.dli_sname);
+      line.Append("+");
+      line.AppendHex(reinterpret_cast<uintptr_t>(address) -
+                     reinterpret_cast<uintptr_t>(info.dli_saddr));
+    }
+    if (info.dli_fname != nullptr) {
+      line.Append(" (");
+      line.Append(info.dli_fname);
+      line.Append(")");
+    }
+  }
+
+  WriteLine(line.view());
+}
+
+void HandleSignal(const int signal_number, siginfo_t* const info, void*) {
+  // A crash inside of the handler gets the default action.
+  for (const auto signal : kSignals)
+    (void)::signal(signal, SIG_DFL);
+
+  LineWriter line;
+  line.Append("*** Signal ");
+  line.AppendDecimal(static_cast<uint64_t>(signal_number));
+  line.Append(" (");
+  line.Append(GetSignalName(signal_number));
+  line.Append(")");
+  if (signal_number != SIGABRT && info != nullptr) {
+    line.Append(" at address ");
+    line.AppendHex(reinterpret_cast<uintptr_t>(info->si_addr));
+  }
+  line.Append(", stack trace:");
+  WriteLine(line.view());
+
+  void* frames[kMaxFrameNumber];
+  const auto frame_number = ::backtrace(frames, kMaxFrameNumber);
+  // Skips the handler itself.
+  for (auto i = 1; i < frame_number; i++)
+    WriteFrame(i - 1, frames[i]);
+
+  Logger::EmergencyFlush();
+
+  // The signal is blocked until the handler returns, the default action
+  // happens right after that.
+  (void)::raise(signal_number);
+}
+
+}  // namespace
+
+void InstallCrashHandler() {
+  // The first backtrace() loads libgcc, which isn't async-signal-safe.
+  void* frame = nullptr;
+  (void)::backtrace(&frame, 1);
+
+  stack_t stack = {};
+  stack.ss_sp = g_signal_stack;
+  stack.ss_size = sizeof(g_signal_stack);
+  (void)::sigaltstack(&stack, nullptr);
+
+  struct sigaction action = {};
+  action.sa_sigaction = &HandleSignal;
+  action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+  (void)::sigemptyset(&action.sa_mask);
+  for (const auto signal : kSignals)
+    (void)::sigaction(signal, &action, nullptr);
+}
+#endif  // RST_BUILDFLAG(OS_WIN)
+
+}  // namespace rst
@@ -0,0 +1,50 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_LOGGER_CRASH_HANDLER_H_
+#define RST_LOGGER_CRASH_HANDLER_H_
+
+namespace rst {
+
+// Installs handlers of SIGSEGV, SIGBUS, SIGFPE, SIGILL and SIGABRT that log
+// the signal and the stack trace with Logger::EmergencyLog(), drain the
+// buffered messages with Logger::EmergencyFlush() and re-raise the signal
+// with the default action. Without a global logger the report goes to
+// stderr. Aborts after RST_LOG_FATAL get the stack trace too.
+//
+// The report is best effort. The sinks are drained without locks or
+// allocations, but backtrace(3) and dladdr(3) aren't async-signal-safe: a
+// crash inside of the dynamic loader or malloc can deadlock the handler while
+// symbolizing. The frames are symbolized with dladdr(3), so the names of the
+// non-exported functions need -rdynamic. The stack overflow is reported for
+// the thread that installed the handlers only, since it has the alternate
+// signal stack. Does nothing on Windows.
+void InstallCrashHandler();
+
+}  // namespace rst
+
+#endif  // RST_LOGGER_CRASH_HANDLER_H_
@@ -0,0 +1,165 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/crash_handler.h"
+
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "rst/check/check.h"
+#include "rst/logger/async_sink.h"
+#include "rst/logger/buffered_file_sink.h"
+#include "rst/logger/json_lines_sink.h"
+#include "rst/logger/logger.h"
+#include "rst/macros/macros.h"
+#include "rst/macros/os.h"
+
+namespace chrono = std::chrono;
+
+namespace rst {
+namespace {
+
+class File {
+ public:
+  File() { RST_CHECK(std::tmpnam(buffer_) != nullptr); }
+  ~File() { std::remove(buffer_); }
+
+  NotNull<const char*> FileName() const { return buffer_; }
+
+  std::string Read() const {
+    std::ifstream f(buffer_);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+  }
+
+ private:
+  char buffer_[L_tmpnam];
+
+  RST_DISALLOW_COPY_AND_ASSIGN(File);
+};
+
+NotNull<std::unique_ptr<Sink>> CreateBufferedSink(
+    const NotNull<const char*> filename) {
+  BufferedFileSink::Options options;
+  options.flush_interval = chrono::milliseconds::zero();
+  options.flush_level = LogLevel::kOff;
+  auto sink = BufferedFileSink::Create(filename, options);
+  RST_CHECK(!sink.err());
+  return std::move(*sink);
+}
+
+void CrashWithBufferedSink(const NotNull<const char*> filename,
+                           const int signal_number) {
+  Logger logger(CreateBufferedSink(filename));
+  Logger::SetGlobalLogger(&logger);
+  InstallCrashHandler();
+
+  RST_LOG_INFO("Buffered message");
+  (void)std::raise(signal_number);
+}
+
+void CrashWithJsonLinesSink(const NotNull<const char*> filename) {
+  auto sink = JsonLinesSink::Create(filename);
+  RST_CHECK(!sink.err());
+  Logger logger(std::move(*sink));
+  Logger::SetGlobalLogger(&logger);
+  InstallCrashHandler();
+
+  RST_LOG_INFO("Last message");
+  (void)std::raise(SIGSEGV);
+}
+
+void AbortWithAsyncSink(const NotNull<const char*> filename) {
+  Logger logger(std::make_unique<AsyncSink>(CreateBufferedSink(filename)));
+  Logger::SetGlobalLogger(&logger);
+  InstallCrashHandler();
+
+  RST_LOG_INFO("Queued message");
+  RST_LOG_FATAL("Fatal message");
+}
+
+}  // namespace
+
+#if !RST_BUILDFLAG(OS_WIN)
+TEST(CrashHandler, Segfault) {
+  File file;
+  EXPECT_DEATH(CrashWithBufferedSink(file.FileName(), SIGSEGV), "");
+
+  const auto log = file.Read();
+  const auto message = log.find("Buffered message");
+  const auto signal = log.find("*** Signal 11 (SIGSEGV) at address 0x");
+  const auto frame = log.find("    #0 0x");
+  EXPECT_NE(message, std::string::npos);
+  EXPECT_NE(signal, std::string::npos);
+  EXPECT_NE(frame, std::string::npos);
+  EXPECT_LT(message, signal);
+  EXPECT_LT(signal, frame);
+}
+
+TEST(CrashHandler, JsonLines) {
+  File file;
+  EXPECT_DEATH(CrashWithJsonLinesSink(file.FileName()), "");
+
+  // The report lines are JSON objects too.
+  const auto log = file.Read();
+  const auto message = log.find(R"("message":"Last message"})");
+  const auto signal =
+      log.find(R"("message":"*** Signal 11 (SIGSEGV) at address 0x)");
+  const auto frame = log.find(R"("message":"    #0 0x)");
+  EXPECT_NE(message, std::string::npos);
+  EXPECT_NE(signal, std::string::npos);
+  EXPECT_NE(frame, std::string::npos);
+  EXPECT_LT(message, signal);
+  EXPECT_LT(signal, frame);
+}
+
+TEST(CrashHandler, Fatal) {
+  File file;
+  EXPECT_DEATH(AbortWithAsyncSink(file.FileName()), "");
+
+  const auto log = file.Read();
+  const auto message = log.find("Queued message");
+  const auto fatal = log.find("Fatal message");
+  const auto signal = log.find("*** Signal 6 (SIGABRT), stack trace:");
+  EXPECT_NE(message, std::string::npos);
+  EXPECT_NE(fatal, std::string::npos);
+  EXPECT_NE(signal, std::string::npos);
+  EXPECT_LT(message, fatal);
+  EXPECT_LT(fatal, signal);
+  EXPECT_NE(log.find("abort"), std::string::npos);
+}
+#endif  // !RST_BUILDFLAG(OS_WIN)
+
+}  // namespace rst
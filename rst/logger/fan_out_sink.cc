@@ -0,0 +1,129 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/fan_out_sink.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "rst/check/check.h"
+
+namespace rst {
+namespace {
+
+// Messages without a level pass all the filters except kOff.
+bool Passes(const LogLevel level, const LogLevel filter) {
+  if (filter == LogLevel::kOff)
+    return false;
+  return level == LogLevel::kAll ||
+         static_cast<int>(level) >= static_cast<int>(filter);
+}
+
+}  // namespace
+
+FanOutSink::FanOutSink() = default;
+
+FanOutSink::~FanOutSink() = default;
+
+void FanOutSink::AddSink(NotNull<std::shared_ptr<Sink>> sink,
+                         const LogLevel level) {
+  Entry entry;
+  entry.sink = std::move(sink).Take();
+  entry.level = level;
+  entries_.Update([&entry](const NotNull<std::vector<Entry>*> entries) {
+    entries->emplace_back(std::move(entry));
+  });
+}
+
+void FanOutSink::RemoveSink(const NotNull<Sink*> sink) {
+  entries_.Update([sink](const NotNull<std::vector<Entry>*> entries) {
+    const auto it = std::find_if(
+        entries->begin(), entries->end(),
+        [sink](const Entry& entry) { return entry.sink.get() == sink.get(); });
+    RST_DCHECK(it != entries->end());
+    entries->erase(it);
+  });
+}
+
+void FanOutSink::SetSinkLevel(const NotNull<Sink*> sink, const LogLevel level) {
+  entries_.Update([sink, level](const NotNull<std::vector<Entry>*> entries) {
+    const auto it = std::find_if(
+        entries->begin(), entries->end(),
+        [sink](const Entry& entry) { return entry.sink.get() == sink.get(); });
+    RST_DCHECK(it != entries->end());
+    it->level = level;
+  });
+}
+
+void FanOutSink::Log(const std::string_view message) {
+  LogRecord record;
+  record.message = message;
+  Emit(record);
+}
+
+void FanOutSink::Emit(const LogRecord& record) {
+  entries_.Read([&record](const std::vector<Entry>& entries) {
+    for (const auto& entry : entries) {
+      if (Passes(record.level, entry.level))
+        entry.sink->Emit(record);
+    }
+  });
+}
+
+void FanOutSink::Flush() {
+  entries_.Read([](const std::vector<Entry>& entries) {
+    for (const auto& entry : entries)
+      entry.sink->Flush();
+  });
+}
+
+void FanOutSink::EmitAndFlush(const LogRecord& record) {
+  entries_.Read([&record](const std::vector<Entry>& entries) {
+    for (const auto& entry : entries) {
+      if (Passes(record.level, entry.level))
+        entry.sink->EmitAndFlush(record);
+    }
+  });
+}
+
+void FanOutSink::EmergencyLog(const std::string_view message) {
+  entries_.ReadSignalSafe([message](const std::vector<Entry>& entries) {
+    for (const auto& entry : entries) {
+      if (Passes(LogLevel::kFatal, entry.level))
+        entry.sink->EmergencyLog(message);
+    }
+  });
+}
+
+void FanOutSink::EmergencyFlush() {
+  entries_.ReadSignalSafe([](const std::vector<Entry>& entries) {
+    for (const auto& entry : entries)
+      entry.sink->EmergencyFlush();
+  });
+}
+
+}  // namespace rst
@@ -0,0 +1,96 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_LOGGER_FAN_OUT_SINK_H_
+#define RST_LOGGER_FAN_OUT_SINK_H_
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "rst/logger/log_level.h"
+#include "rst/logger/sink.h"
+#include "rst/macros/macros.h"
+#include "rst/not_null/not_null.h"
+#include "rst/threading/read_mostly.h"
+
+namespace rst {
+
+// The sink that passes every message to a set of sinks, each with its own
+// level filter. The message is formatted once by the logger and the same
+// record is given to all the sinks.
+//
+// The set is read without locking and can be changed at runtime: changes are
+// published RCU-style and a removed sink is destroyed after all the messages
+// being written to it are done. The sinks must not change the set from their
+// logging functions.
+//
+// Example:
+//
+//   auto all = FileNameSink::Create("all.txt");
+//   auto errors = FileNameSink::Create("errors.txt");
+//   ...
+//   auto sink = std::make_unique<FanOutSink>();
+//   sink->AddSink(std::move(*all));
+//   sink->AddSink(std::move(*errors), LogLevel::kError);
+//   Logger logger(std::move(sink));
+//
+class FanOutSink : public Sink {
+ public:
+  FanOutSink();
+  ~FanOutSink() final;
+
+  // Messages of |level| and above are passed to |sink|, kOff disables it.
+  void AddSink(NotNull<std::shared_ptr<Sink>> sink,
+               LogLevel level = LogLevel::kAll);
+  void RemoveSink(NotNull<Sink*> sink);
+  void SetSinkLevel(NotNull<Sink*> sink, LogLevel level);
+
+  // Thread safe logging functions. Messages logged with Log() have no level
+  // and are passed to all the sinks.
+  void Log(std::string_view message) final;
+  void Emit(const LogRecord& record) final;
+
+  void Flush() final;
+  void EmitAndFlush(const LogRecord& record) final;
+  void EmergencyLog(std::string_view message) final;
+  void EmergencyFlush() final;
+
+ private:
+  struct Entry {
+    std::shared_ptr<Sink> sink;
+    LogLevel level = LogLevel::kAll;
+  };
+
+  ReadMostly<std::vector<Entry>> entries_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(FanOutSink);
+};
+
+}  // namespace rst
+
+#endif  // RST_LOGGER_FAN_OUT_SINK_H_
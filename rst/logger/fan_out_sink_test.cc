@@ -0,0 +1,230 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/fan_out_sink.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "rst/logger/logger.h"
+#include "rst/macros/macros.h"
+
+namespace rst {
+namespace {
+
+// Collects the messages with their levels to external vectors.
+class CollectingSink : public Sink {
+ public:
+  struct Message {
+    LogLevel level = LogLevel::kAll;
+    std::string text;
+    const char* data = nullptr;
+  };
+
+  explicit CollectingSink(const NotNull<std::vector<Message>*> messages)
+      : messages_(messages) {}
+
+  void Log(const std::string_view message) final {
+    LogRecord record;
+    record.message = message;
+    Emit(record);
+  }
+
+  void Emit(const LogRecord& record) final {
+    Message message;
+    message.level = record.level;
+    message.text = std::string(record.message);
+    message.data = record.message.data();
+    messages_->emplace_back(std::move(message));
+  }
+
+  void Flush() final { flush_count_++; }
+
+  int flush_count() const { return flush_count_; }
+
+ private:
+  const NotNull<std::vector<Message>*> messages_;
+  int flush_count_ = 0;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(CollectingSink);
+};
+
+std::vector<std::string> Texts(
+    const std::vector<CollectingSink::Message>& messages) {
+  std::vector<std::string> texts;
+  for (const auto& message : messages)
+    texts.emplace_back(message.text);
+  return texts;
+}
+
+}  // namespace
+
+TEST(FanOutSink, Levels) {
+  std::vector<CollectingSink::Message> all;
+  std::vector<CollectingSink::Message> errors;
+
+  auto sink = std::make_unique<FanOutSink>();
+  sink->AddSink(std::make_shared<CollectingSink>(&all));
+  sink->AddSink(std::make_shared<CollectingSink>(&errors), LogLevel::kError);
+
+  Logger logger(std::move(sink));
+  Logger::SetGlobalLogger(&logger);
+
+  Logger::Log(LogLevel::kDebug, "file", 1, "Debug");
+  Logger::Log(LogLevel::kError, "file", 2, "Error {}", 42);
+
+  const std::vector<std::string> expected_all = {"[DEBUG:file(1)] Debug",
+                                                 "[ERROR:file(2)] Error 42"};
+  const std::vector<std::string> expected_errors = {
+      "[ERROR:file(2)] Error 42"};
+  EXPECT_EQ(Texts(all), expected_all);
+  EXPECT_EQ(Texts(errors), expected_errors);
+
+  // The message is formatted once and shared.
+  EXPECT_EQ(all[1].data, errors[0].data);
+  EXPECT_EQ(errors[0].level, LogLevel::kError);
+}
+
+TEST(FanOutSink, LogWithoutLevel) {
+  std::vector<CollectingSink::Message> messages1;
+  std::vector<CollectingSink::Message> messages2;
+  std::vector<CollectingSink::Message> messages3;
+
+  FanOutSink sink;
+  sink.AddSink(std::make_shared<CollectingSink>(&messages1));
+  sink.AddSink(std::make_shared<CollectingSink>(&messages2), LogLevel::kFatal);
+  sink.AddSink(std::make_shared<CollectingSink>(&messages3), LogLevel::kOff);
+  sink.Log("Message");
+
+  EXPECT_EQ(Texts(messages1), std::vector<std::string>{"Message"});
+  EXPECT_EQ(Texts(messages2), std::vector<std::string>{"Message"});
+  EXPECT_TRUE(messages3.empty());
+}
+
+TEST(FanOutSink, RemoveAndSetLevel) {
+  std::vector<CollectingSink::Message> messages1;
+  std::vector<CollectingSink::Message> messages2;
+
+  FanOutSink sink;
+  auto sink1 = std::make_shared<CollectingSink>(&messages1);
+  auto sink2 = std::make_shared<CollectingSink>(&messages2);
+  sink.AddSink(std::shared_ptr<Sink>(sink1));
+  sink.AddSink(std::shared_ptr<Sink>(sink2));
+
+  LogRecord record;
+  record.level = LogLevel::kInfo;
+  record.message = "Message1";
+  sink.Emit(record);
+
+  sink.RemoveSink(sink1.get());
+  sink.SetSinkLevel(sink2.get(), LogLevel::kWarning);
+  sink.Emit(record);
+
+  record.level = LogLevel::kWarning;
+  record.message = "Message2";
+  sink.Emit(record);
+
+  EXPECT_EQ(Texts(messages1), std::vector<std::string>{"Message1"});
+  const std::vector<std::string> expected_messages2 = {"Message1",
+                                                       "Message2"};
+  EXPECT_EQ(Texts(messages2), expected_messages2);
+}
+
+TEST(FanOutSink, Flush) {
+  std::vector<CollectingSink::Message> messages1;
+  std::vector<CollectingSink::Message> messages2;
+
+  FanOutSink sink;
+  auto sink1 = std::make_shared<CollectingSink>(&messages1);
+  auto sink2 = std::make_shared<CollectingSink>(&messages2);
+  sink.AddSink(std::shared_ptr<Sink>(sink1));
+  sink.AddSink(std::shared_ptr<Sink>(sink2), LogLevel::kOff);
+
+  sink.Flush();
+  EXPECT_EQ(sink1->flush_count(), 1);
+  EXPECT_EQ(sink2->flush_count(), 1);
+
+  sink.LogAndFlush("Fatal");
+  EXPECT_EQ(Texts(messages1), std::vector<std::string>{"Fatal"});
+  EXPECT_EQ(messages1[0].level, LogLevel::kFatal);
+  EXPECT_EQ(sink1->flush_count(), 2);
+  EXPECT_TRUE(messages2.empty());
+}
+
+TEST(FanOutSink, ChangeWhileLogging) {
+  // Counts the messages from any thread.
+  class CountingSink : public Sink {
+   public:
+    explicit CountingSink(const NotNull<std::atomic<int>*> count)
+        : count_(count) {}
+    void Log(std::string_view) final {
+      count_->fetch_add(1, std::memory_order_relaxed);
+    }
+
+   private:
+    const NotNull<std::atomic<int>*> count_;
+  };
+
+  static constexpr auto kThreadNumber = 4;
+
+  std::atomic<int> count{0};
+  FanOutSink sink;
+  std::atomic<bool> should_stop{false};
+
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < kThreadNumber; i++) {
+    threads.emplace_back([&sink, &should_stop]() {
+      while (!should_stop.load(std::memory_order_relaxed))
+        sink.Log("Message");
+    });
+  }
+
+  for (auto i = 0; i < 100; i++) {
+    auto counting_sink = std::make_shared<CountingSink>(&count);
+    const auto counting_sink_ptr = counting_sink.get();
+    sink.AddSink(std::move(counting_sink));
+    std::this_thread::yield();
+    sink.RemoveSink(counting_sink_ptr);
+  }
+
+  should_stop.store(true, std::memory_order_relaxed);
+  for (auto& thread : threads)
+    thread.join();
+
+  const auto final_count = count.load();
+  sink.Log("Message");
+  EXPECT_EQ(count.load(), final_count);
+}
+
+}  // namespace rst
@@ -0,0 +1,219 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/file_descriptor.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#include "rst/macros/os.h"
+
+#if RST_BUILDFLAG(OS_WIN)
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+
+#include <limits>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace rst {
+namespace internal {
+
+#if RST_BUILDFLAG(OS_WIN)
+int OpenForWriting(const NotNull<const char*> filename) {
+  return ::_open(filename.get(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+                 _S_IREAD | _S_IWRITE);
+}
+
+int OpenForAppending(const NotNull<const char*> filename) {
+  return ::_open(filename.get(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY,
+                 _S_IREAD | _S_IWRITE);
+}
+
+size_t GetFileSize(const int fd) {
+  const auto size = ::_filelengthi64(fd);
+  return size < 0 ? 0 : static_cast<size_t>(size);
+}
+
+void Preallocate(int, size_t) {}
+
+void ReleasePreallocated(int, size_t) {}
+
+int GetFileDescriptor(const NotNull<std::FILE*> file) {
+  return ::_fileno(file.get());
+}
+
+void CloseFile(const int fd) {
+  if (fd != -1)
+    (void)::_close(fd);
+}
+
+bool WriteAll(const int fd, const NotNull<std::string_view*> pieces,
+              const size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    auto piece = pieces[i];
+    while (!piece.empty()) {
+      const auto size = static_cast<unsigned>(std::min<size_t>(
+          piece.size(), std::numeric_limits<int>::max()));
+      const auto written = ::_write(fd, piece.data(), size);
+      if (written < 0)
+        return false;
+      piece.remove_prefix(static_cast<size_t>(written));
+    }
+    pieces[i] = piece;
+  }
+
+  return true;
+}
+
+#else
+
+int OpenForWriting(const NotNull<const char*> filename) {
+  int fd = -1;
+  do {
+    fd = ::open(filename.get(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                0644);
+  } while (fd == -1 && errno == EINTR);
+  return fd;
+}
+
+int OpenForAppending(const NotNull<const char*> filename) {
+  int fd = -1;
+  do {
+    fd = ::open(filename.get(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                0644);
+  } while (fd == -1 && errno == EINTR);
+  return fd;
+}
+
+size_t GetFileSize(const int fd) {
+  struct ::stat st = {};
+  if (::fstat(fd, &st) != 0)
+    return 0;
+  return static_cast<size_t>(st.st_size);
+}
+
+void Preallocate(const int fd, const size_t size) {
+#if RST_BUILDFLAG(OS_LINUX)
+  // Allocates the blocks at once without moving the end of file, so appending
+  // writes don't update the file system metadata on every block.
+  int result = 0;
+  do {
+    result = ::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0,
+                         static_cast<::off_t>(size));
+  } while (result != 0 && errno == EINTR);
+#else
+  (void)fd;
+  (void)size;
+#endif
+}
+
+void ReleasePreallocated(const int fd, const size_t size) {
+#if RST_BUILDFLAG(OS_LINUX)
+  struct ::stat st = {};
+  if (::fstat(fd, &st) != 0)
+    return;
+
+  // Truncating to the same size drops the blocks past the end of file on most
+  // file systems, punching a hole covers the ones that ignore it like tmpfs.
+  int result = 0;
+  do {
+    result = ::ftruncate(fd, st.st_size);
+  } while (result != 0 && errno == EINTR);
+
+  const auto end = static_cast<::off_t>(size);
+  if (end > st.st_size) {
+    do {
+      result = ::fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                           st.st_size, end - st.st_size);
+    } while (result != 0 && errno == EINTR);
+  }
+#else
+  (void)fd;
+  (void)size;
+#endif
+}
+
+int GetFileDescriptor(const NotNull<std::FILE*> file) {
+  return ::fileno(file.get());
+}
+
+void CloseFile(const int fd) {
+  if (fd != -1)
+    (void)::close(fd);
+}
+
+bool WriteAll(const int fd, const NotNull<std::string_view*> pieces,
+              const size_t count) {
+  static constexpr size_t kMaxIovecNumber = 64;
+
+  size_t first = 0;
+  while (first < count) {
+    if (pieces[first].empty()) {
+      first++;
+      continue;
+    }
+
+    ::iovec iov[kMaxIovecNumber];
+    size_t iov_count = 0;
+    for (auto i = first; i < count && iov_count < kMaxIovecNumber; i++) {
+      if (pieces[i].empty())
+        continue;
+      // writev() doesn't change the buffers.
+      iov[iov_count].iov_base = const_cast<char*>(pieces[i].data());
+      iov[iov_count].iov_len = pieces[i].size();
+      iov_count++;
+    }
+
+    auto written = ::writev(fd, iov, static_cast<int>(iov_count));
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+
+    for (; first < count && written > 0; first++) {
+      auto& piece = pieces[first];
+      const auto n = std::min(piece.size(), static_cast<size_t>(written));
+      piece.remove_prefix(n);
+      written -= static_cast<ssize_t>(n);
+      if (!piece.empty())
+        break;
+    }
+  }
+
+  return true;
+}
+#endif
+
+}  // namespace internal
+}  // namespace rst
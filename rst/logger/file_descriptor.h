@@ -0,0 +1,71 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_LOGGER_FILE_DESCRIPTOR_H_
+#define RST_LOGGER_FILE_DESCRIPTOR_H_
+
+#include <cstddef>
+#include <cstdio>
+#include <string_view>
+
+#include "rst/not_null/not_null.h"
+
+namespace rst {
+namespace internal {
+
+// Opens |filename| for writing, truncates it. Returns -1 on error.
+int OpenForWriting(NotNull<const char*> filename);
+
+// Opens |filename| for appending, creates it if needed. Returns -1 on error.
+int OpenForAppending(NotNull<const char*> filename);
+
+// Returns the size of the file, 0 on error.
+size_t GetFileSize(int fd);
+
+// Reserves disk space for the first |size| bytes of the file without changing
+// its size where the system supports it. Best effort.
+void Preallocate(int fd, size_t size);
+
+// Frees the disk space reserved by Preallocate(|fd|, |size|) past the end of
+// the file. Best effort.
+void ReleasePreallocated(int fd, size_t size);
+
+// Returns the descriptor of the |file| stream.
+int GetFileDescriptor(NotNull<std::FILE*> file);
+
+// Closes |fd| if it's not -1.
+void CloseFile(int fd);
+
+// Writes |pieces| to |fd| with as few system calls as possible, retrying on
+// partial writes and interrupts. Changes |pieces| in process. Returns false on
+// error.
+bool WriteAll(int fd, NotNull<std::string_view*> pieces, size_t count);
+
+}  // namespace internal
+}  // namespace rst
+
+#endif  // RST_LOGGER_FILE_DESCRIPTOR_H_
@@ -0,0 +1,109 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/file_descriptor.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace rst {
+namespace internal {
+
+TEST(FileDescriptor, WriteAll) {
+  char filename[L_tmpnam];
+  ASSERT_NE(std::tmpnam(filename), nullptr);
+
+  const auto fd = OpenForWriting(filename);
+  ASSERT_NE(fd, -1);
+
+  // More pieces than a single writev() call takes, with empty ones between.
+  std::vector<std::string> strings;
+  std::vector<std::string_view> pieces;
+  std::string expected;
+  for (size_t i = 0; i < 200; i++) {
+    strings.emplace_back(std::to_string(i));
+    expected += strings.back();
+  }
+  for (const auto& str : strings) {
+    pieces.emplace_back(str);
+    pieces.emplace_back();
+  }
+
+  EXPECT_TRUE(WriteAll(fd, pieces.data(), pieces.size()));
+  for (const auto piece : pieces)
+    EXPECT_TRUE(piece.empty());
+  CloseFile(fd);
+
+  std::ifstream f(filename);
+  std::stringstream ss;
+  ss << f.rdbuf();
+  EXPECT_EQ(ss.str(), expected);
+
+  std::remove(filename);
+}
+
+TEST(FileDescriptor, Append) {
+  char filename[L_tmpnam];
+  ASSERT_NE(std::tmpnam(filename), nullptr);
+
+  for (const auto* str : {"First", "Second"}) {
+    const auto fd = OpenForAppending(filename);
+    ASSERT_NE(fd, -1);
+    Preallocate(fd, 4096);
+    std::string_view piece(str);
+    EXPECT_TRUE(WriteAll(fd, &piece, 1));
+    CloseFile(fd);
+  }
+
+  const auto fd = OpenForAppending(filename);
+  ASSERT_NE(fd, -1);
+  EXPECT_EQ(GetFileSize(fd), 11U);
+  CloseFile(fd);
+
+  std::ifstream f(filename);
+  std::stringstream ss;
+  ss << f.rdbuf();
+  EXPECT_EQ(ss.str(), "FirstSecond");
+
+  std::remove(filename);
+}
+
+TEST(FileDescriptor, OpenError) {
+  EXPECT_EQ(OpenForWriting("/nonexistent/directory/file"), -1);
+  EXPECT_EQ(OpenForAppending("/nonexistent/directory/file"), -1);
+  CloseFile(-1);
+}
+
+}  // namespace internal
+}  // namespace rst
@@ -27,10 +27,12 @@
 
 #include "rst/logger/file_name_sink.h"
 
-#include <limits>
+#include <iterator>
+#include <string_view>
 #include <utility>
 
 #include "rst/check/check.h"
+#include "rst/logger/file_descriptor.h"
 #include "rst/logger/log_error.h"
 #include "rst/memory/memory.h"
 #include "rst/strings/str_cat.h"
@@ -38,30 +40,32 @@
 namespace rst {
 
 FileNameSink::FileNameSink() = default;
-FileNameSink::~FileNameSink() = default;
+FileNameSink::~FileNameSink() { internal::CloseFile(fd_); }
 
 // static
 StatusOr<NotNull<std::unique_ptr<FileNameSink>>> FileNameSink::Create(
     const NotNull<const char*> filename) {
   auto sink = WrapUnique(NotNull(new FileNameSink()));
 
-  sink->log_file_.reset(std::fopen(filename.get(), "w"));
-  if (sink->log_file_ == nullptr)
+  sink->fd_ = internal::OpenForWriting(filename);
+  if (sink->fd_ == -1)
     return MakeStatus<LogError>(StrCat({"Can't open file ", filename}));
 
   return sink;
 }
 
 void FileNameSink::Log(const std::string_view message) {
-  std::lock_guard lock(mutex_);
+  MutexLock lock(&mutex_);
 
-  RST_DCHECK(message.size() <= std::numeric_limits<int>::max());
-  auto val = std::fprintf(log_file_.get(), "%.*s\n",
-                          static_cast<int>(message.size()), message.data());
-  RST_CHECK(val >= 0);
+  // The line and the newline go with a single writev(2), nothing is
+  // buffered in the process.
+  std::string_view pieces[] = {message, "\n"};
+  RST_CHECK(internal::WriteAll(fd_, pieces, std::size(pieces)));
+}
 
-  val = std::fflush(log_file_.get());
-  RST_CHECK(val == 0);
+void FileNameSink::EmergencyLog(const std::string_view message) {
+  std::string_view pieces[] = {message, "\n"};
+  (void)internal::WriteAll(fd_, pieces, std::size(pieces));
 }
 
 }  // namespace rst
@@ -28,15 +28,14 @@
 #ifndef RST_LOGGER_FILE_NAME_SINK_H_
 #define RST_LOGGER_FILE_NAME_SINK_H_
 
-#include <cstdio>
 #include <memory>
-#include <mutex>
 
 #include "rst/logger/sink.h"
 #include "rst/macros/macros.h"
 #include "rst/not_null/not_null.h"
 #include "rst/status/status.h"
 #include "rst/status/status_or.h"
+#include "rst/threading/mutex.h"
 
 namespace rst {
 
@@ -52,18 +51,16 @@ class FileNameSink : public Sink {
   // Thread safe logging function.
   void Log(std::string_view message) final;
 
+  // Writes to the descriptor directly.
+  void EmergencyLog(std::string_view message) final;
+
  private:
   FileNameSink();
 
-  // A RAII-wrapper around std::FILE.
-  std::unique_ptr<std::FILE, void (*)(std::FILE*)> log_file_{
-      nullptr, [](std::FILE* f) {
-        if (f != nullptr)
-          (void)std::fclose(f);
-      }};
+  int fd_ = -1;
 
   // Mutex for thread-safe Log() function.
-  std::mutex mutex_;
+  Mutex mutex_{"FileNameSink"};
 
   RST_DISALLOW_COPY_AND_ASSIGN(FileNameSink);
 };
@@ -27,15 +27,17 @@
 
 #include "rst/logger/file_ptr_sink.h"
 
-#include <limits>
+#include <iterator>
+#include <string_view>
 
 #include "rst/check/check.h"
+#include "rst/logger/file_descriptor.h"
 
 namespace rst {
 
 FilePtrSink::FilePtrSink(const NotNull<std::FILE*> file,
                          const ShouldClose should_close)
-    : file_(file) {
+    : file_(file), fd_(internal::GetFileDescriptor(file)) {
   if (should_close)
     log_file_.reset(file.get());
 }
@@ -43,15 +45,21 @@ FilePtrSink::FilePtrSink(const NotNull<std::FILE*> file,
 FilePtrSink::~FilePtrSink() = default;
 
 void FilePtrSink::Log(const std::string_view message) {
-  std::lock_guard lock(mutex_);
+  MutexLock lock(&mutex_);
 
-  RST_DCHECK(message.size() <= std::numeric_limits<int>::max());
-  auto val = std::fprintf(file_.get(), "%.*s\n",
-                          static_cast<int>(message.size()), message.data());
-  RST_CHECK(val >= 0);
+  // Writes out anything buffered in the stream by other code first, that's
+  // a no-op usually.
+  RST_CHECK(std::fflush(file_.get()) == 0);
 
-  val = std::fflush(file_.get());
-  RST_CHECK(val == 0);
+  // The line and the newline go with a single writev(2) without copying to
+  // the stream buffer.
+  std::string_view pieces[] = {message, "\n"};
+  RST_CHECK(internal::WriteAll(fd_, pieces, std::size(pieces)));
+}
+
+void FilePtrSink::EmergencyLog(const std::string_view message) {
+  std::string_view pieces[] = {message, "\n"};
+  (void)internal::WriteAll(fd_, pieces, std::size(pieces));
 }
 
 }  // namespace rst
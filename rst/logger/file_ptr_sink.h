@@ -30,11 +30,11 @@
 
 #include <cstdio>
 #include <memory>
-#include <mutex>
 
 #include "rst/logger/sink.h"
 #include "rst/macros/macros.h"
 #include "rst/not_null/not_null.h"
+#include "rst/threading/mutex.h"
 #include "rst/type/type.h"
 
 namespace rst {
@@ -53,6 +53,9 @@ class FilePtrSink : public Sink {
   // Thread safe logging function.
   void Log(std::string_view message) final;
 
+  // Writes to the descriptor directly, skipping the stream buffer.
+  void EmergencyLog(std::string_view message) final;
+
  private:
   // A RAII-wrapper around std::FILE.
   std::unique_ptr<std::FILE, void (*)(std::FILE*)> log_file_{
@@ -62,9 +65,10 @@ class FilePtrSink : public Sink {
       }};
 
   const NotNull<std::FILE*> file_;
+  const int fd_;
 
   // Mutex for thread-safe Log function.
-  std::mutex mutex_;
+  Mutex mutex_{"FilePtrSink"};
 
   RST_DISALLOW_COPY_AND_ASSIGN(FilePtrSink);
 };
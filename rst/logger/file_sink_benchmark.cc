@@ -0,0 +1,103 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+#include <benchmark/benchmark.h>
+
+#include "rst/check/check.h"
+#include "rst/logger/file_name_sink.h"
+#include "rst/logger/file_ptr_sink.h"
+#include "rst/logger/logger.h"
+
+// Compares the per line cost of the file sinks with the fprintf(3) + fflush(3)
+// they used before. All write to /dev/null, so the numbers are the user space
+// overhead plus one system call.
+
+namespace rst {
+namespace {
+
+constexpr std::string_view kMessage =
+    "[INFO:benchmark.cc(1)] A typical log message 42";
+
+void BM_FprintfLine(benchmark::State& state) {
+  auto file = std::fopen("/dev/null", "w");
+  RST_CHECK(file != nullptr);
+
+  for (auto _ : state) {
+    RST_DCHECK(kMessage.size() <= std::numeric_limits<int>::max());
+    RST_CHECK(std::fprintf(file, "%.*s\n", static_cast<int>(kMessage.size()),
+                           kMessage.data()) >= 0);
+    RST_CHECK(std::fflush(file) == 0);
+  }
+
+  (void)std::fclose(file);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FprintfLine);
+
+void BM_FilePtrSinkLine(benchmark::State& state) {
+  auto file = std::fopen("/dev/null", "w");
+  RST_CHECK(file != nullptr);
+  FilePtrSink sink(file);
+
+  for (auto _ : state)
+    sink.Log(kMessage);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FilePtrSinkLine);
+
+void BM_FileNameSinkLine(benchmark::State& state) {
+  auto sink = FileNameSink::Create("/dev/null");
+  RST_CHECK(!sink.err());
+
+  for (auto _ : state)
+    (*sink)->Log(kMessage);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FileNameSinkLine);
+
+// The whole path: the prefix and the message are formatted to the per-thread
+// line buffer and written out with a single writev(2).
+void BM_LoggerFormattedLine(benchmark::State& state) {
+  auto sink = FileNameSink::Create("/dev/null");
+  RST_CHECK(!sink.err());
+  Logger logger(std::move(*sink));
+  Logger::SetGlobalLogger(&logger);
+
+  for (auto _ : state)
+    RST_LOG_INFO("A typical log message {}", 42);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LoggerFormattedLine);
+
+}  // namespace
+}  // namespace rst
@@ -0,0 +1,258 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/json_lines_sink.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+#include "rst/check/check.h"
+#include "rst/logger/file_descriptor.h"
+#include "rst/logger/log_error.h"
+#include "rst/memory/memory.h"
+#include "rst/strings/arg.h"
+#include "rst/strings/str_cat.h"
+
+namespace chrono = std::chrono;
+
+namespace rst {
+namespace {
+
+// The per-thread buffer the JSON line is rendered to.
+NotNull<std::string*> GetLineBuffer() {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+  thread_local std::string buffer;
+#pragma clang diagnostic pop
+  buffer.clear();
+  return &buffer;
+}
+
+// The fixed-size line buffer for the signal handlers, which can't allocate.
+class StackLine {
+ public:
+  static constexpr size_t kSize = 4096;
+  // Leaves the room for the worst case escaping, which makes a byte 6 bytes,
+  // and the rest of the object.
+  static constexpr size_t kMaxMessageSize = (kSize - 64) / 6;
+
+  void push_back(const char c) {
+    RST_DCHECK(size_ < kSize);
+    data_[size_++] = c;
+  }
+
+  void append(const std::string_view str) { append(str.data(), str.size()); }
+  void append(const char* str, const size_t size) {
+    RST_DCHECK(size <= kSize - size_);
+    std::memcpy(data_ + size_, str, size);
+    size_ += size;
+  }
+
+  std::string_view view() const { return std::string_view(data_, size_); }
+
+ private:
+  char data_[kSize];
+  size_t size_ = 0;
+};
+
+template <class Output>
+void AppendString(const NotNull<Output*> out, const std::string_view str) {
+  static constexpr char kHexDigits[] = "0123456789abcdef";
+
+  out->push_back('"');
+  for (const auto c : str) {
+    switch (c) {
+      case '"': {
+        out->append("\\\"");
+        break;
+      }
+      case '\\': {
+        out->append("\\\\");
+        break;
+      }
+      case '\n': {
+        out->append("\\n");
+        break;
+      }
+      case '\r': {
+        out->append("\\r");
+        break;
+      }
+      case '\t': {
+        out->append("\\t");
+        break;
+      }
+      default: {
+        const auto byte = static_cast<unsigned char>(c);
+        if (byte < 0x20) {
+          const char escaped[] = {'\\',
+                                  'u',
+                                  '0',
+                                  '0',
+                                  kHexDigits[byte >> 4],
+                                  kHexDigits[byte & 0xf]};
+          out->append(escaped, std::size(escaped));
+        } else {
+          out->push_back(c);
+        }
+        break;
+      }
+    }
+  }
+  out->push_back('"');
+}
+
+template <class Output>
+void AppendKey(const NotNull<Output*> out, const std::string_view key) {
+  out->push_back(',');
+  AppendString(out, key);
+  out->push_back(':');
+}
+
+void AppendValue(const NotNull<std::string*> out, const LogValue& value) {
+  switch (value.type()) {
+    case LogValue::Type::kDouble: {
+      if (!std::isfinite(value.double_value())) {
+        out->append("null");
+        return;
+      }
+      internal::AppendLogValue(out, value);
+      return;
+    }
+    case LogValue::Type::kString: {
+      AppendString(out, value.string_value());
+      return;
+    }
+    case LogValue::Type::kBool:
+    case LogValue::Type::kInt:
+    case LogValue::Type::kUint: {
+      internal::AppendLogValue(out, value);
+      return;
+    }
+  }
+}
+
+// Starts the object with the "time" key.
+template <class Output>
+void AppendTime(const NotNull<Output*> out) {
+  const auto now = chrono::duration_cast<chrono::microseconds>(
+                       chrono::system_clock::now().time_since_epoch())
+                       .count();
+  const internal::Arg second(now / 1000000);
+  const internal::Arg microsecond(1000000 + now % 1000000);
+
+  out->append("{\"time\":");
+  out->append(second.view());
+  out->push_back('.');
+  // Skips the leading 1 that keeps the zeros.
+  out->append(microsecond.view().substr(1));
+}
+
+}  // namespace
+
+JsonLinesSink::JsonLinesSink(const int fd) : fd_(fd) {
+  RST_DCHECK(fd_ != -1);
+}
+
+JsonLinesSink::~JsonLinesSink() { internal::CloseFile(fd_); }
+
+// static
+StatusOr<NotNull<std::unique_ptr<JsonLinesSink>>> JsonLinesSink::Create(
+    const NotNull<const char*> filename) {
+  const auto fd = internal::OpenForWriting(filename);
+  if (fd == -1)
+    return MakeStatus<LogError>(StrCat({"Can't open file ", filename}));
+
+  return WrapUnique(NotNull(new JsonLinesSink(fd)));
+}
+
+void JsonLinesSink::Log(const std::string_view message) {
+  const auto line = GetLineBuffer();
+  AppendTime(line);
+  AppendKey(line, "message");
+  AppendString(line, message);
+  line->push_back('}');
+  Write(*line);
+}
+
+void JsonLinesSink::Emit(const LogRecord& record) {
+  const auto line = GetLineBuffer();
+  AppendTime(line);
+  if (record.level != LogLevel::kAll) {
+    AppendKey(line, "level");
+    AppendString(line, LogLevelToString(record.level));
+  }
+
+  if (record.filename == nullptr) {
+    AppendKey(line, "message");
+    AppendString(line, record.message);
+    line->push_back('}');
+    Write(*line);
+    return;
+  }
+
+  AppendKey(line, "file");
+  AppendString(line, record.filename.get());
+  AppendKey(line, "line");
+  line->append(internal::Arg(record.line).view());
+  AppendKey(line, "message");
+  AppendString(line, record.text);
+
+  if (record.fields != nullptr) {
+    for (size_t i = 0; i < record.field_count; i++) {
+      AppendKey(line, record.fields[i].key);
+      AppendValue(line, record.fields[i].value);
+    }
+  }
+
+  line->push_back('}');
+  Write(*line);
+}
+
+void JsonLinesSink::EmergencyLog(const std::string_view message) {
+  StackLine line;
+  AppendTime(NotNull(&line));
+  AppendKey(NotNull(&line), "message");
+  AppendString(NotNull(&line), message.substr(0, StackLine::kMaxMessageSize));
+  line.push_back('}');
+
+  std::string_view pieces[] = {line.view(), "\n"};
+  (void)internal::WriteAll(fd_, pieces, std::size(pieces));
+}
+
+void JsonLinesSink::Write(const std::string_view line) {
+  MutexLock lock(&mutex_);
+  std::string_view pieces[] = {line, "\n"};
+  RST_CHECK(internal::WriteAll(fd_, pieces, std::size(pieces)));
+}
+
+}  // namespace rst
@@ -0,0 +1,83 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_LOGGER_JSON_LINES_SINK_H_
+#define RST_LOGGER_JSON_LINES_SINK_H_
+
+#include <memory>
+#include <string_view>
+
+#include "rst/logger/sink.h"
+#include "rst/macros/macros.h"
+#include "rst/not_null/not_null.h"
+#include "rst/status/status_or.h"
+#include "rst/threading/mutex.h"
+
+namespace rst {
+
+// The file sink that writes a JSON object per line, so the log can be parsed
+// without regular expressions:
+//
+//   {"time":1580515199.123456,"level":"INFO","file":"server.cc","line":42,
+//    "message":"Uploaded","request":42,"user":"bob"}
+//
+// "time" is the Unix time in seconds. The fields follow with their types
+// kept: numbers, booleans and strings, non-finite doubles become null. The
+// field keys aren't checked against the fixed ones. Messages logged with Log()
+// have the whole line as "message" only. The line is rendered to a reused
+// per-thread buffer and written with a single writev(2).
+class JsonLinesSink : public Sink {
+ public:
+  // Opens a |filename| for writing. Returns LogError on error.
+  static StatusOr<NotNull<std::unique_ptr<JsonLinesSink>>> Create(
+      NotNull<const char*> filename);
+
+  ~JsonLinesSink() final;
+
+  // Thread safe logging functions.
+  void Log(std::string_view message) final;
+  void Emit(const LogRecord& record) final;
+
+  // Writes the message like Log() but without locking or allocating. Messages
+  // longer than a few hundred bytes are truncated.
+  void EmergencyLog(std::string_view message) final;
+
+ private:
+  explicit JsonLinesSink(int fd);
+
+  void Write(std::string_view line);
+
+  const int fd_;
+
+  Mutex mutex_{"JsonLinesSink"};
+
+  RST_DISALLOW_COPY_AND_ASSIGN(JsonLinesSink);
+};
+
+}  // namespace rst
+
+#endif  // RST_LOGGER_JSON_LINES_SINK_H_
@@ -0,0 +1,150 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/json_lines_sink.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "rst/check/check.h"
+#include "rst/logger/logger.h"
+#include "rst/macros/macros.h"
+
+namespace rst {
+namespace {
+
+class File {
+ public:
+  File() { RST_CHECK(std::tmpnam(buffer_) != nullptr); }
+  ~File() { std::remove(buffer_); }
+
+  NotNull<const char*> FileName() const { return buffer_; }
+
+  std::vector<std::string> ReadLines() const {
+    std::ifstream f(buffer_);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(f, line))
+      lines.emplace_back(std::move(line));
+    return lines;
+  }
+
+ private:
+  char buffer_[L_tmpnam];
+
+  RST_DISALLOW_COPY_AND_ASSIGN(File);
+};
+
+// Removes the "time" value that changes from run to run.
+std::string RemoveTime(const std::string& line) {
+  static const std::regex kTime(R"(^\{"time":[0-9]+\.[0-9]{6},)");
+  EXPECT_TRUE(std::regex_search(line, kTime)) << line;
+  return std::regex_replace(line, kTime, "{");
+}
+
+}  // namespace
+
+TEST(JsonLinesSink, Logger) {
+  File file;
+  {
+    auto sink = JsonLinesSink::Create(file.FileName());
+    ASSERT_FALSE(sink.err());
+    Logger logger(std::move(*sink));
+    Logger::SetGlobalLogger(&logger);
+
+    const std::string user = "bob \"the\" user";
+    RST_LOG_SCOPE("request", 42);
+    RST_LOG_FIELDS(INFO,
+                   LogFields("user", user, "ok", true, "bytes", 1024U,
+                             "ratio", 0.5, "nan", std::nan("")),
+                   "Uploaded\n{}", "file");
+  }
+
+  const auto lines = file.ReadLines();
+  ASSERT_EQ(lines.size(), 1U);
+  const std::string expected = std::string(R"({"level":"INFO","file":")") +
+                               __FILE__ +
+                               R"(","line":)" + std::to_string(__LINE__ - 10) +
+                               R"(,"message":"Uploaded\nfile","request":42,)"
+                               R"("user":"bob \"the\" user","ok":true,)"
+                               R"("bytes":1024,"ratio":0.5,"nan":null})";
+  EXPECT_EQ(RemoveTime(lines[0]), expected);
+}
+
+TEST(JsonLinesSink, Fatal) {
+  File file;
+  EXPECT_DEATH(
+      {
+        auto sink = JsonLinesSink::Create(file.FileName());
+        RST_CHECK(!sink.err());
+        Logger logger(std::move(*sink));
+        Logger::SetGlobalLogger(&logger);
+
+        RST_LOG_SCOPE("request", 42);
+        RST_LOG_FIELDS(FATAL, LogFields("user", "bob"), "Failed {}", "upload");
+      },
+      "");
+
+  const auto lines = file.ReadLines();
+  ASSERT_EQ(lines.size(), 1U);
+  const std::string expected = std::string(R"({"level":"FATAL","file":")") +
+                               __FILE__ + R"(","line":)" +
+                               std::to_string(__LINE__ - 8) +
+                               R"(,"message":"Failed upload","request":42,)"
+                               R"("user":"bob"})";
+  EXPECT_EQ(RemoveTime(lines[0]), expected);
+}
+
+TEST(JsonLinesSink, Log) {
+  File file;
+  {
+    auto sink = JsonLinesSink::Create(file.FileName());
+    ASSERT_FALSE(sink.err());
+    (*sink)->Log("Plain \\ line\x01");
+    (*sink)->LogAndFlush("Fatal");
+  }
+
+  const auto lines = file.ReadLines();
+  ASSERT_EQ(lines.size(), 2U);
+  EXPECT_EQ(RemoveTime(lines[0]), R"({"message":"Plain \\ line\u0001"})");
+  EXPECT_EQ(RemoveTime(lines[1]), R"({"level":"FATAL","message":"Fatal"})");
+}
+
+TEST(JsonLinesSink, InvalidFilename) {
+  auto sink = JsonLinesSink::Create("/nonexistent/directory/file");
+  EXPECT_TRUE(sink.err());
+}
+
+}  // namespace rst
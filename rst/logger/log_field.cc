@@ -0,0 +1,83 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/log_field.h"
+
+#include "rst/strings/arg.h"
+
+namespace rst {
+namespace internal {
+
+void AppendLogValue(const NotNull<std::string*> out, const LogValue& value) {
+  switch (value.type()) {
+    case LogValue::Type::kBool: {
+      out->append(Arg(value.bool_value()).view());
+      break;
+    }
+    case LogValue::Type::kInt: {
+      out->append(Arg(value.int_value()).view());
+      break;
+    }
+    case LogValue::Type::kUint: {
+      out->append(Arg(value.uint_value()).view());
+      break;
+    }
+    case LogValue::Type::kDouble: {
+      out->append(Arg(value.double_value()).view());
+      break;
+    }
+    case LogValue::Type::kString: {
+      out->append(value.string_value());
+      break;
+    }
+  }
+}
+
+}  // namespace internal
+
+namespace {
+
+thread_local const LogScope* g_current_scope = nullptr;
+
+}  // namespace
+
+LogScope::LogScope(const std::string_view key, const LogValue value)
+    : prev_(g_current_scope) {
+  field_.key = key;
+  field_.value = value;
+  g_current_scope = this;
+}
+
+LogScope::~LogScope() {
+  RST_DCHECK(g_current_scope == this);
+  g_current_scope = prev_.get();
+}
+
+// static
+Nullable<const LogScope*> LogScope::GetCurrent() { return g_current_scope; }
+
+}  // namespace rst
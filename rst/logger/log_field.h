@@ -0,0 +1,209 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_LOGGER_LOG_FIELD_H_
+#define RST_LOGGER_LOG_FIELD_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "rst/check/check.h"
+#include "rst/macros/macros.h"
+#include "rst/not_null/not_null.h"
+
+// Structured key/value fields attached to log messages.
+//
+// Example:
+//
+//   RST_LOG_SCOPE("request", request_id);  // Until the end of the scope.
+//   RST_LOG_FIELDS(INFO, LogFields("user", name, "bytes", size), "Uploaded");
+//
+// Text sinks get the fields appended to the line: "Uploaded request=42
+// user=bob bytes=1024". Sinks that implement Emit() get them typed in the
+// LogRecord, e.g. JsonLinesSink. Strings are referenced, not copied, so they
+// must outlive the scope or the call.
+
+// Adds a field to all the messages logged by the current thread until the end
+// of the enclosing scope.
+#define RST_LOG_SCOPE(key, value) \
+  const ::rst::LogScope RST_CAT(rst_log_scope_, __LINE__)((key), (value))
+
+namespace rst {
+
+// A typed value of a log field.
+class LogValue {
+ public:
+  enum class Type {
+    kBool,
+    kInt,
+    kUint,
+    kDouble,
+    kString,
+  };
+
+  LogValue(const bool value)  // NOLINT(runtime/explicit)
+      : type_(Type::kBool), bool_(value) {}
+
+  template <class Int, class = typename std::enable_if<
+                           std::is_integral<Int>::value &&
+                           !std::is_same<Int, bool>::value>::type>
+  LogValue(const Int value) {  // NOLINT(runtime/explicit)
+    if constexpr (std::is_signed<Int>::value) {
+      type_ = Type::kInt;
+      int_ = value;
+    } else {
+      type_ = Type::kUint;
+      uint_ = value;
+    }
+  }
+
+  LogValue(const double value)  // NOLINT(runtime/explicit)
+      : type_(Type::kDouble), double_(value) {}
+
+  LogValue(const std::string_view value)  // NOLINT(runtime/explicit)
+      : type_(Type::kString), string_(value) {}
+  LogValue(const std::string& value)  // NOLINT(runtime/explicit)
+      : type_(Type::kString), string_(value) {}
+  // A temporary string would dangle.
+  LogValue(std::string&& value) = delete;  // NOLINT(runtime/explicit)
+  LogValue(const char* value)  // NOLINT(runtime/explicit)
+      : type_(Type::kString), string_(value) {
+    RST_DCHECK(value != nullptr);
+  }
+
+  // Prevents LogValue(pointer) from accidentally producing a bool.
+  LogValue(void*) = delete;  // NOLINT(runtime/explicit)
+
+  Type type() const { return type_; }
+
+  bool bool_value() const {
+    RST_DCHECK(type_ == Type::kBool);
+    return bool_;
+  }
+  int64_t int_value() const {
+    RST_DCHECK(type_ == Type::kInt);
+    return int_;
+  }
+  uint64_t uint_value() const {
+    RST_DCHECK(type_ == Type::kUint);
+    return uint_;
+  }
+  double double_value() const {
+    RST_DCHECK(type_ == Type::kDouble);
+    return double_;
+  }
+  std::string_view string_value() const {
+    RST_DCHECK(type_ == Type::kString);
+    return string_;
+  }
+
+ private:
+  Type type_ = Type::kBool;
+  union {
+    bool bool_;
+    int64_t int_;
+    uint64_t uint_;
+    double double_;
+    std::string_view string_;
+  };
+};
+
+struct LogField {
+  std::string_view key;
+  LogValue value = false;
+};
+
+namespace internal {
+
+inline void FillLogFields(NotNull<LogField*>) {}
+
+template <class Value, class... KeysAndValues>
+void FillLogFields(const NotNull<LogField*> fields, const std::string_view key,
+                   const Value& value,
+                   const KeysAndValues&... keys_and_values) {
+  fields->key = key;
+  fields->value = value;
+  FillLogFields(fields.get() + 1, keys_and_values...);
+}
+
+// Appends the text form of the |value|, strings as is.
+void AppendLogValue(NotNull<std::string*> out, const LogValue& value);
+
+}  // namespace internal
+
+// Makes the fields for RST_LOG_FIELDS from the alternating keys and values:
+// LogFields("user", name, "bytes", size).
+template <class... KeysAndValues>
+std::array<LogField, sizeof...(KeysAndValues) / 2> LogFields(
+    const KeysAndValues&... keys_and_values) {
+  static_assert(sizeof...(KeysAndValues) % 2 == 0,
+                "LogFields() takes keys and values in pairs");
+  std::array<LogField, sizeof...(KeysAndValues) / 2> fields;
+  if constexpr (sizeof...(KeysAndValues) != 0)
+    internal::FillLogFields(fields.data(), keys_and_values...);
+  return fields;
+}
+
+// Adds a field to the messages of the current thread while alive. Use
+// RST_LOG_SCOPE.
+class LogScope {
+ public:
+  LogScope(std::string_view key, LogValue value);
+  ~LogScope();
+
+  // Calls |visitor| with every field of the current thread from the outermost
+  // scope to the innermost one.
+  template <class Visitor>
+  static void ForEachField(Visitor&& visitor) {
+    VisitFrom(GetCurrent(), visitor);
+  }
+
+ private:
+  static Nullable<const LogScope*> GetCurrent();
+
+  template <class Visitor>
+  static void VisitFrom(const Nullable<const LogScope*> scope,
+                        Visitor& visitor) {
+    if (scope == nullptr)
+      return;
+    VisitFrom(scope->prev_, visitor);
+    visitor(scope->field_);
+  }
+
+  LogField field_;
+  const Nullable<const LogScope*> prev_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(LogScope);
+};
+
+}  // namespace rst
+
+#endif  // RST_LOGGER_LOG_FIELD_H_
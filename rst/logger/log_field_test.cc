@@ -0,0 +1,193 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/log_field.h"
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "rst/logger/logger.h"
+#include "rst/macros/macros.h"
+
+namespace rst {
+namespace {
+
+// Keeps the lines and the text of the fields of the messages.
+class FieldsSink : public Sink {
+ public:
+  struct Message {
+    std::string line;
+    std::string text;
+    std::vector<std::pair<std::string, LogValue::Type>> fields;
+  };
+
+  explicit FieldsSink(const NotNull<std::vector<Message>*> messages)
+      : messages_(messages) {}
+
+  void Log(const std::string_view message) final {
+    LogRecord record;
+    record.message = message;
+    Emit(record);
+  }
+
+  void Emit(const LogRecord& record) final {
+    Message message;
+    message.line = std::string(record.message);
+    message.text = std::string(record.text);
+    if (record.fields != nullptr) {
+      for (size_t i = 0; i < record.field_count; i++) {
+        message.fields.emplace_back(std::string(record.fields[i].key),
+                                    record.fields[i].value.type());
+      }
+    }
+    messages_->emplace_back(std::move(message));
+  }
+
+ private:
+  const NotNull<std::vector<Message>*> messages_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(FieldsSink);
+};
+
+}  // namespace
+
+TEST(LogField, Values) {
+  const std::string str = "string";
+  const auto fields = LogFields("bool", true, "int", -1, "uint", 2U, "double",
+                                0.5, "view", std::string_view("view"),
+                                "string", str, "chars", "chars");
+  ASSERT_EQ(fields.size(), 7U);
+
+  EXPECT_EQ(fields[0].key, "bool");
+  EXPECT_EQ(fields[0].value.type(), LogValue::Type::kBool);
+  EXPECT_TRUE(fields[0].value.bool_value());
+  EXPECT_EQ(fields[1].value.type(), LogValue::Type::kInt);
+  EXPECT_EQ(fields[1].value.int_value(), -1);
+  EXPECT_EQ(fields[2].value.type(), LogValue::Type::kUint);
+  EXPECT_EQ(fields[2].value.uint_value(), 2U);
+  EXPECT_EQ(fields[3].value.type(), LogValue::Type::kDouble);
+  EXPECT_EQ(fields[3].value.double_value(), 0.5);
+  EXPECT_EQ(fields[4].value.string_value(), "view");
+  EXPECT_EQ(fields[5].value.string_value(), "string");
+  EXPECT_EQ(fields[6].key, "chars");
+  EXPECT_EQ(fields[6].value.string_value(), "chars");
+
+  std::string text;
+  internal::AppendLogValue(&text, std::numeric_limits<int64_t>::min());
+  internal::AppendLogValue(&text, false);
+  EXPECT_EQ(text, "-9223372036854775808false");
+}
+
+TEST(LogField, Scope) {
+  std::vector<std::string> keys;
+  const auto collect = [&keys](const LogField& field) {
+    keys.emplace_back(field.key);
+  };
+
+  LogScope::ForEachField(collect);
+  EXPECT_TRUE(keys.empty());
+
+  {
+    RST_LOG_SCOPE("outer", 1);
+    {
+      RST_LOG_SCOPE("inner", 2);
+      LogScope::ForEachField(collect);
+    }
+    LogScope::ForEachField(collect);
+  }
+  LogScope::ForEachField(collect);
+
+  const std::vector<std::string> expected = {"outer", "inner", "outer"};
+  EXPECT_EQ(keys, expected);
+}
+
+TEST(LogField, Logger) {
+  std::vector<FieldsSink::Message> messages;
+  Logger logger(std::make_unique<FieldsSink>(&messages));
+  Logger::SetGlobalLogger(&logger);
+
+  const std::string user = "bob";
+  RST_LOG_INFO("No fields");
+  {
+    RST_LOG_SCOPE("request", 42);
+    RST_LOG_FIELDS(INFO, LogFields("user", user, "ok", true), "Uploaded {}",
+                   "file");
+    RST_LOG_WARNING("Scope only");
+  }
+  RST_LOG_FIELDS(ERROR, LogFields("ratio", 0.25), "Call only");
+  RST_LOG_FIELDS(DEBUG, LogFields(), "Empty");
+
+  ASSERT_EQ(messages.size(), 5U);
+
+  EXPECT_EQ(messages[0].text, "No fields");
+  EXPECT_TRUE(messages[0].fields.empty());
+
+  EXPECT_NE(
+      messages[1].line.find("] Uploaded file request=42 user=bob ok=true"),
+      std::string::npos);
+  EXPECT_EQ(messages[1].text, "Uploaded file");
+  const std::vector<std::pair<std::string, LogValue::Type>> expected_fields = {
+      {"request", LogValue::Type::kInt},
+      {"user", LogValue::Type::kString},
+      {"ok", LogValue::Type::kBool}};
+  EXPECT_EQ(messages[1].fields, expected_fields);
+
+  EXPECT_NE(messages[2].line.find("] Scope only request=42"),
+            std::string::npos);
+  EXPECT_EQ(messages[2].fields.size(), 1U);
+
+  EXPECT_NE(messages[3].line.find("] Call only ratio=0.25"),
+            std::string::npos);
+  EXPECT_EQ(messages[3].text, "Call only");
+
+  EXPECT_NE(messages[4].line.find("] Empty"), std::string::npos);
+  EXPECT_TRUE(messages[4].fields.empty());
+}
+
+TEST(LogField, DisabledLevel) {
+  std::vector<FieldsSink::Message> messages;
+  Logger logger(std::make_unique<FieldsSink>(&messages));
+  logger.set_level(LogLevel::kWarning);
+  Logger::SetGlobalLogger(&logger);
+
+  auto evaluated = false;
+  const auto get_value = [&evaluated]() {
+    evaluated = true;
+    return 1;
+  };
+  RST_LOG_FIELDS(INFO, LogFields("value", get_value()), "Message");
+  EXPECT_FALSE(evaluated);
+  EXPECT_TRUE(messages.empty());
+}
+
+}  // namespace rst
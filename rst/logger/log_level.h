@@ -0,0 +1,60 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_LOGGER_LOG_LEVEL_H_
+#define RST_LOGGER_LOG_LEVEL_H_
+
+#include <cstdint>
+
+// The lowest level the RST_LOG_* and RST_BLOG_* macros are compiled for, as
+// the numeric value of LogLevel. Calls of the lower levels generate no code
+// and don't evaluate their arguments. Set with the RST_MIN_LOG_LEVEL CMake
+// option, fatal messages are never stripped.
+#ifndef RST_MIN_LOG_LEVEL
+#define RST_MIN_LOG_LEVEL 0
+#endif
+
+namespace rst {
+
+// Severity levels of logging.
+enum class LogLevel : int8_t {
+  kAll = 0,
+  kDebug,
+  kInfo,
+  kWarning,
+  kError,
+  kFatal,
+  kOff,
+};
+
+// Returns the name used in the log prefix, e.g. "INFO". |level| must be
+// between kDebug and kFatal.
+const char* LogLevelToString(LogLevel level);
+
+}  // namespace rst
+
+#endif  // RST_LOGGER_LOG_LEVEL_H_
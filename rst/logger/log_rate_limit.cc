@@ -0,0 +1,86 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/log_rate_limit.h"
+
+namespace chrono = std::chrono;
+
+namespace rst {
+namespace internal {
+namespace {
+
+// A per-thread xorshift generator, so sampling doesn't share any state
+// between threads.
+uint64_t NextRandom() {
+  thread_local uint64_t state = 0;
+  if (state == 0) {
+    state = static_cast<uint64_t>(
+                chrono::steady_clock::now().time_since_epoch().count()) ^
+            reinterpret_cast<uintptr_t>(&state);
+    state |= 1;
+  }
+
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+}  // namespace
+
+bool LogEveryTState::ShouldLog(const chrono::nanoseconds period,
+                               const NotNull<uint64_t*> suppressed) {
+  const auto now = chrono::duration_cast<chrono::nanoseconds>(
+                       chrono::steady_clock::now().time_since_epoch())
+                       .count();
+  auto next_time = next_time_.load(std::memory_order_relaxed);
+  if (now < next_time || !next_time_.compare_exchange_strong(
+                             next_time, now + period.count(),
+                             std::memory_order_relaxed)) {
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  *suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+  return true;
+}
+
+bool LogSampledState::ShouldLog(const double probability,
+                                const NotNull<uint64_t*> suppressed) {
+  // 53 random bits give a uniform double in [0, 1).
+  static constexpr auto kScale = 1.0 / static_cast<double>(1ULL << 53);
+  if (static_cast<double>(NextRandom() >> 11) * kScale >= probability) {
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  *suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+  return true;
+}
+
+}  // namespace internal
+}  // namespace rst
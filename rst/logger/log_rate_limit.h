@@ -0,0 +1,120 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_LOGGER_LOG_RATE_LIMIT_H_
+#define RST_LOGGER_LOG_RATE_LIMIT_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "rst/macros/macros.h"
+#include "rst/not_null/not_null.h"
+
+namespace rst {
+namespace internal {
+
+// Per call site states of the RST_LOG_EVERY_N, RST_LOG_FIRST_N,
+// RST_LOG_EVERY_T and RST_LOG_SAMPLED macros. They are constant initialized
+// statics, so a suppressed RST_LOG_EVERY_N or RST_LOG_FIRST_N call costs a
+// single atomic operation. A suppressed RST_LOG_EVERY_T call also reads the
+// steady clock and RST_LOG_SAMPLED draws a per-thread random number.
+// ShouldLog() returns true if the message should be logged and sets
+// |suppressed| to the number of the messages skipped since the previous one.
+
+class LogEveryNState {
+ public:
+  constexpr LogEveryNState() = default;
+
+  // |n| of 0 is treated as 1.
+  bool ShouldLog(uint64_t n, const NotNull<uint64_t*> suppressed) {
+    if (n == 0)
+      n = 1;
+
+    const auto count = count_.fetch_add(1, std::memory_order_relaxed);
+    if (count % n != 0)
+      return false;
+
+    *suppressed = count == 0 ? 0 : n - 1;
+    return true;
+  }
+
+ private:
+  std::atomic<uint64_t> count_{0};
+
+  RST_DISALLOW_COPY_AND_ASSIGN(LogEveryNState);
+};
+
+class LogFirstNState {
+ public:
+  constexpr LogFirstNState() = default;
+
+  bool ShouldLog(const uint64_t n, NotNull<uint64_t*>) {
+    // Doesn't touch the cache line exclusively once the limit is reached.
+    if (count_.load(std::memory_order_relaxed) >= n)
+      return false;
+    return count_.fetch_add(1, std::memory_order_relaxed) < n;
+  }
+
+ private:
+  std::atomic<uint64_t> count_{0};
+
+  RST_DISALLOW_COPY_AND_ASSIGN(LogFirstNState);
+};
+
+class LogEveryTState {
+ public:
+  constexpr LogEveryTState() = default;
+
+  bool ShouldLog(std::chrono::nanoseconds period,
+                 NotNull<uint64_t*> suppressed);
+
+ private:
+  // The steady clock time in nanoseconds the next message can be logged at.
+  std::atomic<int64_t> next_time_{0};
+  std::atomic<uint64_t> suppressed_{0};
+
+  RST_DISALLOW_COPY_AND_ASSIGN(LogEveryTState);
+};
+
+class LogSampledState {
+ public:
+  constexpr LogSampledState() = default;
+
+  // Logs with |probability| from 0 to 1.
+  bool ShouldLog(double probability, NotNull<uint64_t*> suppressed);
+
+ private:
+  std::atomic<uint64_t> suppressed_{0};
+
+  RST_DISALLOW_COPY_AND_ASSIGN(LogSampledState);
+};
+
+}  // namespace internal
+}  // namespace rst
+
+#endif  // RST_LOGGER_LOG_RATE_LIMIT_H_
@@ -24,69 +24,349 @@
 // THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-
 #include "rst/logger/logger.h"
 
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <thread>
 
 #include "rst/logger/log_error.h"
+#include "rst/macros/os.h"
 #include "rst/strings/format.h"
 
+#if RST_BUILDFLAG(OS_LINUX)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace chrono = std::chrono;
+
 namespace rst {
+namespace internal {
+
+std::atomic<LogLevel> g_log_level{LogLevel::kAll};
+
+}  // namespace internal
+
 namespace {
 
 Logger* g_logger = nullptr;
 
-}  // namespace
+// The per-thread buffer the whole line is built in. A sink that logs from its
+// Log() gets a fresh buffer instead of overwriting the one in use.
+class LineBuffer {
+ public:
+  LineBuffer() {
+    if (!GetThreadState().is_in_use) {
+      GetThreadState().is_in_use = true;
+      line_ = &GetThreadState().buffer;
+      line_->clear();
+    }
+  }
 
-// static
-void Logger::Log(const Level level, const NotNull<const char*> filename,
-                 const int line, const std::string_view message) {
-  RST_DCHECK(g_logger != nullptr);
-  RST_DCHECK(line > 0);
+  ~LineBuffer() {
+    if (line_.get() == &GetThreadState().buffer)
+      GetThreadState().is_in_use = false;
+  }
 
-  if (static_cast<int>(level) < static_cast<int>(g_logger->level_))
-    return;
+  NotNull<std::string*> get() { return line_; }
 
-  const char* level_str = nullptr;
-  switch (level) {
-    case Level::kDebug: {
-      level_str = "DEBUG";
-      break;
-    }
-    case Level::kInfo: {
-      level_str = "INFO";
-      break;
-    }
-    case Level::kWarning: {
-      level_str = "WARNING";
+ private:
+  struct ThreadState {
+    std::string buffer;
+    bool is_in_use = false;
+  };
+
+  static ThreadState& GetThreadState() {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+    thread_local ThreadState state;
+#pragma clang diagnostic pop
+    return state;
+  }
+
+  std::string fallback_;
+  NotNull<std::string*> line_ = &fallback_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(LineBuffer);
+};
+
+// Writes |value| as exactly |width| digits with leading zeros.
+void AppendDigits(const NotNull<std::string*> line, uint64_t value,
+                  const size_t width) {
+  char digits[20];
+  RST_DCHECK(width <= std::size(digits));
+  for (auto i = width; i > 0; i--) {
+    digits[i - 1] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+  line->append(digits, width);
+}
+
+void AppendWallClockTime(const NotNull<std::string*> line) {
+  // The date and time are formatted once a second per thread.
+  struct Cache {
+    int64_t second = -1;
+    char text[32] = {};
+    size_t size = 0;
+  };
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+  thread_local Cache cache;
+#pragma clang diagnostic pop
+
+  const auto now = chrono::duration_cast<chrono::microseconds>(
+                       chrono::system_clock::now().time_since_epoch())
+                       .count();
+  auto second = now / 1000000;
+  auto microsecond = now % 1000000;
+  if (microsecond < 0) {
+    second--;
+    microsecond += 1000000;
+  }
+
+  if (cache.second != second) {
+    const auto time = static_cast<std::time_t>(second);
+    std::tm tm = {};
+#if RST_BUILDFLAG(OS_WIN)
+    (void)::localtime_s(&tm, &time);
+#else
+    (void)::localtime_r(&time, &tm);
+#endif
+    cache.size = std::strftime(cache.text, std::size(cache.text),
+                               "%Y-%m-%d %H:%M:%S", &tm);
+    cache.second = second;
+  }
+
+  line->append(cache.text, cache.size);
+  line->push_back('.');
+  AppendDigits(line, static_cast<uint64_t>(microsecond), 6);
+}
+
+void AppendMonotonicTime(const NotNull<std::string*> line) {
+  const auto now = static_cast<uint64_t>(
+      chrono::duration_cast<chrono::microseconds>(
+          chrono::steady_clock::now().time_since_epoch())
+          .count());
+  const internal::Arg second(now / 1000000);
+  line->append(second.view());
+  line->push_back('.');
+  AppendDigits(line, now % 1000000, 6);
+}
+
+uint64_t GetThreadId() {
+#if RST_BUILDFLAG(OS_LINUX)
+  return static_cast<uint64_t>(::syscall(SYS_gettid));
+#else
+  return std::hash<std::thread::id>()(std::this_thread::get_id());
+#endif
+}
+
+void AppendPrefix(const NotNull<std::string*> line,
+                  const Logger::Timestamp timestamp, const bool log_thread_id,
+                  const LogLevel level, const NotNull<const char*> filename,
+                  const int line_number) {
+  line->push_back('[');
+
+  switch (timestamp) {
+    case Logger::Timestamp::kNone: {
       break;
     }
-    case Level::kError: {
-      level_str = "ERROR";
+    case Logger::Timestamp::kWallClock: {
+      AppendWallClockTime(line);
+      line->push_back(' ');
       break;
     }
-    case Level::kFatal: {
-      level_str = "FATAL";
+    case Logger::Timestamp::kMonotonic: {
+      AppendMonotonicTime(line);
+      line->push_back(' ');
       break;
     }
-    case Level::kAll:
-    case Level::kOff: {
-      RST_DCHECK(false && "Unexpected level");
-    }
   }
-  RST_DCHECK(level_str != nullptr);
 
-  g_logger->sink_->Log(
-      Format("[{}:{}({})] {}", {level_str, filename, line, message}));
+  if (log_thread_id) {
+    thread_local const auto thread_id = GetThreadId();
+    const internal::Arg id(thread_id);
+    line->append(id.view());
+    line->push_back(' ');
+  }
 
-  if (level == Level::kFatal)
-    std::abort();
+  const internal::Arg values[] = {LogLevelToString(level), filename, line_number};
+  static constexpr char kPrefixFormat[] = "{}:{}({})] ";
+  FormatAndAppend(line, kPrefixFormat, std::size(kPrefixFormat) - 1, values,
+                  std::size(values));
+}
+
+void AppendSuppressed(const NotNull<std::string*> line,
+                      const uint64_t suppressed) {
+  if (suppressed == 0)
+    return;
+
+  const internal::Arg values[] = {suppressed};
+  static constexpr char kSuppressedFormat[] = " ({} suppressed)";
+  FormatAndAppend(line, kSuppressedFormat, std::size(kSuppressedFormat) - 1,
+                  values, std::size(values));
+}
+
+// Appends " key=value" for every field.
+void AppendFields(const NotNull<std::string*> line,
+                  const Nullable<const LogField*> fields,
+                  const size_t field_count) {
+  if (fields == nullptr)
+    return;
+
+  for (size_t i = 0; i < field_count; i++) {
+    line->push_back(' ');
+    line->append(fields[i].key);
+    line->push_back('=');
+    internal::AppendLogValue(line, fields[i].value);
+  }
+}
+
+}  // namespace
+
+// static
+void Logger::LogSuppressed(const Level level,
+                           const NotNull<const char*> filename, const int line,
+                           const uint64_t suppressed,
+                           const std::string_view message) {
+  if (!IsEnabled(level))
+    return;
+
+  LogMessage(level, filename, line, suppressed, nullptr, 0, message);
+}
+
+// static
+void Logger::LogVerbose(const NotNull<const char*> filename, const int line,
+                        const std::string_view message) {
+  LogMessage(Level::kDebug, filename, line, 0, nullptr, 0, message);
+}
+
+// static
+void Logger::LogMessage(const Level level, const NotNull<const char*> filename,
+                        const int line, const uint64_t suppressed,
+                        const Nullable<const LogField*> fields,
+                        const size_t field_count,
+                        const std::string_view message) {
+  RST_DCHECK(g_logger != nullptr);
+  RST_DCHECK(line > 0);
+
+  LineBuffer buffer;
+  AppendPrefix(buffer.get(), g_logger->timestamp_, g_logger->log_thread_id_,
+               level, filename, line);
+  const auto text_start = buffer.get()->size();
+  buffer.get()->append(message);
+  g_logger->Emit(level, filename, line, suppressed, fields, field_count,
+                 text_start, buffer.get());
+}
+
+// static
+void Logger::LogFormatted(const Level level,
+                          const NotNull<const char*> filename, const int line,
+                          const uint64_t suppressed,
+                          const Nullable<const LogField*> fields,
+                          const size_t field_count,
+                          const NotNull<const char*> format,
+                          const size_t format_size,
+                          const NotNull<const internal::Arg*> values,
+                          const size_t size) {
+  RST_DCHECK(g_logger != nullptr);
+  RST_DCHECK(line > 0);
+
+  LineBuffer buffer;
+  AppendPrefix(buffer.get(), g_logger->timestamp_, g_logger->log_thread_id_,
+               level, filename, line);
+  const auto text_start = buffer.get()->size();
+  internal::FormatAndAppend(buffer.get(), format, format_size, values.get(),
+                            size);
+  g_logger->Emit(level, filename, line, suppressed, fields, field_count,
+                 text_start, buffer.get());
+}
+
+// static
+bool Logger::EmergencyLog(const std::string_view message) {
+  if (g_logger == nullptr)
+    return false;
+
+  g_logger->sink_->EmergencyLog(message);
+  return true;
+}
+
+// static
+void Logger::EmergencyFlush() {
+  if (g_logger != nullptr)
+    g_logger->sink_->EmergencyFlush();
 }
 
 // static
 void Logger::SetGlobalLogger(const NotNull<Logger*> logger) {
   g_logger = logger.get();
+  internal::g_log_level.store(g_logger->level_, std::memory_order_relaxed);
+}
+
+void Logger::set_level(const Level level) {
+  level_ = level;
+  if (g_logger == this)
+    internal::g_log_level.store(level_, std::memory_order_relaxed);
+}
+
+void Logger::Emit(const Level level, const NotNull<const char*> filename,
+                  const int line_number, const uint64_t suppressed,
+                  const Nullable<const LogField*> fields,
+                  const size_t field_count, const size_t text_start,
+                  const NotNull<std::string*> line) {
+  const auto text_size = line->size() - text_start;
+  AppendSuppressed(line, suppressed);
+
+  const auto emit = [&](const Nullable<const LogField*> all_fields,
+                        const size_t all_field_count) {
+    AppendFields(line, all_fields, all_field_count);
+
+    LogRecord record;
+    record.level = level;
+    record.message = *line;
+    record.filename = filename;
+    record.line = line_number;
+    record.text = std::string_view(*line).substr(text_start, text_size);
+    record.fields = all_fields;
+    record.field_count = all_field_count;
+
+    if (level == Level::kFatal) {
+      sink_->EmitAndFlush(record);
+      std::abort();
+    }
+
+    sink_->Emit(record);
+  };
+
+  size_t scope_field_count = 0;
+  LogScope::ForEachField([&scope_field_count](const LogField&) {
+    scope_field_count++;
+  });
+  if (scope_field_count == 0) {
+    emit(fields, field_count);
+    return;
+  }
+
+  // The scoped fields go first, the ones that don't fit are dropped.
+  LogField all_fields[kMaxFieldNumber];
+  size_t all_field_count = 0;
+  LogScope::ForEachField([&all_fields, &all_field_count](const LogField& f) {
+    if (all_field_count < std::size(all_fields))
+      all_fields[all_field_count++] = f;
+  });
+  if (fields != nullptr) {
+    for (size_t i = 0;
+         i < field_count && all_field_count < std::size(all_fields); i++) {
+      all_fields[all_field_count++] = fields[i];
+    }
+  }
+  emit(all_fields, all_field_count);
 }
 
 }  // namespace rst
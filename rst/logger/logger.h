@@ -28,15 +28,26 @@
 #ifndef RST_LOGGER_LOGGER_H_
 #define RST_LOGGER_LOGGER_H_
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <string_view>
+#include <type_traits>
 #include <utility>
 
 #include "rst/check/check.h"
+#include "rst/logger/log_field.h"
+#include "rst/logger/log_level.h"
+#include "rst/logger/log_rate_limit.h"
 #include "rst/logger/sink.h"
+#include "rst/logger/vlog.h"
 #include "rst/macros/macros.h"
 #include "rst/not_null/not_null.h"
+#include "rst/strings/arg.h"
+#include "rst/strings/format.h"
 
 // General logger component.
 //
@@ -50,73 +61,386 @@
 //   Logger::SetGlobalLogger(&logger);
 //
 //   RST_LOG_INFO("Init subsystem A");
+//   RST_LOG_INFO("Init subsystem {} in {} ms", name, time);
 //   RST_DLOG_WARNING("Init subsystem A.B");  // Logs only in a debug build.
+//
+// A single argument is logged as is. With more arguments the first one is a
+// Format() string, its placeholders are checked against the arguments at
+// compile time. The arguments are evaluated and formatted only if the level is
+// enabled.
+//
+// Rate limited variants take the severity name and keep their state per call
+// site. The logged message ends with the number of the suppressed ones:
+//
+//   RST_LOG_EVERY_N(WARNING, 100, "Retrying {}", id);  // 1st, 101st, ...
+//   RST_LOG_FIRST_N(INFO, 10, "Connected");            // First 10 only.
+//   RST_LOG_EVERY_T(ERROR, std::chrono::seconds(1), "Queue is full");
+//   RST_LOG_SAMPLED(DEBUG, 0.01, "Packet {}", seq);    // About 1 in 100.
+//
+// Fields are attached to the messages with RST_LOG_SCOPE and RST_LOG_FIELDS,
+// see log_field.h:
+//
+//   RST_LOG_FIELDS(INFO, LogFields("user", name), "Logged in");
+//
+// Verbose messages are enabled per file with SetVlogLevel() and SetVModule()
+// regardless of the logger level and are logged as DEBUG:
+//
+//   SetVModule("task_runner*=2").Ignore();
+//   RST_VLOG(2, "Posted task {}", id);
+
+// Helper macros for logging with the specified level. The levels below
+// RST_MIN_LOG_LEVEL generate no code.
+#if RST_MIN_LOG_LEVEL <= 1
+#define RST_LOG_DEBUG(...) \
+  RST_LOG_INTERNAL(::rst::LogLevel::kDebug, __VA_ARGS__)
+#define RST_LOG_RATE_LIMITED_INTERNAL_DEBUG(...) \
+  RST_LOG_RATE_LIMITED_INTERNAL(::rst::LogLevel::kDebug, __VA_ARGS__)
+#define RST_LOG_FIELDS_INTERNAL_DEBUG(...) \
+  RST_LOG_FIELDS_INTERNAL(::rst::LogLevel::kDebug, __VA_ARGS__)
+#else
+#define RST_LOG_DEBUG(...) \
+  RST_LOG_STRIPPED_INTERNAL(::rst::LogLevel::kDebug, __VA_ARGS__)
+#define RST_LOG_RATE_LIMITED_INTERNAL_DEBUG(State, param, ...) \
+  RST_LOG_STRIPPED_INTERNAL(::rst::LogLevel::kDebug, __VA_ARGS__)
+#define RST_LOG_FIELDS_INTERNAL_DEBUG(...) \
+  RST_LOG_FIELDS_STRIPPED_INTERNAL(::rst::LogLevel::kDebug, __VA_ARGS__)
+#endif
+
+#if RST_MIN_LOG_LEVEL <= 2
+#define RST_LOG_INFO(...) RST_LOG_INTERNAL(::rst::LogLevel::kInfo, __VA_ARGS__)
+#define RST_LOG_RATE_LIMITED_INTERNAL_INFO(...) \
+  RST_LOG_RATE_LIMITED_INTERNAL(::rst::LogLevel::kInfo, __VA_ARGS__)
+#define RST_LOG_FIELDS_INTERNAL_INFO(...) \
+  RST_LOG_FIELDS_INTERNAL(::rst::LogLevel::kInfo, __VA_ARGS__)
+#else
+#define RST_LOG_INFO(...) \
+  RST_LOG_STRIPPED_INTERNAL(::rst::LogLevel::kInfo, __VA_ARGS__)
+#define RST_LOG_RATE_LIMITED_INTERNAL_INFO(State, param, ...) \
+  RST_LOG_STRIPPED_INTERNAL(::rst::LogLevel::kInfo, __VA_ARGS__)
+#define RST_LOG_FIELDS_INTERNAL_INFO(...) \
+  RST_LOG_FIELDS_STRIPPED_INTERNAL(::rst::LogLevel::kInfo, __VA_ARGS__)
+#endif
+
+#if RST_MIN_LOG_LEVEL <= 3
+#define RST_LOG_WARNING(...) \
+  RST_LOG_INTERNAL(::rst::LogLevel::kWarning, __VA_ARGS__)
+#define RST_LOG_RATE_LIMITED_INTERNAL_WARNING(...) \
+  RST_LOG_RATE_LIMITED_INTERNAL(::rst::LogLevel::kWarning, __VA_ARGS__)
+#define RST_LOG_FIELDS_INTERNAL_WARNING(...) \
+  RST_LOG_FIELDS_INTERNAL(::rst::LogLevel::kWarning, __VA_ARGS__)
+#else
+#define RST_LOG_WARNING(...) \
+  RST_LOG_STRIPPED_INTERNAL(::rst::LogLevel::kWarning, __VA_ARGS__)
+#define RST_LOG_RATE_LIMITED_INTERNAL_WARNING(State, param, ...) \
+  RST_LOG_STRIPPED_INTERNAL(::rst::LogLevel::kWarning, __VA_ARGS__)
+#define RST_LOG_FIELDS_INTERNAL_WARNING(...) \
+  RST_LOG_FIELDS_STRIPPED_INTERNAL(::rst::LogLevel::kWarning, __VA_ARGS__)
+#endif
+
+#if RST_MIN_LOG_LEVEL <= 4
+#define RST_LOG_ERROR(...) \
+  RST_LOG_INTERNAL(::rst::LogLevel::kError, __VA_ARGS__)
+#define RST_LOG_RATE_LIMITED_INTERNAL_ERROR(...) \
+  RST_LOG_RATE_LIMITED_INTERNAL(::rst::LogLevel::kError, __VA_ARGS__)
+#define RST_LOG_FIELDS_INTERNAL_ERROR(...) \
+  RST_LOG_FIELDS_INTERNAL(::rst::LogLevel::kError, __VA_ARGS__)
+#else
+#define RST_LOG_ERROR(...) \
+  RST_LOG_STRIPPED_INTERNAL(::rst::LogLevel::kError, __VA_ARGS__)
+#define RST_LOG_RATE_LIMITED_INTERNAL_ERROR(State, param, ...) \
+  RST_LOG_STRIPPED_INTERNAL(::rst::LogLevel::kError, __VA_ARGS__)
+#define RST_LOG_FIELDS_INTERNAL_ERROR(...) \
+  RST_LOG_FIELDS_STRIPPED_INTERNAL(::rst::LogLevel::kError, __VA_ARGS__)
+#endif
+
+#if RST_MIN_LOG_LEVEL <= 1
+#define RST_VLOG(verbose_level, ...)                                    \
+  do {                                                                  \
+    RST_LOG_CHECK_FORMAT_INTERNAL(__VA_ARGS__);                         \
+    static ::rst::internal::VlogSite rst_vlog_site(__FILE__);           \
+    if (rst_vlog_site.IsOn(verbose_level))                              \
+      ::rst::Logger::LogVerbose(__FILE__, __LINE__, __VA_ARGS__);       \
+  } while (false)
+#else
+#define RST_VLOG(verbose_level, ...) \
+  RST_LOG_STRIPPED_INTERNAL(::rst::LogLevel::kDebug, __VA_ARGS__)
+#endif
+
+#define RST_LOG_FATAL(...) \
+  RST_LOG_INTERNAL(::rst::LogLevel::kFatal, __VA_ARGS__)
+#define RST_LOG_RATE_LIMITED_INTERNAL_FATAL(...) \
+  RST_LOG_RATE_LIMITED_INTERNAL(::rst::LogLevel::kFatal, __VA_ARGS__)
+#define RST_LOG_FIELDS_INTERNAL_FATAL(...) \
+  RST_LOG_FIELDS_INTERNAL(::rst::LogLevel::kFatal, __VA_ARGS__)
+
+#define RST_LOG_INTERNAL(level, ...)                               \
+  do {                                                             \
+    RST_LOG_CHECK_FORMAT_INTERNAL(__VA_ARGS__);                    \
+    if (::rst::Logger::IsEnabled(level))                           \
+      ::rst::Logger::Log(level, __FILE__, __LINE__, __VA_ARGS__);  \
+  } while (false)
 
-// Helper macros for logging with the specified level.
-#define RST_LOG_DEBUG(message) \
-  ::rst::Logger::Log(::rst::Logger::Level::kDebug, __FILE__, __LINE__, message)
+// Keeps the arguments used for the compiler but generates no code and doesn't
+// evaluate them.
+#define RST_LOG_STRIPPED_INTERNAL(level, ...)                      \
+  do {                                                             \
+    RST_LOG_CHECK_FORMAT_INTERNAL(__VA_ARGS__);                    \
+    if (false)                                                     \
+      ::rst::Logger::Log(level, __FILE__, __LINE__, __VA_ARGS__);  \
+  } while (false)
 
-#define RST_LOG_INFO(message) \
-  ::rst::Logger::Log(::rst::Logger::Level::kInfo, __FILE__, __LINE__, message)
+#define RST_LOG_FIELDS(severity, fields, ...) \
+  RST_LOG_FIELDS_INTERNAL_##severity(fields, __VA_ARGS__)
 
-#define RST_LOG_WARNING(message)                                         \
-  ::rst::Logger::Log(::rst::Logger::Level::kWarning, __FILE__, __LINE__, \
-                     message)
+#define RST_LOG_FIELDS_INTERNAL(level, fields, ...)                       \
+  do {                                                                    \
+    RST_LOG_CHECK_FORMAT_INTERNAL(__VA_ARGS__);                           \
+    if (::rst::Logger::IsEnabled(level)) {                                \
+      ::rst::Logger::LogWithFields(level, __FILE__, __LINE__, fields,     \
+                                   __VA_ARGS__);                          \
+    }                                                                     \
+  } while (false)
 
-#define RST_LOG_ERROR(message) \
-  ::rst::Logger::Log(::rst::Logger::Level::kError, __FILE__, __LINE__, message)
+#define RST_LOG_FIELDS_STRIPPED_INTERNAL(level, fields, ...)              \
+  do {                                                                    \
+    RST_LOG_CHECK_FORMAT_INTERNAL(__VA_ARGS__);                           \
+    if (false) {                                                          \
+      ::rst::Logger::LogWithFields(level, __FILE__, __LINE__, fields,     \
+                                   __VA_ARGS__);                          \
+    }                                                                     \
+  } while (false)
 
-#define RST_LOG_FATAL(message) \
-  ::rst::Logger::Log(::rst::Logger::Level::kFatal, __FILE__, __LINE__, message)
+#define RST_LOG_EVERY_N(severity, n, ...)                                   \
+  RST_LOG_RATE_LIMITED_INTERNAL_##severity(::rst::internal::LogEveryNState, \
+                                           (n), __VA_ARGS__)
+#define RST_LOG_FIRST_N(severity, n, ...)                                   \
+  RST_LOG_RATE_LIMITED_INTERNAL_##severity(::rst::internal::LogFirstNState, \
+                                           (n), __VA_ARGS__)
+#define RST_LOG_EVERY_T(severity, period, ...)                              \
+  RST_LOG_RATE_LIMITED_INTERNAL_##severity(::rst::internal::LogEveryTState, \
+                                           (period), __VA_ARGS__)
+#define RST_LOG_SAMPLED(severity, probability, ...) \
+  RST_LOG_RATE_LIMITED_INTERNAL_##severity(         \
+      ::rst::internal::LogSampledState, (probability), __VA_ARGS__)
+
+#define RST_LOG_RATE_LIMITED_INTERNAL(level, State, param, ...)            \
+  do {                                                                     \
+    RST_LOG_CHECK_FORMAT_INTERNAL(__VA_ARGS__);                            \
+    static State rst_log_state;                                            \
+    uint64_t rst_log_suppressed = 0;                                       \
+    if (::rst::Logger::IsEnabled(level) &&                                 \
+        rst_log_state.ShouldLog(param, &rst_log_suppressed)) {             \
+      ::rst::Logger::LogSuppressed(level, __FILE__, __LINE__,              \
+                                   rst_log_suppressed, __VA_ARGS__);       \
+    }                                                                      \
+  } while (false)
+
+// A format string with more placeholders than arguments makes the formatting
+// read past them, so it's checked at compile time. A single argument is a
+// message logged as is and isn't checked. The extra argument keeps the
+// variadic part of RST_LOG_FORMAT_INTERNAL non-empty.
+#define RST_LOG_CHECK_FORMAT_INTERNAL(...)                                \
+  static_assert(                                                          \
+      RST_LOG_ARG_COUNT_INTERNAL(__VA_ARGS__) == 0 ||                     \
+          ::rst::internal::CountFormat(                                   \
+              RST_LOG_FORMAT_INTERNAL(__VA_ARGS__, 0))                    \
+              .is_valid,                                                  \
+      "Invalid format string");                                           \
+  static_assert(                                                          \
+      RST_LOG_ARG_COUNT_INTERNAL(__VA_ARGS__) == 0 ||                     \
+          ::rst::internal::CountFormat(                                   \
+              RST_LOG_FORMAT_INTERNAL(__VA_ARGS__, 0))                    \
+                  .placeholder_count ==                                   \
+              RST_LOG_ARG_COUNT_INTERNAL(__VA_ARGS__),                    \
+      "Numbers of placeholders and arguments should match")
+
+#define RST_LOG_ARG_COUNT_INTERNAL(...) \
+  decltype(::rst::internal::CountLogArgs(__VA_ARGS__))::value
+
+#define RST_LOG_FORMAT_INTERNAL(format, ...) format
 
 // Like RST_LOG_* macros but compiles to nothing in release build.
 #if RST_BUILDFLAG(DCHECK_IS_ON)
-#define RST_DLOG_DEBUG(message) RST_LOG_DEBUG(message)
-#define RST_DLOG_INFO(message) RST_LOG_INFO(message)
-#define RST_DLOG_WARNING(message) RST_LOG_WARNING(message)
-#define RST_DLOG_ERROR(message) RST_LOG_ERROR(message)
-#define RST_DLOG_FATAL(message) RST_LOG_FATAL(message)
+#define RST_DLOG_DEBUG(...) RST_LOG_DEBUG(__VA_ARGS__)
+#define RST_DLOG_INFO(...) RST_LOG_INFO(__VA_ARGS__)
+#define RST_DLOG_WARNING(...) RST_LOG_WARNING(__VA_ARGS__)
+#define RST_DLOG_ERROR(...) RST_LOG_ERROR(__VA_ARGS__)
+#define RST_DLOG_FATAL(...) RST_LOG_FATAL(__VA_ARGS__)
 #else
-#define RST_DLOG_DEBUG(message)
-#define RST_DLOG_INFO(message)
-#define RST_DLOG_WARNING(message)
-#define RST_DLOG_ERROR(message)
-#define RST_DLOG_FATAL(message)
+#define RST_DLOG_DEBUG(...)
+#define RST_DLOG_INFO(...)
+#define RST_DLOG_WARNING(...)
+#define RST_DLOG_ERROR(...)
+#define RST_DLOG_FATAL(...)
 #endif
 
 namespace rst {
+namespace internal {
+
+// The level of the global logger.
+extern std::atomic<LogLevel> g_log_level;
+
+// Only used in decltype() to count the arguments after the message or the
+// format string.
+template <class Message, class... Args>
+std::integral_constant<size_t, sizeof...(Args)> CountLogArgs(
+    const Message& message, const Args&... args);
+
+}  // namespace internal
 
 // The class for logging to a custom sink.
 class Logger {
  public:
-  // Severity levels of logging.
-  enum class Level : int8_t {
-    kAll = 0,
-    kDebug,
-    kInfo,
-    kWarning,
-    kError,
-    kFatal,
-    kOff,
+  using Level = LogLevel;
+
+  // The clock of the optional timestamp in the message prefix.
+  enum class Timestamp {
+    kNone,
+    // Local date and time: "2020-01-31 23:59:59.123456".
+    kWallClock,
+    // Seconds since an unspecified point: "12345.123456".
+    kMonotonic,
   };
 
   explicit Logger(NotNull<std::unique_ptr<Sink>> sink)
       : sink_(std::move(sink)) {}
   ~Logger() = default;
 
+  // Returns true if messages of |level| pass the global logger level. Costs
+  // one relaxed atomic load. RST_MIN_LOG_LEVEL is applied only by the macros,
+  // so the inline functions are the same in every translation unit.
+  static bool IsEnabled(const Level level) {
+    return static_cast<int>(level) >=
+           static_cast<int>(
+               internal::g_log_level.load(std::memory_order_relaxed));
+  }
+
   // Logs a |message|. If the |level| is less than |level_| nothing gets logged.
-  static void Log(Level level, NotNull<const char*> filename, int line,
-                  std::string_view message);
+  static void Log(const Level level, const NotNull<const char*> filename,
+                  const int line, const std::string_view message) {
+    LogSuppressed(level, filename, line, 0, message);
+  }
+
+  // Formats the message with Format() rules and logs it. The prefix and the
+  // message are written to a reused per-thread buffer.
+  template <size_t N, class Arg, class... Args>
+  static void Log(const Level level, const NotNull<const char*> filename,
+                  const int line, const char (&format)[N], const Arg& arg,
+                  const Args&... args) {
+    if (!IsEnabled(level))
+      return;
+
+    const internal::Arg values[] = {arg, args...};
+    LogFormatted(level, filename, line, 0, nullptr, 0, format, N - 1, values,
+                 1 + sizeof...(Args));
+  }
+
+  // Like Log() but reports the number of the |suppressed| messages if it's
+  // not zero.
+  static void LogSuppressed(Level level, NotNull<const char*> filename,
+                            int line, uint64_t suppressed,
+                            std::string_view message);
+  template <size_t N, class Arg, class... Args>
+  static void LogSuppressed(const Level level,
+                            const NotNull<const char*> filename,
+                            const int line, const uint64_t suppressed,
+                            const char (&format)[N], const Arg& arg,
+                            const Args&... args) {
+    if (!IsEnabled(level))
+      return;
+
+    const internal::Arg values[] = {arg, args...};
+    LogFormatted(level, filename, line, suppressed, nullptr, 0, format, N - 1,
+                 values, 1 + sizeof...(Args));
+  }
+
+  // Logs a verbose message as DEBUG without checking the logger level, the
+  // verbosity is checked by RST_VLOG.
+  static void LogVerbose(NotNull<const char*> filename, int line,
+                         std::string_view message);
+  template <size_t N, class Arg, class... Args>
+  static void LogVerbose(const NotNull<const char*> filename, const int line,
+                         const char (&format)[N], const Arg& arg,
+                         const Args&... args) {
+    const internal::Arg values[] = {arg, args...};
+    LogFormatted(Level::kDebug, filename, line, 0, nullptr, 0, format, N - 1,
+                 values, 1 + sizeof...(Args));
+  }
+
+  // Logs with the call |fields| made by LogFields(), see RST_LOG_FIELDS.
+  template <size_t M>
+  static void LogWithFields(const Level level,
+                            const NotNull<const char*> filename,
+                            const int line,
+                            const std::array<LogField, M>& fields,
+                            const std::string_view message) {
+    if (!IsEnabled(level))
+      return;
+
+    LogMessage(level, filename, line, 0, fields.data(), M, message);
+  }
+  template <size_t M, size_t N, class Arg, class... Args>
+  static void LogWithFields(const Level level,
+                            const NotNull<const char*> filename,
+                            const int line,
+                            const std::array<LogField, M>& fields,
+                            const char (&format)[N], const Arg& arg,
+                            const Args&... args) {
+    if (!IsEnabled(level))
+      return;
+
+    const internal::Arg values[] = {arg, args...};
+    LogFormatted(level, filename, line, 0, fields.data(), M, format, N - 1,
+                 values, 1 + sizeof...(Args));
+  }
+
+  // Passes |message| and then the buffered messages of the global logger sink
+  // to its EmergencyLog() and EmergencyFlush(), so it's async-signal-safe if
+  // the sink is. Returns false if there is no global logger.
+  static bool EmergencyLog(std::string_view message);
+  static void EmergencyFlush();
 
   // Sets |logger| as a global logger instance.
   static void SetGlobalLogger(NotNull<Logger*> logger);
 
-  void set_level(Level level) { level_ = level; }
+  void set_level(Level level);
+
+  // The prefix is "[LEVEL:file(line)] " by default, the timestamp and the
+  // thread ID are added before the level: "[time tid LEVEL:file(line)] ".
+  // Should be set before the logging starts.
+  void set_timestamp(const Timestamp timestamp) { timestamp_ = timestamp; }
+  void set_log_thread_id(const bool log_thread_id) {
+    log_thread_id_ = log_thread_id;
+  }
 
  private:
+  // The maximum number of the scoped and the call fields of a message, the
+  // rest are dropped.
+  static constexpr size_t kMaxFieldNumber = 32;
+
+  static void LogFormatted(Level level, NotNull<const char*> filename,
+                           int line, uint64_t suppressed,
+                           Nullable<const LogField*> fields,
+                           size_t field_count, NotNull<const char*> format,
+                           size_t format_size,
+                           NotNull<const internal::Arg*> values, size_t size);
+
+  static void LogMessage(Level level, NotNull<const char*> filename, int line,
+                         uint64_t suppressed, Nullable<const LogField*> fields,
+                         size_t field_count, std::string_view message);
+
+  // Appends the suppressed count and the fields to the |line| that has the
+  // message text from |text_start| and passes it to the sink, aborts on
+  // kFatal.
+  void Emit(Level level, NotNull<const char*> filename, int line_number,
+            uint64_t suppressed, Nullable<const LogField*> fields,
+            size_t field_count, size_t text_start, NotNull<std::string*> line);
+
   const NotNull<std::unique_ptr<Sink>> sink_;
   // Current severity level.
   Level level_ = Level::kAll;
+  Timestamp timestamp_ = Timestamp::kNone;
+  bool log_thread_id_ = false;
 
   RST_DISALLOW_COPY_AND_ASSIGN(Logger);
 };
@@ -0,0 +1,165 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "rst/check/check.h"
+#include "rst/logger/file_name_sink.h"
+#include "rst/logger/file_ptr_sink.h"
+#include "rst/logger/logger.h"
+#include "rst/macros/os.h"
+
+// Logger throughput and latency at 1, 4 and 16 threads. The range argument is
+// the message size. Besides items and bytes per second every benchmark
+// reports the per call latency percentiles averaged over the threads. Every
+// 8th call is timed, the numbers include the clock overhead of about 20 ns.
+
+namespace chrono = std::chrono;
+
+namespace rst {
+namespace {
+
+#if RST_BUILDFLAG(OS_LINUX)
+constexpr char kTmpfsFilename[] = "/dev/shm/rst_logger_benchmark.log";
+#else
+constexpr char kTmpfsFilename[] = "rst_logger_benchmark.log";
+#endif
+
+constexpr uint64_t kSamplingMask = 7;
+
+std::unique_ptr<Logger> g_logger;
+
+NotNull<std::unique_ptr<Sink>> CreateFilePtrSink() {
+  auto file = std::fopen("/dev/null", "w");
+  RST_CHECK(file != nullptr);
+  return std::make_unique<FilePtrSink>(file);
+}
+
+NotNull<std::unique_ptr<Sink>> CreateTmpfsSink() {
+  auto sink = FileNameSink::Create(kTmpfsFilename);
+  RST_CHECK(!sink.err());
+  return std::move(*sink);
+}
+
+double GetPercentile(const std::vector<int64_t>& sorted, const double p) {
+  if (sorted.empty())
+    return 0;
+  const auto index = static_cast<size_t>(p * static_cast<double>(
+                                                 sorted.size() - 1));
+  return static_cast<double>(sorted[index]);
+}
+
+// The logger is created and destroyed by the first thread. The other threads
+// wait for it at the start and the end of the benchmark loop.
+template <class CreateSink>
+void BM_Log(benchmark::State& state, const LogLevel level,
+            CreateSink create_sink) {
+  if (state.thread_index() == 0) {
+    g_logger = std::make_unique<Logger>(create_sink());
+    g_logger->set_level(level);
+    Logger::SetGlobalLogger(g_logger.get());
+  }
+
+  const std::string message(static_cast<size_t>(state.range(0)), 'x');
+  std::vector<int64_t> latencies;
+  latencies.reserve(1 << 20);
+  uint64_t count = 0;
+
+  for (auto _ : state) {
+    if ((count++ & kSamplingMask) != 0) {
+      RST_LOG_INFO(message);
+      continue;
+    }
+
+    const auto start = chrono::steady_clock::now();
+    RST_LOG_INFO(message);
+    const auto latency = chrono::steady_clock::now() - start;
+    if (latencies.size() < latencies.capacity()) {
+      latencies.emplace_back(
+          chrono::duration_cast<chrono::nanoseconds>(latency).count());
+    }
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  for (const auto& [name, p] : {std::pair("p50_ns", 0.5),
+                                std::pair("p99_ns", 0.99),
+                                std::pair("p999_ns", 0.999)}) {
+    state.counters[name] = benchmark::Counter(GetPercentile(latencies, p),
+                                              benchmark::Counter::kAvgThreads);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+
+  if (state.thread_index() == 0)
+    g_logger.reset();
+}
+
+void BM_DisabledLevel(benchmark::State& state) {
+  BM_Log(state, LogLevel::kWarning, &CreateFilePtrSink);
+}
+BENCHMARK(BM_DisabledLevel)
+    ->Arg(16)
+    ->Threads(1)
+    ->Threads(4)
+    ->Threads(16)
+    ->UseRealTime();
+
+void BM_FilePtrSinkDevNull(benchmark::State& state) {
+  BM_Log(state, LogLevel::kAll, &CreateFilePtrSink);
+}
+BENCHMARK(BM_FilePtrSinkDevNull)
+    ->RangeMultiplier(16)
+    ->Range(16, 4096)
+    ->Threads(1)
+    ->Threads(4)
+    ->Threads(16)
+    ->UseRealTime();
+
+void BM_FileNameSinkTmpfs(benchmark::State& state) {
+  BM_Log(state, LogLevel::kAll, &CreateTmpfsSink);
+  if (state.thread_index() == 0)
+    (void)std::remove(kTmpfsFilename);
+}
+BENCHMARK(BM_FileNameSinkTmpfs)
+    ->RangeMultiplier(16)
+    ->Range(16, 4096)
+    ->Threads(1)
+    ->Threads(4)
+    ->Threads(16)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace rst
@@ -0,0 +1,84 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Only the macros depend on RST_MIN_LOG_LEVEL, so redefining it here doesn't
+// change any inline function shared with the other tests.
+#undef RST_MIN_LOG_LEVEL
+#define RST_MIN_LOG_LEVEL 3
+#include "rst/logger/logger.h"
+#include "rst/logger/sink.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using testing::_;
+
+namespace rst {
+namespace {
+
+class SinkMock : public Sink {
+ public:
+  MOCK_METHOD1(Log, void(std::string_view message));
+};
+
+}  // namespace
+
+TEST(Logger, MinLogLevel) {
+  auto sink = std::make_unique<SinkMock>();
+
+  EXPECT_CALL(*sink, Log(_)).Times(4);
+
+  Logger logger(std::move(sink));
+  Logger::SetGlobalLogger(&logger);
+
+  auto evaluation_count = 0;
+  const auto evaluate = [&evaluation_count]() {
+    evaluation_count++;
+    return std::string("message");
+  };
+
+  RST_LOG_DEBUG(evaluate());
+  RST_LOG_INFO("{}", evaluate());
+  RST_LOG_EVERY_N(DEBUG, 1, evaluate());
+  RST_LOG_FIRST_N(INFO, 1, evaluate());
+  RST_LOG_EVERY_T(DEBUG, std::chrono::seconds(1), evaluate());
+  RST_LOG_SAMPLED(INFO, 1.0, evaluate());
+  EXPECT_EQ(evaluation_count, 0);
+
+  RST_LOG_WARNING(evaluate());
+  RST_LOG_ERROR("{}", evaluate());
+  RST_LOG_EVERY_N(WARNING, 1, evaluate());
+  RST_LOG_FIRST_N(ERROR, 1, evaluate());
+  EXPECT_EQ(evaluation_count, 4);
+}
+
+}  // namespace rst
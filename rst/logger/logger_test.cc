@@ -32,6 +32,7 @@
 #include "rst/logger/sink.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cstdarg>
 #include <cstddef>
 #include <cstdio>
@@ -222,6 +223,250 @@ TEST(Logger, DebugMacros) {
   EXPECT_DEATH(RST_DLOG_FATAL(kMessage), "");
 }
 
+TEST(Logger, MacrosFormat) {
+  auto sink = std::make_unique<SinkMock>();
+
+  EXPECT_CALL(*sink, Log(Eq(std::string("[INFO:") + __FILE__ + "(" +
+                            std::to_string(__LINE__ + 6) + ")] x=1 y=str")));
+
+  Logger logger(std::move(sink));
+  Logger::SetGlobalLogger(&logger);
+
+  const std::string str = "str";
+  RST_LOG_INFO("x={} y={}", 1, str);
+}
+
+TEST(Logger, SingleArgumentIsNotFormat) {
+  auto sink = std::make_unique<SinkMock>();
+
+  EXPECT_CALL(*sink, Log(Eq(std::string("[") + kLevelStr + ":" + kFilename +
+                            "(" + kLineStr + ")] {}")));
+
+  Logger logger(std::move(sink));
+  Logger::SetGlobalLogger(&logger);
+
+  Logger::Log(Logger::Level::kDebug, kFilename, kLine, "{}");
+}
+
+TEST(Logger, MacrosDisabledLevelDoesNotEvaluate) {
+  auto sink = std::make_unique<SinkMock>();
+
+  EXPECT_CALL(*sink, Log(_)).Times(1);
+
+  Logger logger(std::move(sink));
+  Logger::SetGlobalLogger(&logger);
+  logger.set_level(Logger::Level::kInfo);
+
+  auto evaluation_count = 0;
+  const auto evaluate = [&evaluation_count]() {
+    evaluation_count++;
+    return std::string(kMessage);
+  };
+
+  RST_LOG_DEBUG(evaluate());
+  RST_LOG_DEBUG("{}", evaluate());
+  EXPECT_EQ(evaluation_count, 0);
+
+  RST_LOG_INFO("{}", evaluate());
+  EXPECT_EQ(evaluation_count, 1);
+}
+
+TEST(Logger, LogEveryN) {
+  auto sink = std::make_unique<SinkMock>();
+
+  testing::InSequence seq;
+  EXPECT_CALL(*sink, Log(testing::EndsWith("] x=0")));
+  EXPECT_CALL(*sink, Log(testing::EndsWith("] x=3 (2 suppressed)")));
+  EXPECT_CALL(*sink, Log(testing::EndsWith("] x=6 (2 suppressed)")));
+
+  Logger logger(std::move(sink));
+  Logger::SetGlobalLogger(&logger);
+
+  for (auto i = 0; i < 8; i++)
+    RST_LOG_EVERY_N(INFO, 3, "x={}", i);
+}
+
+TEST(Logger, LogEveryZero) {
+  auto sink = std::make_unique<SinkMock>();
+
+  testing::InSequence seq;
+  EXPECT_CALL(*sink, Log(testing::EndsWith("] x=0")));
+  EXPECT_CALL(*sink, Log(testing::EndsWith("] x=1")));
+
+  Logger logger(std::move(sink));
+  Logger::SetGlobalLogger(&logger);
+
+  for (auto i = 0; i < 2; i++)
+    RST_LOG_EVERY_N(INFO, 0, "x={}", i);
+}
+
+TEST(Logger, LogFirstN) {
+  auto sink = std::make_unique<SinkMock>();
+
+  testing::InSequence seq;
+  EXPECT_CALL(*sink, Log(testing::EndsWith("] Message")));
+  EXPECT_CALL(*sink, Log(testing::EndsWith("] Message")));
+
+  Logger logger(std::move(sink));
+  Logger::SetGlobalLogger(&logger);
+
+  for (auto i = 0; i < 5; i++)
+    RST_LOG_FIRST_N(WARNING, 2, "Message");
+}
+
+TEST(Logger, LogEveryT) {
+  auto sink = std::make_unique<SinkMock>();
+
+  testing::InSequence seq;
+  EXPECT_CALL(*sink, Log(testing::EndsWith("] x=0")));
+  EXPECT_CALL(*sink, Log(testing::EndsWith("] x=3 (2 suppressed)")));
+
+  Logger logger(std::move(sink));
+  Logger::SetGlobalLogger(&logger);
+
+  for (auto i = 0; i < 4; i++) {
+    if (i == 3)
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    RST_LOG_EVERY_T(ERROR, std::chrono::milliseconds(50), "x={}", i);
+  }
+}
+
+TEST(Logger, LogSampled) {
+  auto sink = std::make_unique<SinkMock>();
+
+  EXPECT_CALL(*sink, Log(testing::EndsWith("] Always"))).Times(10);
+  EXPECT_CALL(*sink, Log(testing::EndsWith("] Never"))).Times(0);
+
+  Logger logger(std::move(sink));
+  Logger::SetGlobalLogger(&logger);
+
+  for (auto i = 0; i < 10; i++) {
+    RST_LOG_SAMPLED(DEBUG, 1.0, "Always");
+    RST_LOG_SAMPLED(DEBUG, 0.0, "Never");
+  }
+}
+
+TEST(Logger, LogSampledReportsSuppressed) {
+  std::vector<std::string> messages;
+
+  class CollectingSink : public Sink {
+   public:
+    explicit CollectingSink(const NotNull<std::vector<std::string>*> messages)
+        : messages_(messages) {}
+    void Log(const std::string_view message) final {
+      messages_->emplace_back(message);
+    }
+
+   private:
+    const NotNull<std::vector<std::string>*> messages_;
+  };
+
+  Logger logger(std::make_unique<CollectingSink>(&messages));
+  Logger::SetGlobalLogger(&logger);
+
+  static constexpr auto kCount = 10000;
+  for (auto i = 0; i < kCount; i++)
+    RST_LOG_SAMPLED(INFO, 0.1, "Message");
+
+  // Every logged message accounts for itself and the suppressed ones before.
+  ASSERT_FALSE(messages.empty());
+  EXPECT_LT(messages.size(), static_cast<size_t>(kCount) / 2);
+  size_t total = 0;
+  for (const auto& message : messages) {
+    total++;
+    const auto open = message.find(" (");
+    if (open != std::string::npos)
+      total += std::stoul(message.substr(open + 2));
+  }
+  EXPECT_LE(total, static_cast<size_t>(kCount));
+  EXPECT_GT(total, static_cast<size_t>(kCount) - 100);
+}
+
+TEST(Logger, LogRateLimitedDisabledLevel) {
+  auto sink = std::make_unique<SinkMock>();
+
+  testing::InSequence seq;
+  EXPECT_CALL(*sink, Log(testing::EndsWith("] Message")));
+
+  Logger logger(std::move(sink));
+  Logger::SetGlobalLogger(&logger);
+
+  // Disabled calls don't count.
+  for (auto i = 0; i < 4; i++) {
+    logger.set_level(i == 3 ? Logger::Level::kAll : Logger::Level::kOff);
+    RST_LOG_EVERY_N(INFO, 2, "Message");
+  }
+}
+
+TEST(Logger, WallClockTimestamp) {
+  auto sink = std::make_unique<SinkMock>();
+
+  EXPECT_CALL(*sink, Log(testing::MatchesRegex(
+                         "\\[[0-9]{4}-[0-9]{2}-[0-9]{2} [0-9]{2}:[0-9]{2}:"
+                         "[0-9]{2}\\.[0-9]{6} DEBUG:filename\\(10\\)\\] "
+                         "message")))
+      .Times(2);
+
+  Logger logger(std::move(sink));
+  Logger::SetGlobalLogger(&logger);
+  logger.set_timestamp(Logger::Timestamp::kWallClock);
+
+  // The second one uses the cached date and time.
+  Logger::Log(Logger::Level::kDebug, kFilename, kLine, kMessage);
+  Logger::Log(Logger::Level::kDebug, kFilename, kLine, kMessage);
+}
+
+TEST(Logger, MonotonicTimestampAndThreadId) {
+  auto sink = std::make_unique<SinkMock>();
+
+  EXPECT_CALL(*sink, Log(testing::MatchesRegex(
+                         "\\[[0-9]+\\.[0-9]{6} [0-9]+ "
+                         "INFO:filename\\(10\\)\\] x=1")));
+
+  Logger logger(std::move(sink));
+  Logger::SetGlobalLogger(&logger);
+  logger.set_timestamp(Logger::Timestamp::kMonotonic);
+  logger.set_log_thread_id(true);
+
+  Logger::Log(Logger::Level::kInfo, kFilename, kLine, "x={}", 1);
+}
+
+TEST(Logger, ThreadId) {
+  std::vector<std::string> messages;
+
+  class CollectingSink : public Sink {
+   public:
+    explicit CollectingSink(const NotNull<std::vector<std::string>*> messages)
+        : messages_(messages) {}
+    void Log(const std::string_view message) final {
+      messages_->emplace_back(message);
+    }
+
+   private:
+    const NotNull<std::vector<std::string>*> messages_;
+  };
+
+  Logger logger(std::make_unique<CollectingSink>(&messages));
+  Logger::SetGlobalLogger(&logger);
+  logger.set_log_thread_id(true);
+
+  Logger::Log(Logger::Level::kInfo, kFilename, kLine, kMessage);
+  Logger::Log(Logger::Level::kInfo, kFilename, kLine, kMessage);
+  std::thread thread(
+      []() { Logger::Log(Logger::Level::kInfo, kFilename, kLine, kMessage); });
+  thread.join();
+
+  ASSERT_EQ(messages.size(), 3U);
+  const auto thread_id = [](const std::string& message) {
+    return message.substr(1, message.find(' ') - 1);
+  };
+  EXPECT_EQ(thread_id(messages[0]), thread_id(messages[1]));
+  EXPECT_NE(thread_id(messages[0]), thread_id(messages[2]));
+  EXPECT_EQ(messages[0].substr(messages[0].find(' ')),
+            std::string(" INFO:") + kFilename + "(" + kLineStr + ")] " +
+                kMessage);
+}
+
 TEST(Logger, ZeroLine) {
   auto sink = std::make_unique<SinkMock>();
 
@@ -0,0 +1,134 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/mmap_ring_reader.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "rst/logger/log_error.h"
+#include "rst/logger/mmap_ring_sink.h"
+
+namespace rst {
+namespace {
+
+using Header = MmapRingSink::FileHeader;
+using Block = MmapRingSink::Block;
+
+struct BlockView {
+  uint64_t seq = 0;
+  uint16_t index = 0;
+  uint16_t count = 0;
+  std::string_view data;
+};
+
+template <class T>
+T Load(const std::string_view data, const size_t offset) {
+  T value;
+  std::memcpy(&value, data.data() + offset, sizeof(value));
+  return value;
+}
+
+}  // namespace
+
+StatusOr<std::string> ReadMmapRing(const std::string_view data) {
+  static constexpr auto kBlockSize = MmapRingSink::kBlockSize;
+
+  if (data.size() < kBlockSize ||
+      data.substr(0, MmapRingSink::kMagic.size()) != MmapRingSink::kMagic) {
+    return MakeStatus<LogError>("Not a memory-mapped ring log");
+  }
+
+  const auto block_size = Load<uint32_t>(data, offsetof(Header, block_size));
+  const auto block_count = Load<uint32_t>(data, offsetof(Header, block_count));
+  if (block_size != kBlockSize || block_count == 0 ||
+      data.size() / kBlockSize - 1 < block_count) {
+    return MakeStatus<LogError>("Corrupted memory-mapped ring log header");
+  }
+
+  std::vector<BlockView> blocks;
+  blocks.reserve(block_count);
+  for (uint32_t i = 0; i < block_count; i++) {
+    const auto offset = (i + 1) * kBlockSize;
+    BlockView block;
+    block.seq = Load<uint64_t>(data, offset + offsetof(Block, seq));
+    // Skips the empty, torn and garbage blocks.
+    if (block.seq == 0 || block.seq % block_count != i)
+      continue;
+
+    const auto size = Load<uint32_t>(data, offset + offsetof(Block, size));
+    if (size > sizeof(Block::data))
+      continue;
+
+    block.index = Load<uint16_t>(data, offset + offsetof(Block, index));
+    block.count = Load<uint16_t>(data, offset + offsetof(Block, count));
+    block.data = data.substr(offset + offsetof(Block, data), size);
+    // Skips the blocks mixed by the lapped writers.
+    const auto checksum =
+        Load<uint32_t>(data, offset + offsetof(Block, checksum));
+    if (checksum != MmapRingSink::Checksum(block.seq, block.index,
+                                           block.count, block.data)) {
+      continue;
+    }
+
+    blocks.emplace_back(block);
+  }
+
+  std::sort(blocks.begin(), blocks.end(),
+            [](const BlockView& lhs, const BlockView& rhs) {
+              return lhs.seq < rhs.seq;
+            });
+
+  std::string text;
+  for (size_t i = 0; i < blocks.size();) {
+    const auto& first = blocks[i];
+    auto is_complete = first.index == 0 && first.count != 0 &&
+                       blocks.size() - i >= first.count;
+    for (size_t j = 1; is_complete && j < first.count; j++) {
+      const auto& block = blocks[i + j];
+      is_complete = block.seq == first.seq + j && block.index == j &&
+                    block.count == first.count;
+    }
+
+    if (!is_complete) {
+      i++;
+      continue;
+    }
+
+    for (size_t j = 0; j < first.count; j++)
+      text += blocks[i + j].data;
+    text += '\n';
+    i += first.count;
+  }
+
+  return text;
+}
+
+}  // namespace rst
@@ -0,0 +1,189 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/mmap_ring_sink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include "rst/check/check.h"
+#include "rst/logger/log_error.h"
+#include "rst/macros/os.h"
+#include "rst/memory/memory.h"
+#include "rst/strings/str_cat.h"
+
+#if !RST_BUILDFLAG(OS_WIN)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rst {
+
+MmapRingSink::MmapRingSink(const int fd, const NotNull<void*> data,
+                           const size_t size)
+    : fd_(fd),
+      data_(data),
+      size_(size),
+      header_(static_cast<FileHeader*>(data.get())),
+      blocks_(reinterpret_cast<Block*>(static_cast<char*>(data.get()) +
+                                       kBlockSize)),
+      block_count_(static_cast<uint32_t>(size / kBlockSize - 1)) {
+  RST_DCHECK(block_count_ >= 2);
+
+  // Continues after the messages of the previous run, so they stay readable
+  // after a restart.
+  if (std::memcmp(header_->magic, kMagic.data(), kMagic.size()) == 0 &&
+      header_->block_size == kBlockSize &&
+      header_->block_count == block_count_ &&
+      header_->next_seq.load(std::memory_order_relaxed) != 0) {
+    return;
+  }
+
+  new (header_.get()) FileHeader;
+  std::memcpy(header_->magic, kMagic.data(), kMagic.size());
+  header_->block_size = kBlockSize;
+  header_->block_count = block_count_;
+  header_->next_seq.store(1, std::memory_order_relaxed);
+
+  for (uint32_t i = 0; i < block_count_; i++)
+    new (&blocks_.get()[i].seq) std::atomic<uint64_t>(0);
+}
+
+#if RST_BUILDFLAG(OS_WIN)
+MmapRingSink::~MmapRingSink() = default;
+
+// static
+StatusOr<NotNull<std::unique_ptr<MmapRingSink>>> MmapRingSink::Create(
+    const NotNull<const char*> filename, size_t) {
+  return MakeStatus<LogError>(
+      StrCat({"Memory-mapped logging is not supported: ", filename}));
+}
+
+void MmapRingSink::Flush() {}
+#else
+MmapRingSink::~MmapRingSink() {
+  (void)::munmap(data_.get(), size_);
+  (void)::close(fd_);
+}
+
+// static
+StatusOr<NotNull<std::unique_ptr<MmapRingSink>>> MmapRingSink::Create(
+    const NotNull<const char*> filename, size_t size) {
+  size = size / kBlockSize * kBlockSize;
+  if (size < 3 * kBlockSize)
+    return MakeStatus<LogError>(StrCat({"Too small ring for ", filename}));
+
+  int fd = -1;
+  do {
+    fd = ::open(filename.get(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  } while (fd == -1 && errno == EINTR);
+  if (fd == -1)
+    return MakeStatus<LogError>(StrCat({"Can't open file ", filename}));
+
+  // Keeps the file of the same size, the constructor checks whether it holds a
+  // ring. Clears any other one.
+  struct ::stat st = {};
+  if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) != size) {
+    if (::ftruncate(fd, 0) != 0 ||
+        ::ftruncate(fd, static_cast<::off_t>(size)) != 0) {
+      (void)::close(fd);
+      return MakeStatus<LogError>(StrCat({"Can't resize file ", filename}));
+    }
+  }
+
+  auto data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    (void)::close(fd);
+    return MakeStatus<LogError>(StrCat({"Can't map file ", filename}));
+  }
+
+  return WrapUnique(NotNull(new MmapRingSink(fd, data, size)));
+}
+
+void MmapRingSink::Flush() {
+  RST_CHECK(::msync(data_.get(), size_, MS_SYNC) == 0);
+}
+#endif  // RST_BUILDFLAG(OS_WIN)
+
+// static
+uint32_t MmapRingSink::Checksum(const uint64_t seq, const uint16_t index,
+                                const uint16_t count,
+                                const std::string_view data) {
+  uint32_t hash = 2166136261U;
+  const auto add = [&hash](const void* bytes, const size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      hash ^= static_cast<const unsigned char*>(bytes)[i];
+      hash *= 16777619U;
+    }
+  };
+
+  add(&seq, sizeof(seq));
+  add(&index, sizeof(index));
+  add(&count, sizeof(count));
+  add(data.data(), data.size());
+  return hash;
+}
+
+void MmapRingSink::Log(std::string_view message) {
+  static constexpr auto kDataSize = sizeof(Block::data);
+
+  const auto max_count =
+      std::min<size_t>(kMaxBlocksPerMessage, block_count_ / 2);
+  message = message.substr(0, max_count * kDataSize);
+  const auto count = std::max<size_t>(
+      1, (message.size() + kDataSize - 1) / kDataSize);
+
+  const auto first_seq =
+      header_->next_seq.fetch_add(count, std::memory_order_relaxed);
+  for (size_t i = 0; i < count; i++) {
+    const auto seq = first_seq + i;
+    auto& block = blocks_.get()[seq % block_count_];
+
+    // Invalidates the block before changing it, so a crash in the middle
+    // leaves it skipped by the reader.
+    block.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const auto piece = message.substr(i * kDataSize, kDataSize);
+    std::memcpy(block.data, piece.data(), piece.size());
+    block.size = static_cast<uint32_t>(piece.size());
+    block.index = static_cast<uint16_t>(i);
+    block.count = static_cast<uint16_t>(count);
+    block.checksum = Checksum(seq, block.index, block.count, piece);
+    block.seq.store(seq, std::memory_order_release);
+  }
+}
+
+void MmapRingSink::EmergencyLog(const std::string_view message) {
+  Log(message);
+}
+
+}  // namespace rst
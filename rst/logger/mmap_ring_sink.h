@@ -0,0 +1,135 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_LOGGER_MMAP_RING_SINK_H_
+#define RST_LOGGER_MMAP_RING_SINK_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "rst/logger/sink.h"
+#include "rst/macros/macros.h"
+#include "rst/not_null/not_null.h"
+#include "rst/status/status_or.h"
+
+namespace rst {
+
+// The sink that keeps the latest messages in a fixed-size memory-mapped file
+// used as a circular buffer. Logging is lock-free and makes no system calls,
+// and since the pages are shared with the kernel, the messages survive a crash
+// of the process. Use ReadMmapRing() or the rst_mmap_ring_reader tool to
+// extract them in order.
+//
+// The file is a header block followed by |kBlockSize| blocks. A message takes
+// one or more consecutive blocks, every block stores its sequence number that
+// is written last, so the reader skips the torn and the overwritten ones. The
+// writers lapped by others may still mix their data in a block, so it also
+// stores a checksum, and the reader skips the blocks that don't match it.
+// Messages longer than |kMaxBlocksPerMessage| blocks are truncated.
+//
+// Example:
+//
+//   auto sink = MmapRingSink::Create("crash.log", 4 * 1024 * 1024);
+//   if (sink.err())
+//     ...
+//   Logger logger(std::move(*sink));
+//
+class MmapRingSink : public Sink {
+ public:
+  static constexpr std::string_view kMagic = "RSTMRNG2";
+  static constexpr size_t kBlockSize = 128;
+  static constexpr size_t kMaxBlocksPerMessage = 64;
+
+  // The layout of the file, shared with the reader.
+  struct FileHeader {
+    char magic[kMagic.size()];
+    uint32_t block_size;
+    uint32_t block_count;
+    // The sequence number of the next block, starts from 1.
+    std::atomic<uint64_t> next_seq;
+  };
+
+  struct Block {
+    // Zero while the block is being written.
+    std::atomic<uint64_t> seq;
+    // Number of the message bytes in this block.
+    uint32_t size;
+    // Position of the block in its message and the number of the message
+    // blocks.
+    uint16_t index;
+    uint16_t count;
+    // Checksum() of the fields above and the data.
+    uint32_t checksum;
+    char data[kBlockSize - 20];
+  };
+
+  static_assert(sizeof(FileHeader) <= kBlockSize);
+  static_assert(sizeof(Block) == kBlockSize);
+
+  // Returns the checksum of a block, FNV-1a of its fields.
+  static uint32_t Checksum(uint64_t seq, uint16_t index, uint16_t count,
+                           std::string_view data);
+
+  // Opens or creates |filename| and maps it. If the file already holds a ring
+  // of the same size, for example left by a crashed run, keeps its messages
+  // and appends after them. Otherwise clears it. |size| is rounded down to
+  // whole blocks and should be at least 2 blocks. Returns LogError on error.
+  static StatusOr<NotNull<std::unique_ptr<MmapRingSink>>> Create(
+      NotNull<const char*> filename, size_t size);
+
+  ~MmapRingSink() final;
+
+  // Thread safe lock-free logging function.
+  void Log(std::string_view message) final;
+
+  // Same as Log(), it's async-signal-safe.
+  void EmergencyLog(std::string_view message) final;
+
+  // Writes the dirty pages to the disk, so the messages survive a crash of the
+  // system as well.
+  void Flush() final;
+
+ private:
+  MmapRingSink(int fd, NotNull<void*> data, size_t size);
+
+  const int fd_;
+  const NotNull<void*> data_;
+  const size_t size_;
+
+  const NotNull<FileHeader*> header_;
+  const NotNull<Block*> blocks_;
+  const uint32_t block_count_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(MmapRingSink);
+};
+
+}  // namespace rst
+
+#endif  // RST_LOGGER_MMAP_RING_SINK_H_
@@ -0,0 +1,283 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/mmap_ring_sink.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "rst/check/check.h"
+#include "rst/files/file_utils.h"
+#include "rst/logger/mmap_ring_reader.h"
+#include "rst/macros/macros.h"
+
+namespace rst {
+namespace {
+
+constexpr auto kBlockSize = MmapRingSink::kBlockSize;
+
+class File {
+ public:
+  File() { RST_CHECK(std::tmpnam(buffer_) != nullptr); }
+  ~File() { std::remove(buffer_); }
+
+  NotNull<const char*> FileName() const { return buffer_; }
+
+  std::string ReadRaw() const {
+    auto data = ReadFile(buffer_);
+    RST_CHECK(!data.err());
+    return std::move(*data);
+  }
+
+  std::string Read() const {
+    auto text = ReadMmapRing(ReadRaw());
+    RST_CHECK(!text.err());
+    return std::move(*text);
+  }
+
+ private:
+  char buffer_[L_tmpnam];
+
+  RST_DISALLOW_COPY_AND_ASSIGN(File);
+};
+
+}  // namespace
+
+TEST(MmapRingSink, Log) {
+  File file;
+  auto sink = MmapRingSink::Create(file.FileName(), 64 * kBlockSize);
+  ASSERT_FALSE(sink.err());
+
+  EXPECT_EQ(file.Read(), "");
+  (*sink)->Log("Message1");
+  (*sink)->Log("");
+  (*sink)->Log("Message3");
+  (*sink)->Flush();
+  EXPECT_EQ(file.Read(), "Message1\n\nMessage3\n");
+}
+
+TEST(MmapRingSink, LongMessage) {
+  File file;
+  auto sink = MmapRingSink::Create(file.FileName(), 64 * kBlockSize);
+  ASSERT_FALSE(sink.err());
+
+  std::string message;
+  for (auto i = 0; i < 100; i++)
+    message += std::to_string(i);
+  (*sink)->Log(message);
+  (*sink)->Log("Message");
+  EXPECT_EQ(file.Read(), message + "\nMessage\n");
+}
+
+TEST(MmapRingSink, Truncation) {
+  File file;
+  // 8 blocks, a message takes at most 4.
+  auto sink = MmapRingSink::Create(file.FileName(), 9 * kBlockSize);
+  ASSERT_FALSE(sink.err());
+
+  const std::string message(10000, 'A');
+  (*sink)->Log(message);
+  EXPECT_EQ(file.Read(),
+            message.substr(0, 4 * sizeof(MmapRingSink::Block::data)) + "\n");
+}
+
+TEST(MmapRingSink, Wraparound) {
+  File file;
+  auto sink = MmapRingSink::Create(file.FileName(), 9 * kBlockSize);
+  ASSERT_FALSE(sink.err());
+
+  std::string expected;
+  for (auto i = 0; i < 100; i++) {
+    const auto message = "Message" + std::to_string(i);
+    (*sink)->Log(message);
+    expected += message + "\n";
+  }
+
+  // The ring keeps the last 8 messages.
+  const auto text = file.Read();
+  EXPECT_EQ(text, expected.substr(expected.size() - text.size()));
+  EXPECT_EQ(text.find("Message92\n"), 0U);
+
+  // A long message overwrites a few short ones.
+  const std::string message(300, 'A');
+  (*sink)->Log(message);
+  EXPECT_EQ(file.Read(),
+            "Message95\nMessage96\nMessage97\nMessage98\nMessage99\n" +
+                message + "\n");
+}
+
+TEST(MmapRingSink, LogThreadSafe) {
+  static constexpr size_t kThreadNumber = 4;
+  static constexpr size_t kMessageNumber = 1000;
+
+  File file;
+  auto sink = MmapRingSink::Create(
+      file.FileName(), (kThreadNumber * kMessageNumber + 1) * kBlockSize);
+  ASSERT_FALSE(sink.err());
+
+  std::vector<std::thread> threads;
+  threads.reserve(kThreadNumber);
+  for (size_t i = 0; i < kThreadNumber; i++) {
+    threads.emplace_back([&sink, i]() {
+      for (size_t j = 0; j < kMessageNumber; j++)
+        (*sink)->Log(std::to_string(i) + " " + std::to_string(j));
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  std::istringstream lines(file.Read());
+  std::vector<size_t> next(kThreadNumber, 0);
+  size_t thread = 0;
+  size_t number = 0;
+  while (lines >> thread >> number) {
+    ASSERT_LT(thread, kThreadNumber);
+    EXPECT_EQ(number, next[thread]);
+    next[thread]++;
+  }
+  EXPECT_EQ(next, std::vector<size_t>(kThreadNumber, kMessageNumber));
+}
+
+TEST(MmapRingSink, SurvivesCrash) {
+  File file;
+
+  EXPECT_DEATH(
+      {
+        auto sink = MmapRingSink::Create(file.FileName(), 64 * kBlockSize);
+        RST_CHECK(!sink.err());
+        (*sink)->Log("Last words");
+        std::abort();
+      },
+      "");
+
+  EXPECT_EQ(file.Read(), "Last words\n");
+}
+
+TEST(MmapRingSink, Restart) {
+  File file;
+
+  EXPECT_DEATH(
+      {
+        auto sink = MmapRingSink::Create(file.FileName(), 64 * kBlockSize);
+        RST_CHECK(!sink.err());
+        (*sink)->Log("Message1");
+        (*sink)->Log(std::string(300, 'A'));
+        std::abort();
+      },
+      "");
+
+  // The restarted process keeps the messages of the crashed one.
+  {
+    auto sink = MmapRingSink::Create(file.FileName(), 64 * kBlockSize);
+    ASSERT_FALSE(sink.err());
+    EXPECT_EQ(file.Read(), "Message1\n" + std::string(300, 'A') + "\n");
+    (*sink)->Log("Message2");
+    EXPECT_EQ(file.Read(),
+              "Message1\n" + std::string(300, 'A') + "\nMessage2\n");
+  }
+
+  // A ring of another size starts from scratch.
+  auto sink = MmapRingSink::Create(file.FileName(), 32 * kBlockSize);
+  ASSERT_FALSE(sink.err());
+  EXPECT_EQ(file.Read(), "");
+  (*sink)->Log("Message3");
+  EXPECT_EQ(file.Read(), "Message3\n");
+}
+
+TEST(MmapRingSink, TornMessage) {
+  File file;
+  {
+    auto sink = MmapRingSink::Create(file.FileName(), 64 * kBlockSize);
+    ASSERT_FALSE(sink.err());
+    (*sink)->Log("Message1");
+    (*sink)->Log(std::string(300, 'A'));
+    (*sink)->Log("Message2");
+  }
+
+  // Simulates a crash in the middle of writing the second block of the long
+  // message.
+  auto data = file.ReadRaw();
+  const uint64_t seq = 0;
+  std::memcpy(&data[4 * kBlockSize], &seq, sizeof(seq));
+
+  auto text = ReadMmapRing(data);
+  ASSERT_FALSE(text.err());
+  EXPECT_EQ(*text, "Message1\nMessage2\n");
+}
+
+TEST(MmapRingSink, MixedBlock) {
+  File file;
+  {
+    auto sink = MmapRingSink::Create(file.FileName(), 64 * kBlockSize);
+    ASSERT_FALSE(sink.err());
+    (*sink)->Log("Message1");
+    (*sink)->Log("Message2");
+  }
+
+  // Simulates a lapped writer that changed the data of the first message after
+  // the last one published it.
+  auto data = file.ReadRaw();
+  data[2 * kBlockSize + offsetof(MmapRingSink::Block, data)] = 'X';
+
+  auto text = ReadMmapRing(data);
+  ASSERT_FALSE(text.err());
+  EXPECT_EQ(*text, "Message2\n");
+}
+
+TEST(MmapRingSink, ReadError) {
+  EXPECT_TRUE(ReadMmapRing("").err());
+  EXPECT_TRUE(ReadMmapRing(std::string(1000, 'A')).err());
+
+  // The header claims more blocks than there are.
+  std::string data(2 * kBlockSize, '\0');
+  std::memcpy(&data[0], MmapRingSink::kMagic.data(),
+              MmapRingSink::kMagic.size());
+  const uint32_t block_size = kBlockSize;
+  const uint32_t block_count = 2;
+  std::memcpy(&data[8], &block_size, sizeof(block_size));
+  std::memcpy(&data[12], &block_count, sizeof(block_count));
+  EXPECT_TRUE(ReadMmapRing(data).err());
+}
+
+TEST(MmapRingSink, CreateError) {
+  EXPECT_TRUE(MmapRingSink::Create("/nonexistent/directory/file",
+                                   64 * kBlockSize)
+                  .err());
+  File file;
+  EXPECT_TRUE(MmapRingSink::Create(file.FileName(), 2 * kBlockSize).err());
+}
+
+}  // namespace rst
@@ -0,0 +1,324 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/per_thread_buffer_sink.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "rst/check/check.h"
+#include "rst/macros/optimization.h"
+
+namespace chrono = std::chrono;
+
+namespace rst {
+namespace {
+
+constexpr auto kCollectInterval = chrono::milliseconds(10);
+constexpr uint64_t kIdle = UINT64_MAX;
+
+std::atomic<uint64_t> g_last_sink_id{0};
+
+}  // namespace
+
+PerThreadBufferSink::Entry::Entry(const LogLevel level,
+                                  const std::string_view message)
+    : level(level) {
+  if (message.size() <= kInlineMessageSize) {
+    inline_size = static_cast<uint32_t>(message.size());
+    std::memcpy(inline_message, message.data(), message.size());
+  } else {
+    long_message = message;
+  }
+}
+
+PerThreadBufferSink::Entry::Entry(Entry&& other) noexcept {
+  *this = std::move(other);
+}
+
+PerThreadBufferSink::Entry& PerThreadBufferSink::Entry::operator=(
+    Entry&& other) noexcept {
+  timestamp = other.timestamp;
+  level = other.level;
+  inline_size = other.inline_size;
+  long_message = std::move(other.long_message);
+  std::memcpy(inline_message, other.inline_message, inline_size);
+  return *this;
+}
+
+std::string_view PerThreadBufferSink::Entry::message() const {
+  if (inline_size != 0)
+    return std::string_view(inline_message, inline_size);
+  return long_message;
+}
+
+class PerThreadBufferSink::Buffer {
+ public:
+  explicit Buffer(const size_t capacity) : ring(capacity) {}
+
+  SpscRing<Entry> ring;
+  // The timestamp taken before the one of the message being pushed, kIdle if
+  // the owning thread isn't logging.
+  std::atomic<uint64_t> in_flight{kIdle};
+  // Set on the owning thread exit.
+  std::atomic<bool> is_abandoned{false};
+
+ private:
+  RST_DISALLOW_COPY_AND_ASSIGN(Buffer);
+};
+
+// The buffers of the current thread, one per sink it has logged to. Marks them
+// abandoned on the thread exit so the sinks can release them once drained.
+struct PerThreadBufferSink::ThreadBuffers {
+  struct Item {
+    uint64_t sink_id = 0;
+    std::shared_ptr<Buffer> buffer;
+  };
+
+  ThreadBuffers() = default;
+  ~ThreadBuffers() {
+    for (const auto& item : items)
+      item.buffer->is_abandoned.store(true, std::memory_order_release);
+  }
+
+  std::vector<Item> items;
+};
+
+PerThreadBufferSink::PerThreadBufferSink(NotNull<std::unique_ptr<Sink>> sink,
+                                         const size_t thread_capacity)
+    : sink_(std::move(sink)),
+      thread_capacity_(thread_capacity),
+      id_(g_last_sink_id.fetch_add(1, std::memory_order_relaxed) + 1) {
+  thread_ = std::thread(&PerThreadBufferSink::CollectMessages, this);
+}
+
+PerThreadBufferSink::~PerThreadBufferSink() {
+  {
+    MutexLock lock(&thread_mutex_);
+    should_exit_ = true;
+  }
+  thread_cv_.NotifyOne();
+  thread_.join();
+
+  MutexLock lock(&drain_mutex_);
+  PopMessages(GetBuffers());
+  WritePending(kIdle);
+  sink_->Flush();
+}
+
+void PerThreadBufferSink::Log(const std::string_view message) {
+  LogRecord record;
+  record.message = message;
+  Emit(record);
+}
+
+void PerThreadBufferSink::Emit(const LogRecord& record) {
+  auto& buffer = *GetThreadBuffer();
+
+  Entry entry(record.level, record.message);
+
+  // The collector doesn't write the messages newer than the in-flight
+  // timestamp, so no message newer than this one is written before it.
+  buffer.in_flight.store(Now());
+  entry.timestamp = Now();
+  while (!buffer.ring.TryPush(std::move(entry))) {
+    thread_cv_.NotifyOne();
+    std::this_thread::yield();
+  }
+  buffer.in_flight.store(kIdle, std::memory_order_release);
+}
+
+void PerThreadBufferSink::Flush() {
+  const auto start = Now();
+
+  MutexLock lock(&drain_mutex_);
+  while (Drain() <= start)
+    std::this_thread::yield();
+  sink_->Flush();
+}
+
+// static
+uint64_t PerThreadBufferSink::Now() {
+  return static_cast<uint64_t>(
+      chrono::duration_cast<chrono::nanoseconds>(
+          chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+NotNull<PerThreadBufferSink::Buffer*> PerThreadBufferSink::GetThreadBuffer() {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+  thread_local ThreadBuffers thread_buffers;
+#pragma clang diagnostic pop
+
+  auto& items = thread_buffers.items;
+  for (const auto& item : items) {
+    if (RST_LIKELY(item.sink_id == id_))
+      return item.buffer.get();
+  }
+
+  // Forgets the buffers of the destroyed sinks.
+  items.erase(std::remove_if(items.begin(), items.end(),
+                             [](const ThreadBuffers::Item& item) {
+                               return item.buffer.use_count() == 1;
+                             }),
+              items.end());
+
+  ThreadBuffers::Item item;
+  item.sink_id = id_;
+  item.buffer = std::make_shared<Buffer>(thread_capacity_);
+  {
+    MutexLock lock(&buffers_mutex_);
+    buffers_.emplace_back(item.buffer);
+  }
+  items.emplace_back(std::move(item));
+  return items.back().buffer.get();
+}
+
+void PerThreadBufferSink::CollectMessages() {
+  while (true) {
+    {
+      MutexLock lock(&thread_mutex_);
+      if (should_exit_)
+        return;
+      thread_cv_.WaitFor(&lock, kCollectInterval);
+      if (should_exit_)
+        return;
+    }
+
+    MutexLock lock(&drain_mutex_);
+    const auto written_count = written_count_;
+    Drain();
+    if (written_count_ != written_count)
+      sink_->Flush();
+  }
+}
+
+void PerThreadBufferSink::EmergencyLog(const std::string_view message) {
+  EmergencyFlush();
+  sink_->EmergencyLog(message);
+}
+
+void PerThreadBufferSink::EmergencyFlush() {
+  // Only the holder of |drain_mutex_| may pop the buffers.
+  if (drain_mutex_.TryLock()) {
+    if (buffers_mutex_.TryLock()) {
+      for (const auto& entry : pending_)
+        sink_->EmergencyLog(entry.message());
+
+      for (const auto& buffer : buffers_) {
+        while (true) {
+          // The popped entries are never destroyed since freeing memory isn't
+          // async-signal-safe.
+          alignas(Entry) unsigned char storage[sizeof(Entry)];
+          const auto entry = new (storage) Entry;
+          if (!buffer->ring.TryPop(entry))
+            break;
+          sink_->EmergencyLog(entry->message());
+        }
+      }
+      buffers_mutex_.Unlock();
+    }
+    drain_mutex_.Unlock();
+  }
+
+  sink_->EmergencyFlush();
+}
+
+uint64_t PerThreadBufferSink::Drain() {
+  // A thread that stores its in-flight timestamp after it's loaded here takes
+  // the message timestamp after the watermark. The watermark is taken before
+  // the buffers are copied, so the same holds for the threads that add their
+  // buffers later.
+  auto watermark = Now();
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  const auto buffers = GetBuffers();
+  for (const auto& buffer : buffers)
+    watermark = std::min(watermark, buffer->in_flight.load());
+
+  PopMessages(buffers);
+  WritePending(watermark);
+  return watermark;
+}
+
+std::vector<std::shared_ptr<PerThreadBufferSink::Buffer>>
+PerThreadBufferSink::GetBuffers() {
+  MutexLock lock(&buffers_mutex_);
+  return buffers_;
+}
+
+void PerThreadBufferSink::PopMessages(
+    const std::vector<std::shared_ptr<Buffer>>& buffers) {
+  const auto by_timestamp = [](const Entry& lhs, const Entry& rhs) {
+    return lhs.timestamp < rhs.timestamp;
+  };
+
+  for (const auto& buffer : buffers) {
+    // Loaded before popping, so nothing is pushed to the abandoned buffer
+    // after it's drained.
+    const auto is_abandoned =
+        buffer->is_abandoned.load(std::memory_order_acquire);
+
+    // The messages of one thread are already sorted.
+    const auto size = pending_.size();
+    Entry entry;
+    while (buffer->ring.TryPop(&entry))
+      pending_.emplace_back(std::move(entry));
+    std::inplace_merge(pending_.begin(),
+                       pending_.begin() + static_cast<ptrdiff_t>(size),
+                       pending_.end(), by_timestamp);
+
+    if (is_abandoned) {
+      MutexLock lock(&buffers_mutex_);
+      buffers_.erase(std::find(buffers_.begin(), buffers_.end(), buffer));
+    }
+  }
+}
+
+void PerThreadBufferSink::WritePending(const uint64_t watermark) {
+  size_t count = 0;
+  for (; count < pending_.size(); count++) {
+    const auto& entry = pending_[count];
+    if (entry.timestamp >= watermark)
+      break;
+
+    LogRecord record;
+    record.level = entry.level;
+    record.message = entry.message();
+    sink_->Emit(record);
+  }
+
+  pending_.erase(pending_.begin(),
+                 pending_.begin() + static_cast<ptrdiff_t>(count));
+  written_count_ += count;
+}
+
+}  // namespace rst
@@ -0,0 +1,156 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_LOGGER_PER_THREAD_BUFFER_SINK_H_
+#define RST_LOGGER_PER_THREAD_BUFFER_SINK_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "rst/logger/sink.h"
+#include "rst/macros/macros.h"
+#include "rst/not_null/not_null.h"
+#include "rst/threading/mutex.h"
+#include "rst/threading/spsc_ring.h"
+
+namespace rst {
+
+// The sink that removes the contention between the logging threads. Every
+// thread appends its messages with monotonic timestamps to its own lock-free
+// buffer. A collector thread periodically merges the buffers by the
+// timestamps and passes the messages to the wrapped sink in batches, flushing
+// it once per batch. The messages reach the wrapped sink in the order they
+// were logged across all the threads. Messages up to |kInlineMessageSize|
+// bytes are stored right in the buffers, so logging them doesn't allocate.
+//
+// Example:
+//
+//   auto file_sink = FileNameSink::Create("log.txt");
+//   ...
+//   Logger logger(
+//       std::make_unique<PerThreadBufferSink>(std::move(*file_sink)));
+//
+class PerThreadBufferSink : public Sink {
+ public:
+  static constexpr size_t kDefaultThreadCapacity = 1024;
+  static constexpr size_t kInlineMessageSize = 192;
+
+  // Starts the collector thread. |thread_capacity| is the number of messages
+  // every thread can have buffered, it's rounded up to a power of two. A
+  // thread blocks while its buffer is full.
+  explicit PerThreadBufferSink(
+      NotNull<std::unique_ptr<Sink>> sink,
+      size_t thread_capacity = kDefaultThreadCapacity);
+  // Writes all the buffered messages and stops the collector thread. No
+  // thread may log to the sink at this point.
+  ~PerThreadBufferSink() final;
+
+  // Thread safe logging functions.
+  void Log(std::string_view message) final;
+  void Emit(const LogRecord& record) final;
+
+  // Blocks until all the messages logged before the call are written to the
+  // wrapped sink and it's flushed.
+  void Flush() final;
+
+  // Write out the buffered messages through the wrapped sink's
+  // EmergencyLog() unless the buffers are being drained by another thread.
+  // The messages of different threads aren't merged and the merged ones can
+  // be written again by the next drain.
+  void EmergencyLog(std::string_view message) final;
+  void EmergencyFlush() final;
+
+ private:
+  struct Entry {
+    Entry() = default;
+    Entry(LogLevel level, std::string_view message);
+    // Copy only the used part of |inline_message|.
+    Entry(Entry&& other) noexcept;
+    Entry& operator=(Entry&& other) noexcept;
+
+    std::string_view message() const;
+
+    uint64_t timestamp = 0;
+    LogLevel level = LogLevel::kAll;
+    // The message is either in |inline_message| or in |long_message| if it
+    // doesn't fit.
+    uint32_t inline_size = 0;
+    std::string long_message;
+    char inline_message[kInlineMessageSize];
+  };
+
+  class Buffer;
+  struct ThreadBuffers;
+
+  static uint64_t Now();
+
+  NotNull<Buffer*> GetThreadBuffer();
+
+  void CollectMessages();
+
+  // Writes the messages that can't be preceded by a message still being
+  // logged. Returns the oldest timestamp a newly logged message can have.
+  uint64_t Drain();
+  std::vector<std::shared_ptr<Buffer>> GetBuffers();
+  // Merges the messages of the |buffers| into |pending_| and releases the
+  // drained buffers of the exited threads.
+  void PopMessages(const std::vector<std::shared_ptr<Buffer>>& buffers);
+  // Writes the pending messages older than |watermark|.
+  void WritePending(uint64_t watermark);
+
+  const NotNull<std::unique_ptr<Sink>> sink_;
+  const size_t thread_capacity_;
+  const uint64_t id_;
+
+  Mutex buffers_mutex_{"PerThreadBufferSink::buffers"};
+  std::vector<std::shared_ptr<Buffer>> buffers_;
+
+  // Serializes the collector thread and Flush() since every buffer has only
+  // one consumer.
+  Mutex drain_mutex_{"PerThreadBufferSink::drain"};
+  // Merged messages waiting for the older in-flight ones, sorted by the
+  // timestamps.
+  std::vector<Entry> pending_;
+  uint64_t written_count_ = 0;
+
+  Mutex thread_mutex_{"PerThreadBufferSink::thread"};
+  ConditionVariable thread_cv_;
+  bool should_exit_ = false;
+  std::thread thread_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(PerThreadBufferSink);
+};
+
+}  // namespace rst
+
+#endif  // RST_LOGGER_PER_THREAD_BUFFER_SINK_H_
@@ -0,0 +1,83 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdio>
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include "rst/check/check.h"
+#include "rst/logger/file_ptr_sink.h"
+#include "rst/logger/per_thread_buffer_sink.h"
+
+namespace rst {
+namespace {
+
+constexpr char kMessage[] = "[INFO benchmark.cc:1] A typical log message 42";
+
+NotNull<std::unique_ptr<Sink>> CreateFilePtrSink() {
+  auto file = std::fopen("/dev/null", "w");
+  RST_CHECK(file != nullptr);
+  return std::make_unique<FilePtrSink>(file);
+}
+
+Sink* g_sink = nullptr;
+
+// All the threads log to the same sink, that's created and destroyed by the
+// first thread.
+template <class CreateSink>
+void BM_Log(benchmark::State& state, CreateSink create_sink) {
+  std::unique_ptr<Sink> sink;
+  if (state.thread_index() == 0) {
+    sink = create_sink().Take();
+    g_sink = sink.get();
+  }
+
+  for (auto _ : state)
+    g_sink->Log(kMessage);
+
+  if (state.thread_index() == 0) {
+    sink.reset();
+    g_sink = nullptr;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_FilePtrSink(benchmark::State& state) {
+  BM_Log(state, &CreateFilePtrSink);
+}
+BENCHMARK(BM_FilePtrSink)->ThreadRange(1, 32)->UseRealTime();
+
+void BM_PerThreadBufferSink(benchmark::State& state) {
+  BM_Log(state, []() -> NotNull<std::unique_ptr<Sink>> {
+    return std::make_unique<PerThreadBufferSink>(CreateFilePtrSink());
+  });
+}
+BENCHMARK(BM_PerThreadBufferSink)->ThreadRange(1, 32)->UseRealTime();
+
+}  // namespace
+}  // namespace rst
@@ -0,0 +1,209 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/per_thread_buffer_sink.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "rst/macros/macros.h"
+
+namespace rst {
+namespace {
+
+// Collects the messages to an external vector that can be read after
+// PerThreadBufferSink::Flush() or the sink destruction.
+class CollectingSink : public Sink {
+ public:
+  explicit CollectingSink(const NotNull<std::vector<std::string>*> messages)
+      : messages_(messages) {}
+
+  void Log(const std::string_view message) final {
+    messages_->emplace_back(message);
+  }
+
+ private:
+  const NotNull<std::vector<std::string>*> messages_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(CollectingSink);
+};
+
+}  // namespace
+
+TEST(PerThreadBufferSink, Log) {
+  std::vector<std::string> messages;
+  PerThreadBufferSink sink(std::make_unique<CollectingSink>(&messages));
+  sink.Log("Message1");
+  sink.Log("Message2");
+  sink.Log("Message3");
+  sink.Flush();
+
+  const std::vector<std::string> expected_messages = {"Message1", "Message2",
+                                                      "Message3"};
+  EXPECT_EQ(messages, expected_messages);
+}
+
+TEST(PerThreadBufferSink, Destruction) {
+  std::vector<std::string> messages;
+  {
+    PerThreadBufferSink sink(std::make_unique<CollectingSink>(&messages), 2);
+    for (auto i = 0; i < 100; i++)
+      sink.Log(std::to_string(i));
+  }
+
+  ASSERT_EQ(messages.size(), 100U);
+  for (auto i = 0; i < 100; i++)
+    EXPECT_EQ(messages[static_cast<size_t>(i)], std::to_string(i));
+}
+
+TEST(PerThreadBufferSink, ExitedThread) {
+  std::vector<std::string> messages;
+  PerThreadBufferSink sink(std::make_unique<CollectingSink>(&messages));
+
+  std::thread thread([&sink]() { sink.Log("Message1"); });
+  thread.join();
+  sink.Log("Message2");
+  sink.Flush();
+
+  const std::vector<std::string> expected_messages = {"Message1", "Message2"};
+  EXPECT_EQ(messages, expected_messages);
+}
+
+TEST(PerThreadBufferSink, SeveralSinks) {
+  std::vector<std::string> messages1;
+  std::vector<std::string> messages2;
+  {
+    PerThreadBufferSink sink1(std::make_unique<CollectingSink>(&messages1));
+    PerThreadBufferSink sink2(std::make_unique<CollectingSink>(&messages2));
+    sink1.Log("Message1");
+    sink2.Log("Message2");
+    sink1.Log("Message3");
+  }
+
+  const std::vector<std::string> expected_messages1 = {"Message1",
+                                                       "Message3"};
+  const std::vector<std::string> expected_messages2 = {"Message2"};
+  EXPECT_EQ(messages1, expected_messages1);
+  EXPECT_EQ(messages2, expected_messages2);
+}
+
+TEST(PerThreadBufferSink, LongMessage) {
+  std::vector<std::string> messages;
+  PerThreadBufferSink sink(std::make_unique<CollectingSink>(&messages), 2);
+
+  const std::string inline_message(PerThreadBufferSink::kInlineMessageSize,
+                                   'A');
+  const std::string long_message(PerThreadBufferSink::kInlineMessageSize + 1,
+                                 'B');
+  for (auto i = 0; i < 3; i++) {
+    sink.Log(inline_message);
+    sink.Log(long_message);
+    sink.Log("");
+  }
+  sink.Flush();
+
+  std::vector<std::string> expected_messages;
+  for (auto i = 0; i < 3; i++) {
+    expected_messages.emplace_back(inline_message);
+    expected_messages.emplace_back(long_message);
+    expected_messages.emplace_back();
+  }
+  EXPECT_EQ(messages, expected_messages);
+}
+
+TEST(PerThreadBufferSink, OrderAcrossThreads) {
+  static constexpr size_t kMessageNumber = 1000;
+
+  std::vector<std::string> messages;
+  PerThreadBufferSink sink(std::make_unique<CollectingSink>(&messages), 4);
+
+  // The threads take turns, so every message is logged after the previous one
+  // from the other thread.
+  std::atomic<size_t> turn{0};
+  const auto log = [&sink, &turn](const size_t parity) {
+    for (auto i = parity; i < kMessageNumber; i += 2) {
+      while (turn.load(std::memory_order_acquire) != i)
+        std::this_thread::yield();
+      sink.Log(std::to_string(i));
+      turn.store(i + 1, std::memory_order_release);
+    }
+  };
+
+  std::thread thread1(log, 0);
+  std::thread thread2(log, 1);
+  thread1.join();
+  thread2.join();
+  sink.Flush();
+
+  ASSERT_EQ(messages.size(), kMessageNumber);
+  for (size_t i = 0; i < kMessageNumber; i++)
+    EXPECT_EQ(messages[i], std::to_string(i));
+}
+
+TEST(PerThreadBufferSink, LogThreadSafe) {
+  static constexpr size_t kThreadNumber = 4;
+  static constexpr size_t kMessageNumber = 1000;
+
+  std::vector<std::string> messages;
+  PerThreadBufferSink sink(std::make_unique<CollectingSink>(&messages), 16);
+
+  std::vector<std::thread> threads;
+  threads.reserve(kThreadNumber);
+  for (size_t i = 0; i < kThreadNumber; i++) {
+    threads.emplace_back([&sink, i]() {
+      for (size_t j = 0; j < kMessageNumber; j++)
+        sink.Log(std::to_string(i) + " " + std::to_string(j));
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+  sink.Flush();
+
+  ASSERT_EQ(messages.size(), kThreadNumber * kMessageNumber);
+
+  // The messages of every thread keep their order.
+  std::vector<size_t> next(kThreadNumber, 0);
+  for (const auto& message : messages) {
+    const auto space = message.find(' ');
+    ASSERT_NE(space, std::string::npos);
+    const auto thread = std::stoul(message.substr(0, space));
+    ASSERT_LT(thread, kThreadNumber);
+    EXPECT_EQ(std::stoul(message.substr(space + 1)), next[thread]);
+    next[thread]++;
+  }
+}
+
+}  // namespace rst
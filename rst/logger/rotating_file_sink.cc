@@ -0,0 +1,194 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/rotating_file_sink.h"
+
+#include <cstdio>
+#include <iterator>
+#include <utility>
+
+#include "rst/check/check.h"
+#include "rst/logger/file_descriptor.h"
+#include "rst/logger/log_error.h"
+#include "rst/memory/memory.h"
+#include "rst/strings/str_cat.h"
+
+namespace chrono = std::chrono;
+
+namespace rst {
+namespace {
+
+// How often the background thread retries to open the next file.
+constexpr auto kRetryInterval = chrono::seconds(1);
+
+}  // namespace
+
+RotatingFileSink::RotatingFileSink(std::string&& filename,
+                                   const Options& options, const int fd)
+    : filename_(std::move(filename)),
+      next_filename_(filename_ + ".next"),
+      options_(options),
+      fd_(fd),
+      file_size_(internal::GetFileSize(fd)),
+      file_start_time_(chrono::steady_clock::now()) {
+  RST_DCHECK(fd_ != -1);
+  if (options_.preallocate && options_.max_file_size != 0)
+    internal::Preallocate(fd_, options_.max_file_size);
+
+  thread_ = std::thread(&RotatingFileSink::RotateFiles, this);
+}
+
+RotatingFileSink::~RotatingFileSink() {
+  {
+    MutexLock lock(&mutex_);
+    should_exit_ = true;
+  }
+  cv_.NotifyOne();
+  thread_.join();
+
+  ReleasePreallocated(fd_);
+  internal::CloseFile(fd_);
+  if (next_fd_ != -1) {
+    internal::CloseFile(next_fd_);
+    (void)std::remove(next_filename_.c_str());
+  }
+}
+
+// static
+StatusOr<NotNull<std::unique_ptr<RotatingFileSink>>> RotatingFileSink::Create(
+    const NotNull<const char*> filename) {
+  return Create(filename, Options());
+}
+
+// static
+StatusOr<NotNull<std::unique_ptr<RotatingFileSink>>> RotatingFileSink::Create(
+    const NotNull<const char*> filename, const Options& options) {
+  const auto fd = internal::OpenForAppending(filename);
+  if (fd == -1)
+    return MakeStatus<LogError>(StrCat({"Can't open file ", filename}));
+
+  return WrapUnique(
+      NotNull(new RotatingFileSink(std::string(filename.get()), options, fd)));
+}
+
+void RotatingFileSink::Log(const std::string_view message) {
+  MutexLock lock(&mutex_);
+
+  // Keeps writing to the current file if the next one isn't ready yet.
+  if (ShouldRotate(message.size() + 1) && next_fd_ != -1) {
+    rotated_fd_ = fd_;
+    fd_ = next_fd_;
+    next_fd_ = -1;
+    file_size_ = 0;
+    file_start_time_ = chrono::steady_clock::now();
+    cv_.NotifyOne();
+  }
+
+  std::string_view pieces[] = {message, "\n"};
+  RST_CHECK(internal::WriteAll(fd_, pieces, std::size(pieces)));
+  file_size_ += message.size() + 1;
+}
+
+void RotatingFileSink::EmergencyLog(const std::string_view message) {
+  std::string_view pieces[] = {message, "\n"};
+  (void)internal::WriteAll(fd_, pieces, std::size(pieces));
+}
+
+bool RotatingFileSink::ShouldRotate(const size_t message_size) const {
+  if (file_size_ == 0)
+    return false;
+
+  if (options_.max_file_size != 0 &&
+      file_size_ + message_size > options_.max_file_size) {
+    return true;
+  }
+
+  return options_.rotation_period != chrono::milliseconds::zero() &&
+         chrono::steady_clock::now() - file_start_time_ >=
+             options_.rotation_period;
+}
+
+void RotatingFileSink::RotateFiles() {
+  while (true) {
+    auto rotated_fd = -1;
+    {
+      MutexLock lock(&mutex_);
+      while (!should_exit_ && rotated_fd_ == -1 && next_fd_ != -1)
+        cv_.Wait(&lock);
+      if (should_exit_ && rotated_fd_ == -1)
+        return;
+
+      rotated_fd = rotated_fd_;
+      rotated_fd_ = -1;
+    }
+
+    // The logging threads already write to |next_filename_|.
+    if (rotated_fd != -1) {
+      ReleasePreallocated(rotated_fd);
+      internal::CloseFile(rotated_fd);
+      RenameFiles();
+    }
+
+    const auto next_fd = OpenNextFile();
+
+    MutexLock lock(&mutex_);
+    next_fd_ = next_fd;
+    if (next_fd_ == -1 && !should_exit_)
+      cv_.WaitFor(&lock, kRetryInterval);
+  }
+}
+
+void RotatingFileSink::RenameFiles() {
+  if (options_.max_files == 0) {
+    (void)std::remove(filename_.c_str());
+  } else {
+    (void)std::remove(StrCat({filename_, ".", options_.max_files}).c_str());
+    for (auto i = options_.max_files - 1; i > 0; i--) {
+      (void)std::rename(StrCat({filename_, ".", i}).c_str(),
+                        StrCat({filename_, ".", i + 1}).c_str());
+    }
+    (void)std::rename(filename_.c_str(), StrCat({filename_, ".1"}).c_str());
+  }
+
+  (void)std::rename(next_filename_.c_str(), filename_.c_str());
+}
+
+void RotatingFileSink::ReleasePreallocated(const int fd) const {
+  if (options_.preallocate && options_.max_file_size != 0)
+    internal::ReleasePreallocated(fd, options_.max_file_size);
+}
+
+int RotatingFileSink::OpenNextFile() {
+  // Drops a file left by a crashed process.
+  (void)std::remove(next_filename_.c_str());
+  const auto fd = internal::OpenForAppending(next_filename_.c_str());
+  if (fd != -1 && options_.preallocate && options_.max_file_size != 0)
+    internal::Preallocate(fd, options_.max_file_size);
+  return fd;
+}
+
+}  // namespace rst
@@ -0,0 +1,134 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_LOGGER_ROTATING_FILE_SINK_H_
+#define RST_LOGGER_ROTATING_FILE_SINK_H_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "rst/logger/sink.h"
+#include "rst/macros/macros.h"
+#include "rst/not_null/not_null.h"
+#include "rst/status/status_or.h"
+#include "rst/threading/mutex.h"
+
+namespace rst {
+
+// The file sink that starts a new file when the current one grows too large or
+// gets too old and keeps a limited number of the old ones. The current file is
+// |filename|, the rotated ones are |filename|.1 (the newest) to
+// |filename|.|max_files|.
+//
+// The files are written through O_APPEND descriptors and every segment has its
+// disk space reserved up front. The unused part of the reservation is released
+// when the segment is rotated out or the sink is destroyed. The next segment is
+// opened in advance as |filename|.next by a background thread, so the logging
+// thread only swaps the descriptors on rotation while the background thread
+// renames the files.
+//
+// Example:
+//
+//   RotatingFileSink::Options options;
+//   options.max_file_size = 16 * 1024 * 1024;
+//   options.max_files = 10;
+//   auto sink = RotatingFileSink::Create("log.txt", options);
+//   if (sink.err())
+//     ...
+//   Logger logger(std::move(*sink));
+//
+class RotatingFileSink : public Sink {
+ public:
+  struct Options {
+    // Zero means no rotation by size.
+    size_t max_file_size = 64 * 1024 * 1024;
+    // Zero means no rotation by time.
+    std::chrono::milliseconds rotation_period =
+        std::chrono::milliseconds::zero();
+    // Number of the rotated files to keep.
+    size_t max_files = 5;
+    // Reserves |max_file_size| bytes of disk space for every new file.
+    bool preallocate = true;
+  };
+
+  // Opens a |filename| for appending. Returns LogError on error.
+  static StatusOr<NotNull<std::unique_ptr<RotatingFileSink>>> Create(
+      NotNull<const char*> filename);
+  static StatusOr<NotNull<std::unique_ptr<RotatingFileSink>>> Create(
+      NotNull<const char*> filename, const Options& options);
+
+  // Finishes the pending rotation and stops the background thread.
+  ~RotatingFileSink() final;
+
+  // Thread safe logging function.
+  void Log(std::string_view message) final;
+
+  // Writes to the current file without rotating it.
+  void EmergencyLog(std::string_view message) final;
+
+ private:
+  RotatingFileSink(std::string&& filename, const Options& options, int fd);
+
+  // Called with |mutex_| held.
+  bool ShouldRotate(size_t message_size) const;
+
+  // Opens the next segments and renames the rotated files.
+  void RotateFiles();
+  void RenameFiles();
+  int OpenNextFile();
+
+  // Gives back the reserved space a finished segment doesn't use.
+  void ReleasePreallocated(int fd) const;
+
+  const std::string filename_;
+  const std::string next_filename_;
+  const Options options_;
+
+  Mutex mutex_{"RotatingFileSink"};
+  ConditionVariable cv_;
+  int fd_ = -1;
+  size_t file_size_ = 0;
+  std::chrono::steady_clock::time_point file_start_time_;
+  // The opened |next_filename_|, -1 until the background thread prepares it.
+  int next_fd_ = -1;
+  // The descriptor of the file to be renamed to |filename_|.1, -1 if there is
+  // no pending rotation.
+  int rotated_fd_ = -1;
+  bool should_exit_ = false;
+
+  std::thread thread_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(RotatingFileSink);
+};
+
+}  // namespace rst
+
+#endif  // RST_LOGGER_ROTATING_FILE_SINK_H_
@@ -0,0 +1,233 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/rotating_file_sink.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "rst/check/check.h"
+#include "rst/macros/macros.h"
+#include "rst/macros/os.h"
+
+#if RST_BUILDFLAG(OS_LINUX)
+#include <sys/stat.h>
+#endif
+
+namespace chrono = std::chrono;
+
+namespace rst {
+namespace {
+
+constexpr size_t kMaxFiles = 100;
+
+// Removes the file and its rotated copies.
+class File {
+ public:
+  File() { RST_CHECK(std::tmpnam(buffer_) != nullptr); }
+  ~File() {
+    std::remove(buffer_);
+    std::remove(Rotated("next").c_str());
+    for (size_t i = 1; i <= kMaxFiles; i++)
+      std::remove(Rotated(std::to_string(i)).c_str());
+  }
+
+  NotNull<const char*> FileName() const { return buffer_; }
+
+  std::string Rotated(const std::string& suffix) const {
+    return std::string(buffer_) + "." + suffix;
+  }
+
+  static bool Exists(const std::string& filename) {
+    return std::ifstream(filename).is_open();
+  }
+
+  static std::string Read(const std::string& filename) {
+    std::ifstream f(filename);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+  }
+
+  // Concatenates the rotated files from the oldest one and the current one.
+  std::string ReadAll() const {
+    std::string content;
+    for (auto i = kMaxFiles; i > 0; i--)
+      content += Read(Rotated(std::to_string(i)));
+    return content + Read(buffer_);
+  }
+
+ private:
+  char buffer_[L_tmpnam];
+
+  RST_DISALLOW_COPY_AND_ASSIGN(File);
+};
+
+// Gives the background thread time to prepare the next file.
+void LogSlowly(const NotNull<Sink*> sink, const int count,
+               const NotNull<std::string*> expected) {
+  for (auto i = 0; i < count; i++) {
+    const auto message = "Message" + std::to_string(i);
+    sink->Log(message);
+    *expected += message + "\n";
+    std::this_thread::sleep_for(chrono::milliseconds(2));
+  }
+}
+
+}  // namespace
+
+TEST(RotatingFileSink, Append) {
+  File file;
+  {
+    std::ofstream f(file.FileName().get());
+    f << "Old\n";
+  }
+
+  {
+    auto sink = RotatingFileSink::Create(file.FileName());
+    ASSERT_FALSE(sink.err());
+    (*sink)->Log("New");
+  }
+
+  EXPECT_EQ(File::Read(file.FileName().get()), "Old\nNew\n");
+  EXPECT_FALSE(File::Exists(file.Rotated("next")));
+}
+
+TEST(RotatingFileSink, RotateBySize) {
+  File file;
+  std::string expected;
+  {
+    RotatingFileSink::Options options;
+    options.max_file_size = 32;
+    options.max_files = kMaxFiles;
+    auto sink = RotatingFileSink::Create(file.FileName(), options);
+    ASSERT_FALSE(sink.err());
+    LogSlowly(sink->get(), 20, &expected);
+  }
+
+  EXPECT_EQ(file.ReadAll(), expected);
+  EXPECT_TRUE(File::Exists(file.Rotated("1")));
+  EXPECT_TRUE(File::Exists(file.Rotated("2")));
+  EXPECT_FALSE(File::Exists(file.Rotated("next")));
+  EXPECT_LE(File::Read(file.FileName().get()).size(), 32U);
+}
+
+TEST(RotatingFileSink, RotateByTime) {
+  File file;
+  std::string expected;
+  {
+    RotatingFileSink::Options options;
+    options.max_file_size = 0;
+    options.rotation_period = chrono::milliseconds(1);
+    options.max_files = kMaxFiles;
+    auto sink = RotatingFileSink::Create(file.FileName(), options);
+    ASSERT_FALSE(sink.err());
+    LogSlowly(sink->get(), 5, &expected);
+  }
+
+  EXPECT_EQ(file.ReadAll(), expected);
+  EXPECT_TRUE(File::Exists(file.Rotated("1")));
+}
+
+TEST(RotatingFileSink, MaxFiles) {
+  File file;
+  std::string expected;
+  {
+    RotatingFileSink::Options options;
+    options.max_file_size = 16;
+    options.max_files = 2;
+    auto sink = RotatingFileSink::Create(file.FileName(), options);
+    ASSERT_FALSE(sink.err());
+    LogSlowly(sink->get(), 20, &expected);
+  }
+
+  EXPECT_TRUE(File::Exists(file.Rotated("1")));
+  EXPECT_TRUE(File::Exists(file.Rotated("2")));
+  EXPECT_FALSE(File::Exists(file.Rotated("3")));
+
+  // The kept files hold the latest messages.
+  const auto content = file.ReadAll();
+  ASSERT_LE(content.size(), expected.size());
+  EXPECT_EQ(expected.substr(expected.size() - content.size()), content);
+}
+
+TEST(RotatingFileSink, NoOldFiles) {
+  File file;
+  {
+    RotatingFileSink::Options options;
+    options.max_file_size = 16;
+    options.max_files = 0;
+    auto sink = RotatingFileSink::Create(file.FileName(), options);
+    ASSERT_FALSE(sink.err());
+    std::string expected;
+    LogSlowly(sink->get(), 5, &expected);
+  }
+
+  EXPECT_FALSE(File::Exists(file.Rotated("1")));
+  EXPECT_EQ(File::Read(file.FileName().get()), "Message4\n");
+}
+
+#if RST_BUILDFLAG(OS_LINUX)
+TEST(RotatingFileSink, ReleasePreallocated) {
+  constexpr size_t kMaxFileSize = 16 * 1024 * 1024;
+
+  File file;
+  {
+    RotatingFileSink::Options options;
+    options.max_file_size = kMaxFileSize;
+    options.rotation_period = chrono::milliseconds(1);
+    options.max_files = 3;
+    auto sink = RotatingFileSink::Create(file.FileName(), options);
+    ASSERT_FALSE(sink.err());
+    std::string expected;
+    LogSlowly(sink->get(), 10, &expected);
+  }
+
+  // Neither the rotated segments nor the last one keep the reserved space.
+  for (const auto& filename :
+       {file.Rotated("1"), file.Rotated("2"),
+        std::string(file.FileName().get())}) {
+    struct ::stat st = {};
+    ASSERT_EQ(::stat(filename.c_str(), &st), 0);
+    EXPECT_LT(static_cast<size_t>(st.st_blocks) * 512, kMaxFileSize / 2);
+  }
+}
+#endif  // RST_BUILDFLAG(OS_LINUX)
+
+TEST(RotatingFileSink, OpenError) {
+  auto sink = RotatingFileSink::Create("/nonexistent/directory/file");
+  EXPECT_TRUE(sink.err());
+}
+
+}  // namespace rst
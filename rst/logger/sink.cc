@@ -31,4 +31,24 @@ namespace rst {
 
 Sink::~Sink() = default;
 
+void Sink::Emit(const LogRecord& record) { Log(record.message); }
+
+void Sink::Flush() {}
+
+void Sink::EmitAndFlush(const LogRecord& record) {
+  Emit(record);
+  Flush();
+}
+
+void Sink::LogAndFlush(const std::string_view message) {
+  LogRecord record;
+  record.level = LogLevel::kFatal;
+  record.message = message;
+  EmitAndFlush(record);
+}
+
+void Sink::EmergencyLog(std::string_view) {}
+
+void Sink::EmergencyFlush() {}
+
 }  // namespace rst
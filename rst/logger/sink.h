@@ -28,16 +28,64 @@
 #ifndef RST_LOGGER_SINK_H_
 #define RST_LOGGER_SINK_H_
 
+#include <cstddef>
 #include <string_view>
 
+#include "rst/logger/log_field.h"
+#include "rst/logger/log_level.h"
+#include "rst/not_null/not_null.h"
+
 namespace rst {
 
+// A formatted message with its metadata.
+struct LogRecord {
+  LogLevel level = LogLevel::kAll;
+  // The whole line without the trailing newline.
+  std::string_view message;
+
+  // The parts of the line for the structured sinks. Set by Logger, empty for
+  // the messages logged with Sink::Log(). They are valid only during Emit()
+  // and EmitAndFlush(), so the asynchronous sinks queue the line only.
+  Nullable<const char*> filename;
+  int line = 0;
+  // The message without the prefix, the suppressed count and the fields.
+  std::string_view text;
+  // The scoped fields from the outermost one and then the call fields.
+  Nullable<const LogField*> fields;
+  size_t field_count = 0;
+};
+
 // The interface for the logger sink.
 class Sink {
  public:
   virtual ~Sink();
 
   virtual void Log(std::string_view message) = 0;
+
+  // Logs a |record|. Sinks that don't care about the metadata implement only
+  // Log(), which is called by default.
+  virtual void Emit(const LogRecord& record);
+
+  // Makes sure all the logged messages reach their destination. Does nothing
+  // by default.
+  virtual void Flush();
+
+  // Logs a record that must not be lost, e.g. the fatal one before abort, and
+  // flushes. Calls Emit() and Flush() by default.
+  virtual void EmitAndFlush(const LogRecord& record);
+
+  // Passes |message| to EmitAndFlush() as a fatal record.
+  void LogAndFlush(std::string_view message);
+
+  // Writes anything buffered and then |message| from a signal handler, e.g.
+  // on a crash. Only async-signal-safe calls are allowed: no locks that can
+  // be held by the interrupted code, no allocation, no waiting. Concurrent
+  // logging isn't excluded. Does nothing by default, so the message is lost.
+  virtual void EmergencyLog(std::string_view message);
+
+  // Writes out the buffered messages under the EmergencyLog() rules. Does
+  // nothing by default.
+  virtual void EmergencyFlush();
 };
 
 }  // namespace rst
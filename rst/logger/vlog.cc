@@ -0,0 +1,196 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/vlog.h"
+
+#include <charconv>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rst/logger/log_error.h"
+#include "rst/no_destructor/no_destructor.h"
+#include "rst/strings/str_cat.h"
+#include "rst/threading/mutex.h"
+
+namespace rst {
+namespace internal {
+
+// Keeps the verbosity settings and the list of the resolved call sites.
+class VlogRegistry {
+ public:
+  struct Item {
+    std::string pattern;
+    int level = 0;
+  };
+
+  VlogRegistry() = default;
+
+  static VlogRegistry& Get() {
+    static NoDestructor<VlogRegistry> registry;
+    return *registry;
+  }
+
+  // Resolves the |site| verbosity if it's not done yet and returns it.
+  int Register(const NotNull<VlogSite*> site) {
+    MutexLock lock(&mutex_);
+    auto level = site->level_.load(std::memory_order_relaxed);
+    if (level != VlogSite::kUnresolved)
+      return level;
+
+    level = Resolve(site->file_);
+    site->level_.store(level, std::memory_order_relaxed);
+    site->next_ = sites_;
+    sites_ = site.get();
+    return level;
+  }
+
+  void SetLevel(const int level) {
+    MutexLock lock(&mutex_);
+    level_ = level;
+    UpdateSites();
+  }
+
+  void SetItems(std::vector<Item>&& items) {
+    MutexLock lock(&mutex_);
+    items_ = std::move(items);
+    UpdateSites();
+  }
+
+ private:
+  int Resolve(const NotNull<const char*> file) const {
+    std::string_view path = file.get();
+    const auto slash = path.find_last_of("/\\");
+    const auto dot = path.rfind('.');
+    if (dot != std::string_view::npos &&
+        (slash == std::string_view::npos || dot > slash)) {
+      path.remove_suffix(path.size() - dot);
+    }
+    const auto name =
+        slash == std::string_view::npos ? path : path.substr(slash + 1);
+
+    for (const auto& item : items_) {
+      if (item.pattern.find_first_of("/\\") == std::string::npos) {
+        if (MatchVlogPattern(item.pattern, name))
+          return item.level;
+        continue;
+      }
+
+      // Tries every suffix that starts with a directory.
+      for (size_t start = 0; start != std::string_view::npos;) {
+        if (MatchVlogPattern(item.pattern, path.substr(start)))
+          return item.level;
+        start = path.find_first_of("/\\", start);
+        if (start != std::string_view::npos)
+          start++;
+      }
+    }
+
+    return level_;
+  }
+
+  void UpdateSites() {
+    for (auto site = sites_; site != nullptr; site = site->next_)
+      site->level_.store(Resolve(site->file_), std::memory_order_relaxed);
+  }
+
+  Mutex mutex_{"VlogRegistry"};
+  int level_ = 0;
+  std::vector<Item> items_;
+  // The intrusive list of the resolved sites.
+  VlogSite* sites_ = nullptr;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(VlogRegistry);
+};
+
+bool VlogSite::IsOnSlow(const int verbose_level) {
+  auto level = level_.load(std::memory_order_relaxed);
+  if (level == kUnresolved)
+    level = VlogRegistry::Get().Register(this);
+  return level >= verbose_level;
+}
+
+bool MatchVlogPattern(const std::string_view pattern,
+                      const std::string_view str) {
+  // Greedy matching that backtracks to the last '*' only.
+  size_t p = 0;
+  size_t s = 0;
+  auto star = std::string_view::npos;
+  size_t star_match = 0;
+  while (s < str.size()) {
+    if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == str[s])) {
+      p++;
+      s++;
+    } else if (p < pattern.size() && pattern[p] == '*') {
+      star = p++;
+      star_match = s;
+    } else if (star != std::string_view::npos) {
+      p = star + 1;
+      s = ++star_match;
+    } else {
+      return false;
+    }
+  }
+
+  while (p < pattern.size() && pattern[p] == '*')
+    p++;
+  return p == pattern.size();
+}
+
+}  // namespace internal
+
+void SetVlogLevel(const int level) {
+  internal::VlogRegistry::Get().SetLevel(level);
+}
+
+Status SetVModule(std::string_view vmodule) {
+  std::vector<internal::VlogRegistry::Item> items;
+  while (!vmodule.empty()) {
+    const auto comma = vmodule.find(',');
+    const auto item = vmodule.substr(0, comma);
+    vmodule.remove_prefix(comma == std::string_view::npos ? vmodule.size()
+                                                          : comma + 1);
+
+    const auto equal = item.rfind('=');
+    if (equal == std::string_view::npos || equal == 0)
+      return MakeStatus<LogError>(StrCat({"Invalid vmodule item: ", item}));
+
+    const auto level_str = item.substr(equal + 1);
+    int level = 0;
+    const auto end = level_str.data() + level_str.size();
+    const auto [ptr, ec] = std::from_chars(level_str.data(), end, level);
+    if (ec != std::errc() || ptr != end || level_str.empty())
+      return MakeStatus<LogError>(StrCat({"Invalid vmodule level: ", item}));
+
+    items.push_back({std::string(item.substr(0, equal)), level});
+  }
+
+  internal::VlogRegistry::Get().SetItems(std::move(items));
+  return Status::OK();
+}
+
+}  // namespace rst
@@ -0,0 +1,95 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_LOGGER_VLOG_H_
+#define RST_LOGGER_VLOG_H_
+
+#include <atomic>
+#include <climits>
+#include <string_view>
+
+#include "rst/macros/macros.h"
+#include "rst/macros/optimization.h"
+#include "rst/not_null/not_null.h"
+#include "rst/status/status.h"
+
+namespace rst {
+
+// Sets the verbosity of the files not matched by any SetVModule() pattern.
+// Default is 0, so only RST_VLOG(0, ...) is logged.
+void SetVlogLevel(int level);
+
+// Sets the per-file verbosity from a comma separated list of
+// "<pattern>=<level>" items, e.g. "task_runner*=2,net/*=1". A pattern without
+// slashes matches the file name without the directory and the extension, a
+// pattern with slashes matches the trailing directories and the file name
+// without the extension. '*' matches any sequence and '?' any single
+// character. The first matching item wins.
+// An empty |vmodule| removes all the patterns. Can be called at any time,
+// the call sites that ran before are updated.
+Status SetVModule(std::string_view vmodule);
+
+namespace internal {
+
+// The per call site state of RST_VLOG. It's a constant initialized static
+// that caches the verbosity resolved for its file, so a disabled call costs
+// a single relaxed load and compare however many patterns are set. The site
+// is resolved and registered on its first call, the registered sites are
+// updated by SetVlogLevel() and SetVModule().
+class VlogSite {
+ public:
+  explicit constexpr VlogSite(const char* file) : file_(file) {}
+
+  bool IsOn(const int verbose_level) {
+    if (RST_LIKELY(level_.load(std::memory_order_relaxed) < verbose_level))
+      return false;
+    return IsOnSlow(verbose_level);
+  }
+
+ private:
+  friend class VlogRegistry;
+
+  // Larger than any verbosity, so the first call takes the slow path.
+  static constexpr int kUnresolved = INT_MAX;
+
+  bool IsOnSlow(int verbose_level);
+
+  const char* const file_;
+  std::atomic<int> level_{kUnresolved};
+  // The next registered site, guarded by the registry mutex.
+  VlogSite* next_ = nullptr;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(VlogSite);
+};
+
+// Matches |str| against a |pattern| with '*' and '?' wildcards.
+bool MatchVlogPattern(std::string_view pattern, std::string_view str);
+
+}  // namespace internal
+}  // namespace rst
+
+#endif  // RST_LOGGER_VLOG_H_
@@ -0,0 +1,151 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/logger/vlog.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "rst/logger/logger.h"
+#include "rst/macros/macros.h"
+
+namespace rst {
+namespace {
+
+class CollectingSink : public Sink {
+ public:
+  explicit CollectingSink(const NotNull<std::vector<std::string>*> messages)
+      : messages_(messages) {}
+
+  void Log(const std::string_view message) final {
+    messages_->emplace_back(message);
+  }
+
+ private:
+  const NotNull<std::vector<std::string>*> messages_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(CollectingSink);
+};
+
+// Restores the default verbosity after a test.
+class VlogTest : public testing::Test {
+ protected:
+  ~VlogTest() override {
+    SetVlogLevel(0);
+    RST_CHECK(!SetVModule("").err());
+  }
+};
+
+void LogVerbose(const int verbose_level) {
+  RST_VLOG(verbose_level, "Verbose {}", verbose_level);
+}
+
+}  // namespace
+
+TEST(Vlog, MatchPattern) {
+  EXPECT_TRUE(internal::MatchVlogPattern("", ""));
+  EXPECT_TRUE(internal::MatchVlogPattern("*", ""));
+  EXPECT_TRUE(internal::MatchVlogPattern("*", "task_runner"));
+  EXPECT_TRUE(internal::MatchVlogPattern("task_runner*", "task_runner"));
+  EXPECT_TRUE(internal::MatchVlogPattern("task_runner*", "task_runner_test"));
+  EXPECT_TRUE(internal::MatchVlogPattern("*runner*", "task_runner_test"));
+  EXPECT_TRUE(internal::MatchVlogPattern("t?sk", "task"));
+  EXPECT_TRUE(internal::MatchVlogPattern("a*b*c", "aXbYbZc"));
+  EXPECT_FALSE(internal::MatchVlogPattern("", "task"));
+  EXPECT_FALSE(internal::MatchVlogPattern("task", "task_runner"));
+  EXPECT_FALSE(internal::MatchVlogPattern("t?sk", "tsk"));
+  EXPECT_FALSE(internal::MatchVlogPattern("a*b*c", "aXbYbZ"));
+}
+
+TEST_F(VlogTest, InvalidVModule) {
+  EXPECT_TRUE(SetVModule("vlog_test").err());
+  EXPECT_TRUE(SetVModule("=1").err());
+  EXPECT_TRUE(SetVModule("vlog_test=").err());
+  EXPECT_TRUE(SetVModule("vlog_test=x").err());
+  EXPECT_TRUE(SetVModule("vlog_test=1x").err());
+  EXPECT_TRUE(SetVModule("a=1,,b=2").err());
+  EXPECT_FALSE(SetVModule("a=1,vlog_*=2,net/*=-1").err());
+}
+
+TEST_F(VlogTest, Levels) {
+  std::vector<std::string> messages;
+  Logger logger(std::make_unique<CollectingSink>(&messages));
+  // Verbose messages don't depend on the logger level.
+  logger.set_level(LogLevel::kError);
+  Logger::SetGlobalLogger(&logger);
+
+  LogVerbose(0);
+  LogVerbose(1);
+  EXPECT_EQ(messages.size(), 1U);
+
+  // The resolved call site is updated.
+  SetVlogLevel(1);
+  LogVerbose(1);
+  LogVerbose(2);
+  EXPECT_EQ(messages.size(), 2U);
+
+  ASSERT_FALSE(SetVModule("other=5,vlog_t?st=2").err());
+  LogVerbose(2);
+  LogVerbose(3);
+  EXPECT_EQ(messages.size(), 3U);
+
+  // The first matching pattern wins.
+  ASSERT_FALSE(SetVModule("logger/vlog_*=3,vlog_test=0").err());
+  LogVerbose(3);
+  LogVerbose(4);
+  EXPECT_EQ(messages.size(), 4U);
+
+  ASSERT_FALSE(SetVModule("").err());
+  SetVlogLevel(-1);
+  LogVerbose(0);
+  EXPECT_EQ(messages.size(), 4U);
+
+  ASSERT_EQ(messages.size(), 4U);
+  EXPECT_EQ(messages[0].find("[DEBUG:"), 0U);
+  EXPECT_NE(messages[0].find("] Verbose 0"), std::string::npos);
+  EXPECT_NE(messages[1].find("] Verbose 1"), std::string::npos);
+  EXPECT_NE(messages[2].find("] Verbose 2"), std::string::npos);
+  EXPECT_NE(messages[3].find("] Verbose 3"), std::string::npos);
+}
+
+TEST_F(VlogTest, NewSiteAfterVModule) {
+  std::vector<std::string> messages;
+  Logger logger(std::make_unique<CollectingSink>(&messages));
+  Logger::SetGlobalLogger(&logger);
+
+  ASSERT_FALSE(SetVModule("*/logger/vlog_test=7").err());
+  RST_VLOG(7, "Message");
+  RST_VLOG(8, "Message");
+  EXPECT_EQ(messages.size(), 1U);
+}
+
+}  // namespace rst
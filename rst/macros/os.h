@@ -44,4 +44,10 @@
 #define RST_BUILDFLAG_OS_WIN() (false)
 #endif
 
+#if defined(__linux__)
+#define RST_BUILDFLAG_OS_LINUX() (true)
+#else
+#define RST_BUILDFLAG_OS_LINUX() (false)
+#endif
+
 #endif  // RST_MACROS_OS_H_
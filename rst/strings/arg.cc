@@ -27,8 +27,207 @@
 
 #include "rst/strings/arg.h"
 
+#include <algorithm>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+#include "rst/stl/resize_uninitialized.h"
+
 namespace rst {
 namespace internal {
+namespace {
+
+// Enough for a long double printed by "%.*Le" with max_digits10 significant
+// digits even if it's 128-bit.
+constexpr size_t kFloatBufferSize = 64;
+
+template <class Float>
+Float StringToFloat(const char* str) {
+  if constexpr (std::is_same<Float, float>::value) {
+    return std::strtof(str, nullptr);
+  } else if constexpr (std::is_same<Float, double>::value) {
+    return std::strtod(str, nullptr);
+  } else {
+    return std::strtold(str, nullptr);
+  }
+}
+
+std::string_view CopyFloat(const NotNull<char*> str, const size_t size,
+                           const std::string_view val) {
+  RST_DCHECK(val.size() <= size);
+  const auto length = std::min(val.size(), size);
+  std::memcpy(str.get(), val.data(), length);
+  return std::string_view(str.get(), length);
+}
+
+// Replaces the decimal point of the current C locale with '.'.
+void NormalizeDecimalPoint(const NotNull<char*> str, const size_t size) {
+  const auto point = *std::localeconv()->decimal_point;
+  if (point != '.')
+    std::replace(str.get(), str.get() + size, point, '.');
+}
+
+}  // namespace
+
+template <class Float>
+std::string_view FormatShortestFloat(const NotNull<char*> str,
+                                     const size_t size, const Float val) {
+  const auto is_negative = std::signbit(val);
+  if (std::isnan(val))
+    return CopyFloat(str, size, is_negative ? "-nan" : "nan");
+  if (std::isinf(val))
+    return CopyFloat(str, size, is_negative ? "-inf" : "inf");
+
+  // Finds the smallest number of significant digits that reads back to the
+  // same value. Since more digits never break a round trip, the binary search
+  // is applicable.
+  char scientific[kFloatBufferSize];
+  auto min_digits = 1;
+  auto max_digits = std::numeric_limits<Float>::max_digits10;
+  while (min_digits < max_digits) {
+    const auto digits = min_digits + (max_digits - min_digits) / 2;
+    std::snprintf(scientific, sizeof(scientific), "%.*Le", digits - 1,
+                  static_cast<long double>(val));
+    if (StringToFloat<Float>(scientific) == val) {
+      max_digits = digits;
+    } else {
+      min_digits = digits + 1;
+    }
+  }
+  const auto bytes_written =
+      std::snprintf(scientific, sizeof(scientific), "%.*Le", min_digits - 1,
+                    static_cast<long double>(val));
+  RST_DCHECK(bytes_written > 0);
+  RST_DCHECK(static_cast<size_t>(bytes_written) < sizeof(scientific));
+
+  // Splits "-d.ddde+XX" into the significant digits and the exponent.
+  char digits[kFloatBufferSize];
+  size_t digits_size = 0;
+  const char* current = scientific;
+  for (; *current != 'e'; current++) {
+    if (*current >= '0' && *current <= '9')
+      digits[digits_size++] = *current;
+  }
+  const auto exponent = static_cast<int>(std::strtol(current + 1, nullptr, 10));
+  while (digits_size > 1 && digits[digits_size - 1] == '0')
+    digits_size--;
+
+  const auto abs_exponent = exponent < 0 ? -exponent : exponent;
+  const size_t exponent_size =
+      abs_exponent >= 1000 ? 4 : abs_exponent >= 100 ? 3 : 2;
+  const size_t scientific_size =
+      digits_size + (digits_size > 1 ? 1 : 0) + 2 + exponent_size;
+  size_t fixed_size = 0;
+  if (exponent < 0) {
+    fixed_size = digits_size + 1 + static_cast<size_t>(-exponent);
+  } else if (static_cast<size_t>(exponent) + 1 >= digits_size) {
+    fixed_size = static_cast<size_t>(exponent) + 1;
+  } else {
+    fixed_size = digits_size + 1;
+  }
+
+  char buffer[kFloatBufferSize];
+  char* output = buffer;
+  if (is_negative)
+    *output++ = '-';
+
+  // Prefers the fixed notation in case of a tie like std::to_chars().
+  if (fixed_size <= scientific_size) {
+    if (exponent < 0) {
+      *output++ = '0';
+      *output++ = '.';
+      output = std::fill_n(output, -exponent - 1, '0');
+      output = std::copy_n(digits, digits_size, output);
+    } else if (static_cast<size_t>(exponent) + 1 >= digits_size) {
+      // Integers are printed exactly without the trailing zeros shortcut.
+      const auto integer_size = std::snprintf(
+          output, sizeof(buffer) - static_cast<size_t>(output - buffer),
+          "%.0Lf", static_cast<long double>(std::fabs(val)));
+      RST_DCHECK(integer_size > 0);
+      output += integer_size;
+    } else {
+      const auto integer_size = static_cast<size_t>(exponent) + 1;
+      output = std::copy_n(digits, integer_size, output);
+      *output++ = '.';
+      output =
+          std::copy_n(digits + integer_size, digits_size - integer_size, output);
+    }
+  } else {
+    *output++ = digits[0];
+    if (digits_size > 1) {
+      *output++ = '.';
+      output = std::copy_n(digits + 1, digits_size - 1, output);
+    }
+    *output++ = 'e';
+    *output++ = exponent < 0 ? '-' : '+';
+    const auto exponent_written = std::snprintf(
+        output, sizeof(buffer) - static_cast<size_t>(output - buffer), "%02d",
+        abs_exponent);
+    RST_DCHECK(exponent_written > 0);
+    output += exponent_written;
+  }
+
+  RST_DCHECK(output < buffer + sizeof(buffer));
+  return CopyFloat(str, size,
+                   std::string_view(buffer,
+                                    static_cast<size_t>(output - buffer)));
+}
+
+std::string_view FormatFixedFloat(const NotNull<char*> str, const size_t size,
+                                  const double val, const int precision) {
+  RST_DCHECK(size != 0);
+  auto bytes_written = std::snprintf(str.get(), size, "%.*f", precision, val);
+  if (bytes_written < 0 || static_cast<size_t>(bytes_written) >= size)
+    bytes_written = std::snprintf(str.get(), size, "%.*e", precision, val);
+  RST_DCHECK(bytes_written > 0);
+  RST_DCHECK(static_cast<size_t>(bytes_written) < size);
+  const auto length =
+      std::min(static_cast<size_t>(std::max(bytes_written, 0)), size - 1);
+  NormalizeDecimalPoint(str, length);
+  return std::string_view(str.get(), length);
+}
+
+template std::string_view FormatShortestFloat(NotNull<char*> str, size_t size,
+                                              float val);
+template std::string_view FormatShortestFloat(NotNull<char*> str, size_t size,
+                                              double val);
+template std::string_view FormatShortestFloat(NotNull<char*> str, size_t size,
+                                              long double val);
+
+NotNull<std::string*> GrowForAppend(const NotNull<std::string*> output,
+                                    const size_t size,
+                                    const Nullable<const Arg*> values,
+                                    const size_t count,
+                                    const NotNull<std::string*> grown) {
+  const auto old_size = output->size();
+  auto aliased = false;
+  if (size > output->capacity() - old_size) {
+    const std::less<const char*> less;
+    const char* begin = output->data();
+    const char* end = begin + old_size;
+    for (size_t i = 0; i < count && !aliased; i++) {
+      RST_DCHECK(values != nullptr);
+      const auto data = values[i].view().data();
+      aliased = !less(data, begin) && less(data, end);
+    }
+  }
+
+  if (!aliased) {
+    StringResizeUninitialized(output, old_size + size);
+    return output;
+  }
+
+  RST_DCHECK(grown->empty());
+  grown->reserve(std::max(old_size + size, output->capacity() * 2));
+  grown->append(*output);
+  StringResizeUninitialized(grown, old_size + size);
+  return grown;
+}
 
 template std::string_view IntToString(char (&str)[Arg::kBufferSize],
                                       short val);  // NOLINT(runtime/int)
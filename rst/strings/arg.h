@@ -28,39 +28,106 @@
 #ifndef RST_STRINGS_ARG_H_
 #define RST_STRINGS_ARG_H_
 
+#include <algorithm>
+#include <charconv>
 #include <cstddef>
-#include <cstdio>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 #include <string>
 #include <string_view>
 #include <type_traits>
 
 #include "rst/check/check.h"
 #include "rst/macros/macros.h"
+#include "rst/macros/optimization.h"
 #include "rst/not_null/not_null.h"
 
 namespace rst {
+
+// Formats a floating point value with |precision| digits after the decimal
+// point, like "%.*f" does. The precision is limited by 17 digits:
+//   Format("{}", {FixedPrecision{3.14159, 2}}) == "3.14"
+struct FixedPrecision {
+  double value = 0.0;
+  int precision = 0;
+};
+
 namespace internal {
 
+inline constexpr int kMaxFixedPrecision = 17;
+
 template <class Int, size_t N>
 std::string_view IntToString(char (&str)[N], Int val);
 
+// The portable implementations of FloatToString() and FixedFloatToString()
+// for the standard libraries without floating point std::to_chars(). They
+// produce the same strings as std::to_chars() and write at most |size| chars.
+template <class Float>
+std::string_view FormatShortestFloat(NotNull<char*> str, size_t size,
+                                     Float val);
+std::string_view FormatFixedFloat(NotNull<char*> str, size_t size, double val,
+                                  int precision);
+
+// Formats |val| with the shortest representation that reads back to the same
+// value. Unlike "%g" it neither loses precision nor depends on the locale.
 template <class Float, size_t N>
-std::string_view FloatToString(char (&str)[N],
-                               const NotNull<const char*> format,
-                               const Float val) {
+std::string_view FloatToString(char (&str)[N], const Float val) {
   static_assert(std::is_floating_point<Float>::value);
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wformat-nonliteral"
-#pragma warning(push)
-#pragma warning(disable : 4774)
-  const auto bytes_written =
-      std::sprintf(str, format.get(), val);  // NOLINT(runtime/printf)
-#pragma warning(pop)
-#pragma clang diagnostic pop
-  RST_DCHECK(bytes_written > 0);
-  RST_DCHECK(static_cast<size_t>(bytes_written) < N);
-  RST_DCHECK(str[bytes_written] == '\0');
-  return std::string_view(str, static_cast<size_t>(bytes_written));
+#if defined(__cpp_lib_to_chars)
+  const auto result = std::to_chars(str, str + N, val);
+  if (RST_LIKELY(result.ec == std::errc()))
+    return std::string_view(str, static_cast<size_t>(result.ptr - str));
+#endif
+  return FormatShortestFloat(str, N, val);
+}
+
+// Formats |val| with |precision| digits after the decimal point or, if it
+// doesn't fit into |str|, in the scientific notation with the same precision.
+template <size_t N>
+std::string_view FixedFloatToString(char (&str)[N], const double val,
+                                    int precision) {
+  RST_DCHECK(precision >= 0);
+  precision = std::clamp(precision, 0, kMaxFixedPrecision);
+#if defined(__cpp_lib_to_chars)
+  auto result =
+      std::to_chars(str, str + N, val, std::chars_format::fixed, precision);
+  if (result.ec != std::errc()) {
+    result = std::to_chars(str, str + N, val, std::chars_format::scientific,
+                           precision);
+  }
+  if (RST_LIKELY(result.ec == std::errc()))
+    return std::string_view(str, static_cast<size_t>(result.ptr - str));
+#endif
+  return FormatFixedFloat(str, N, val, precision);
+}
+
+// Two digits per entry: "00", "01", ..., "99".
+inline constexpr char kDigitPairs[] =
+    "000102030405060708091011121314151617181920212223242526272829"
+    "303132333435363738394041424344454647484950515253545556575859"
+    "606162636465666768697071727374757677787980818283848586878889"
+    "90919293949596979899";
+
+inline constexpr uint64_t kPowersOf10[] = {
+    0, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+    10000000000, 100000000000, 1000000000000, 10000000000000, 100000000000000,
+    1000000000000000, 10000000000000000, 100000000000000000,
+    1000000000000000000, 10000000000000000000u};
+
+// Returns the number of decimal digits in |val|, 1 for 0.
+inline size_t CountDigits(const uint64_t val) {
+#if defined(__GNUC__) || defined(__clang__)
+  // The number of bits times log10(2) is the number of digits or one more.
+  const auto bits = static_cast<size_t>(64 - __builtin_clzll(val | 1));
+  const auto approx = (bits * 1233) >> 12;
+  return approx + 1 - static_cast<size_t>(val < kPowersOf10[approx]);
+#else
+  size_t digits = 1;
+  while (digits < std::size(kPowersOf10) && val >= kPowersOf10[digits])
+    digits++;
+  return digits;
+#endif
 }
 
 template <class Int, size_t N>
@@ -68,26 +135,48 @@ std::string_view IntToString(char (&str)[N], const Int val) {
   static_assert(std::is_integral<Int>::value);
 
   auto res = static_cast<typename std::make_unsigned<Int>::type>(val);
-
-  auto p = str + N;
-  do {
-    --p;
-    RST_DCHECK(p != str);
-    *p = static_cast<char>((res % 10) + '0');
-    res /= 10;
-  } while (res != 0);
-
+  auto p = str;
+  // Negates in the unsigned type, so the minimum value doesn't overflow.
   if (val < 0) {
-    --p;
-    RST_DCHECK(p != str);
-    *p = '-';
+    res = static_cast<decltype(res)>(0 - res);
+    *p++ = '-';
+  }
+
+  const auto end = p + CountDigits(res);
+  RST_DCHECK(end <= str + N);
+
+  // Fills the digits from the end two at a time.
+  p = end;
+  while (res >= 100) {
+    const auto pair = static_cast<size_t>(res % 100) * 2;
+    res = static_cast<decltype(res)>(res / 100);
+    p -= 2;
+    p[0] = kDigitPairs[pair];
+    p[1] = kDigitPairs[pair + 1];
   }
-  return std::string_view(p, static_cast<size_t>(str + N - p));
+  if (res >= 10) {
+    const auto pair = static_cast<size_t>(res) * 2;
+    p -= 2;
+    p[0] = kDigitPairs[pair];
+    p[1] = kDigitPairs[pair + 1];
+  } else {
+    *--p = static_cast<char>(res + '0');
+  }
+  RST_DCHECK(p == str || (p == str + 1 && *str == '-'));
+
+  return std::string_view(str, static_cast<size_t>(end - str));
 }
 
 class Arg {
  public:
-  static constexpr size_t kBufferSize = 21;
+  // Fits any 64-bit integer, the shortest long double with the sign, the point
+  // and the exponent like -1.18973149535723176502e+4932, and a fixed precision
+  // value in the scientific notation like -1.12345678901234567e-308, plus the
+  // terminating null for snprintf(). The long double digits are taken from
+  // numeric_limits since it is 80-bit on x86 and 128-bit on aarch64.
+  static constexpr size_t kBufferSize = std::max<size_t>(
+      {21, std::numeric_limits<long double>::max_digits10 + 9,
+       kMaxFixedPrecision + 9});
 
   Arg(const bool value)  // NOLINT(runtime/explicit)
       : view_(value ? "true" : "false") {}
@@ -120,13 +209,16 @@ class Arg {
       : view_(IntToString(buffer_, value)) {}
 
   Arg(const float value)  // NOLINT(runtime/explicit)
-      : view_(FloatToString(buffer_, "%g", static_cast<double>(value))) {}
+      : view_(FloatToString(buffer_, value)) {}
 
   Arg(const double value)  // NOLINT(runtime/explicit)
-      : view_(FloatToString(buffer_, "%g", value)) {}
+      : view_(FloatToString(buffer_, value)) {}
 
   Arg(const long double value)  // NOLINT(runtime/explicit)
-      : view_(FloatToString(buffer_, "%Lg", value)) {}
+      : view_(FloatToString(buffer_, value)) {}
+
+  Arg(const FixedPrecision value)  // NOLINT(runtime/explicit)
+      : view_(FixedFloatToString(buffer_, value.value, value.precision)) {}
 
   Arg(const std::string_view value)  // NOLINT(runtime/explicit)
       : view_(value) {}
@@ -155,12 +247,20 @@ class Arg {
 
  private:
   const std::string_view view_;
-  char buffer_[kBufferSize];  // Can store 2^64 - 1 that is
-                              // 18,446,744,073,709,551,615 with '\0'.
+  char buffer_[kBufferSize];
 
   RST_DISALLOW_COPY_AND_ASSIGN(Arg);
 };
 
+// Grows |output| by |size| uninitialized chars to append |values| to it and
+// returns the string to write to. It's |output| unless a value refers to
+// |output| and the string has to be reallocated. Then it's |grown|, which
+// already holds a copy of |output|, so the values stay valid while they're
+// copied, and the caller swaps it with |output| afterwards.
+NotNull<std::string*> GrowForAppend(NotNull<std::string*> output, size_t size,
+                                    Nullable<const Arg*> values, size_t count,
+                                    NotNull<std::string*> grown);
+
 extern template std::string_view IntToString(char (&str)[Arg::kBufferSize],
                                              short val);  // NOLINT(runtime/int)
 extern template std::string_view IntToString(
@@ -0,0 +1,201 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "rst/check/check.h"
+#include "rst/strings/arg.h"
+
+// Compares IntToString() with the one digit per division loop it replaced and
+// with std::to_chars(). The values have a uniformly distributed number of
+// digits, so short and long numbers are equally represented.
+//
+// Compares the shortest and the fixed precision float formatting with the
+// sprintf(3) they replaced on metric-like values.
+
+namespace rst {
+namespace {
+
+// The previous implementation.
+template <class Int, size_t N>
+std::string_view LoopIntToString(char (&str)[N], const Int val) {
+  auto res = static_cast<typename std::make_unsigned<Int>::type>(val);
+  if (val < 0)
+    res = static_cast<decltype(res)>(0 - res);
+
+  auto p = str + N;
+  do {
+    --p;
+    *p = static_cast<char>((res % 10) + '0');
+    res /= 10;
+  } while (res != 0);
+
+  if (val < 0) {
+    --p;
+    *p = '-';
+  }
+  return std::string_view(p, static_cast<size_t>(str + N - p));
+}
+
+template <class Int>
+std::vector<Int> MakeValues() {
+  std::mt19937_64 random(42);
+  std::vector<Int> values(1024);
+  const auto max_digits =
+      static_cast<size_t>(std::numeric_limits<Int>::digits10);
+  for (auto& val : values) {
+    const auto digits = 1 + random() % max_digits;
+    const auto bound = internal::kPowersOf10[digits];
+    auto unsigned_val = static_cast<Int>(random() % bound);
+    if constexpr (std::is_signed<Int>::value) {
+      if (random() % 2 == 0)
+        unsigned_val = static_cast<Int>(-unsigned_val);
+    }
+    val = unsigned_val;
+  }
+  return values;
+}
+
+template <class Int>
+void BM_IntToStringLoop(benchmark::State& state) {
+  const auto values = MakeValues<Int>();
+  char buffer[internal::Arg::kBufferSize];
+  size_t i = 0;
+  for (auto _ : state) {
+    auto view = LoopIntToString(buffer, values[i++ % values.size()]);
+    benchmark::DoNotOptimize(view);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_IntToStringLoop, int32_t);
+BENCHMARK_TEMPLATE(BM_IntToStringLoop, uint64_t);
+
+template <class Int>
+void BM_IntToString(benchmark::State& state) {
+  const auto values = MakeValues<Int>();
+  char buffer[internal::Arg::kBufferSize];
+  size_t i = 0;
+  for (auto _ : state) {
+    auto view = internal::IntToString(buffer, values[i++ % values.size()]);
+    benchmark::DoNotOptimize(view);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_IntToString, int32_t);
+BENCHMARK_TEMPLATE(BM_IntToString, uint64_t);
+
+template <class Int>
+void BM_ToChars(benchmark::State& state) {
+  const auto values = MakeValues<Int>();
+  char buffer[internal::Arg::kBufferSize];
+  size_t i = 0;
+  for (auto _ : state) {
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer),
+                                      values[i++ % values.size()]);
+    RST_DCHECK(result.ec == std::errc());
+    std::string_view view(buffer, static_cast<size_t>(result.ptr - buffer));
+    benchmark::DoNotOptimize(view);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_ToChars, int32_t);
+BENCHMARK_TEMPLATE(BM_ToChars, uint64_t);
+
+std::vector<double> MakeDoubles() {
+  std::mt19937_64 random(42);
+  std::uniform_real_distribution<double> distribution(-1000.0, 1000.0);
+  std::vector<double> values(1024);
+  for (auto& val : values)
+    val = distribution(random);
+  return values;
+}
+
+void BM_SprintfDouble(benchmark::State& state) {
+  const auto values = MakeDoubles();
+  char buffer[internal::Arg::kBufferSize];
+  size_t i = 0;
+  for (auto _ : state) {
+    const auto size = std::snprintf(buffer, sizeof(buffer), "%g",
+                                    values[i++ % values.size()]);
+    std::string_view view(buffer, static_cast<size_t>(size));
+    benchmark::DoNotOptimize(view);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SprintfDouble);
+
+void BM_FloatToString(benchmark::State& state) {
+  const auto values = MakeDoubles();
+  char buffer[internal::Arg::kBufferSize];
+  size_t i = 0;
+  for (auto _ : state) {
+    auto view = internal::FloatToString(buffer, values[i++ % values.size()]);
+    benchmark::DoNotOptimize(view);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FloatToString);
+
+void BM_SprintfFixed(benchmark::State& state) {
+  const auto values = MakeDoubles();
+  char buffer[internal::Arg::kBufferSize];
+  size_t i = 0;
+  for (auto _ : state) {
+    const auto size = std::snprintf(buffer, sizeof(buffer), "%.3f",
+                                    values[i++ % values.size()]);
+    std::string_view view(buffer, static_cast<size_t>(size));
+    benchmark::DoNotOptimize(view);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SprintfFixed);
+
+void BM_FixedFloatToString(benchmark::State& state) {
+  const auto values = MakeDoubles();
+  char buffer[internal::Arg::kBufferSize];
+  size_t i = 0;
+  for (auto _ : state) {
+    auto view = internal::FixedFloatToString(
+        buffer, values[i++ % values.size()], 3);
+    benchmark::DoNotOptimize(view);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FixedFloatToString);
+
+}  // namespace
+}  // namespace rst
@@ -0,0 +1,235 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/strings/arg.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace rst {
+namespace internal {
+namespace {
+
+template <class Int>
+void ExpectIntToString(const Int val) {
+  char buffer[Arg::kBufferSize];
+  EXPECT_EQ(IntToString(buffer, val), std::to_string(val));
+}
+
+// Checks the values around every power of ten that fits into |Int|.
+template <class Int>
+void ExpectDigitBoundaries() {
+  ExpectIntToString(std::numeric_limits<Int>::min());
+  ExpectIntToString(std::numeric_limits<Int>::max());
+  ExpectIntToString(static_cast<Int>(std::numeric_limits<Int>::max() - 1));
+  ExpectIntToString(static_cast<Int>(0));
+
+  for (uint64_t power = 1;; power *= 10) {
+    for (const auto val : {power - 1, power, power + 1}) {
+      if (val > static_cast<uint64_t>(std::numeric_limits<Int>::max()))
+        continue;
+      ExpectIntToString(static_cast<Int>(val));
+      if constexpr (std::is_signed<Int>::value)
+        ExpectIntToString(static_cast<Int>(-static_cast<Int>(val)));
+    }
+    if (power > std::numeric_limits<uint64_t>::max() / 10)
+      break;
+  }
+}
+
+template <class Float>
+std::string Shortest(const Float val) {
+  char buffer[Arg::kBufferSize];
+  return std::string(FormatShortestFloat(buffer, sizeof(buffer), val));
+}
+
+std::string Fixed(const double val, const int precision) {
+  char buffer[Arg::kBufferSize];
+  return std::string(FormatFixedFloat(buffer, sizeof(buffer), val, precision));
+}
+
+}  // namespace
+
+TEST(IntToString, CountDigits) {
+  EXPECT_EQ(CountDigits(0), 1U);
+  EXPECT_EQ(CountDigits(9), 1U);
+  EXPECT_EQ(CountDigits(10), 2U);
+  EXPECT_EQ(CountDigits(99), 2U);
+  EXPECT_EQ(CountDigits(100), 3U);
+  EXPECT_EQ(CountDigits(9999999999999999999u), 19U);
+  EXPECT_EQ(CountDigits(10000000000000000000u), 20U);
+  EXPECT_EQ(CountDigits(std::numeric_limits<uint64_t>::max()), 20U);
+}
+
+TEST(IntToString, DigitBoundaries) {
+  ExpectDigitBoundaries<short>();               // NOLINT(runtime/int)
+  ExpectDigitBoundaries<unsigned short>();      // NOLINT(runtime/int)
+  ExpectDigitBoundaries<int>();
+  ExpectDigitBoundaries<unsigned int>();
+  ExpectDigitBoundaries<long>();                // NOLINT(runtime/int)
+  ExpectDigitBoundaries<unsigned long>();       // NOLINT(runtime/int)
+  ExpectDigitBoundaries<long long>();           // NOLINT(runtime/int)
+  ExpectDigitBoundaries<unsigned long long>();  // NOLINT(runtime/int)
+}
+
+TEST(IntToString, AllShorts) {
+  for (auto i = std::numeric_limits<short>::min();  // NOLINT(runtime/int)
+       i < std::numeric_limits<short>::max(); i++) {  // NOLINT(runtime/int)
+    ExpectIntToString(i);
+  }
+}
+
+TEST(FloatToString, Shortest) {
+  EXPECT_EQ(Arg(0.0).view(), "0");
+  EXPECT_EQ(Arg(-0.0).view(), "-0");
+  EXPECT_EQ(Arg(1.0).view(), "1");
+  EXPECT_EQ(Arg(0.1).view(), "0.1");
+  EXPECT_EQ(Arg(0.1f).view(), "0.1");
+  EXPECT_EQ(Arg(1.0 / 3).view(), "0.3333333333333333");
+  EXPECT_EQ(Arg(3.14159265358979).view(), "3.14159265358979");
+  EXPECT_EQ(Arg(1e21).view(), "1e+21");
+  EXPECT_EQ(Arg(1.5e-7).view(), "1.5e-07");
+  EXPECT_EQ(Arg(10000.0).view(), "10000");
+  EXPECT_EQ(Arg(100000.0).view(), "1e+05");
+  EXPECT_EQ(Arg(0.1L).view(), "0.1");
+}
+
+TEST(FloatToString, Limits) {
+  EXPECT_EQ(Arg(std::numeric_limits<double>::lowest()).view(),
+            "-1.7976931348623157e+308");
+  EXPECT_EQ(Arg(-std::numeric_limits<double>::min()).view(),
+            "-2.2250738585072014e-308");
+  EXPECT_EQ(Arg(std::numeric_limits<double>::denorm_min()).view(), "5e-324");
+  EXPECT_EQ(Arg(std::numeric_limits<float>::max()).view(), "3.4028235e+38");
+  EXPECT_EQ(Arg(std::numeric_limits<double>::infinity()).view(), "inf");
+  EXPECT_EQ(Arg(-std::numeric_limits<double>::infinity()).view(), "-inf");
+  EXPECT_EQ(Arg(std::numeric_limits<double>::quiet_NaN()).view(), "nan");
+
+  // Must fit into the buffer.
+  (void)Arg(std::numeric_limits<long double>::lowest());
+  (void)Arg(-std::numeric_limits<long double>::min());
+}
+
+TEST(FloatToString, RoundTrip) {
+  std::mt19937_64 random(42);
+  for (auto i = 0; i < 100000; i++) {
+    const auto bits = random();
+    double val = 0.0;
+    static_assert(sizeof(val) == sizeof(bits));
+    std::memcpy(&val, &bits, sizeof(val));
+    if (!std::isfinite(val))
+      continue;
+
+    const std::string str(Arg(val).view());
+    EXPECT_EQ(std::strtod(str.c_str(), nullptr), val) << str;
+  }
+}
+
+TEST(FloatToString, Portable) {
+  EXPECT_EQ(Shortest(0.0), "0");
+  EXPECT_EQ(Shortest(-0.0), "-0");
+  EXPECT_EQ(Shortest(1.0), "1");
+  EXPECT_EQ(Shortest(0.1), "0.1");
+  EXPECT_EQ(Shortest(0.1f), "0.1");
+  EXPECT_EQ(Shortest(1.0 / 3), "0.3333333333333333");
+  EXPECT_EQ(Shortest(3.14159265358979), "3.14159265358979");
+  EXPECT_EQ(Shortest(1e21), "1e+21");
+  EXPECT_EQ(Shortest(1.5e-7), "1.5e-07");
+  EXPECT_EQ(Shortest(0.0001), "1e-04");
+  EXPECT_EQ(Shortest(0.0012), "0.0012");
+  EXPECT_EQ(Shortest(10000.0), "10000");
+  EXPECT_EQ(Shortest(100000.0), "1e+05");
+  EXPECT_EQ(Shortest(123456789012345680000.0), "123456789012345683968");
+  EXPECT_EQ(Shortest(0.1L), "0.1");
+  EXPECT_EQ(Shortest(std::numeric_limits<double>::lowest()),
+            "-1.7976931348623157e+308");
+  EXPECT_EQ(Shortest(std::numeric_limits<double>::denorm_min()), "5e-324");
+  EXPECT_EQ(Shortest(std::numeric_limits<float>::max()), "3.4028235e+38");
+  EXPECT_EQ(Shortest(-std::numeric_limits<double>::infinity()), "-inf");
+  EXPECT_EQ(Shortest(std::numeric_limits<double>::quiet_NaN()), "nan");
+  EXPECT_EQ(Shortest(std::numeric_limits<long double>::lowest()),
+            std::string(Arg(std::numeric_limits<long double>::lowest()).view()));
+}
+
+TEST(FloatToString, PortableMatchesArg) {
+  std::mt19937_64 random(42);
+  for (auto i = 0; i < 100000; i++) {
+    const auto bits = random();
+    double val = 0.0;
+    std::memcpy(&val, &bits, sizeof(val));
+    EXPECT_EQ(Shortest(val), Arg(val).view());
+
+    float float_val = 0.0f;
+    std::memcpy(&float_val, &bits, sizeof(float_val));
+    EXPECT_EQ(Shortest(float_val), Arg(float_val).view());
+
+    // Values with a few significant digits in a range where both notations
+    // are possible.
+    const auto short_val =
+        static_cast<double>(bits % 100000) * std::pow(10.0, bits % 41 - 20.0);
+    EXPECT_EQ(Shortest(short_val), Arg(short_val).view());
+  }
+}
+
+TEST(FixedPrecision, Portable) {
+  EXPECT_EQ(Fixed(3.14159, 2), "3.14");
+  EXPECT_EQ(Fixed(3.14159, 0), "3");
+  EXPECT_EQ(Fixed(-2.5, 3), "-2.500");
+  EXPECT_EQ(Fixed(1e-9, 4), "0.0000");
+  EXPECT_EQ(Fixed(1e300, 2), "1.00e+300");
+  EXPECT_EQ(Fixed(-std::numeric_limits<double>::max(), 17),
+            "-1.79769313486231571e+308");
+}
+
+TEST(FixedPrecision, Common) {
+  EXPECT_EQ(Arg(FixedPrecision{3.14159, 2}).view(), "3.14");
+  EXPECT_EQ(Arg(FixedPrecision{3.14159, 0}).view(), "3");
+  EXPECT_EQ(Arg(FixedPrecision{-2.5, 3}).view(), "-2.500");
+  EXPECT_EQ(Arg(FixedPrecision{0.0, 1}).view(), "0.0");
+  EXPECT_EQ(Arg(FixedPrecision{1e-9, 4}).view(), "0.0000");
+  EXPECT_EQ(Arg(FixedPrecision{123456789.0, 1}).view(), "123456789.0");
+}
+
+TEST(FixedPrecision, TooLong) {
+  // Doesn't fit, so falls back to the scientific notation.
+  EXPECT_EQ(Arg(FixedPrecision{1e300, 2}).view(), "1.00e+300");
+  EXPECT_EQ(Arg(FixedPrecision{-std::numeric_limits<double>::max(), 17})
+                .view(),
+            "-1.79769313486231571e+308");
+  // The precision is limited.
+  EXPECT_EQ(Arg(FixedPrecision{0.5, 100}).view(), "0.50000000000000000");
+}
+
+}  // namespace internal
+}  // namespace rst
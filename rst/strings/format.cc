@@ -29,47 +29,53 @@
 
 #include <algorithm>
 #include <cstring>
+#include <string_view>
 
 #include "rst/check/check.h"
 #include "rst/macros/optimization.h"
-#include "rst/stl/resize_uninitialized.h"
 
 namespace rst {
 namespace internal {
+namespace {
 
-std::string FormatAndReturnString(const NotNull<const char*> not_null_format,
-                                  const size_t format_size,
-                                  const Nullable<const Arg*> values,
-                                  const size_t size) {
-  auto format = not_null_format.get();
+// Copies |src| to |target| truncating it at |end|.
+char* CopyTruncated(const std::string_view src, char* target,
+                    char* const end) {
+  const auto count =
+      std::min(src.size(), static_cast<size_t>(end - target));
+  return std::copy_n(src.data(), count, target);
+}
 
-  RST_DCHECK(format_size == std::strlen(format));
+size_t FormattedSize(const size_t format_size,
+                     const Nullable<const Arg*> values, const size_t size) {
   auto new_size = format_size;
   for (size_t i = 0; i < size; i++) {
     RST_DCHECK(values != nullptr);
     new_size += values[i].size();
   }
   RST_DCHECK(new_size >= size * 2);
-  new_size -= size * 2;
-
-  std::string output;
-  StringResizeUninitialized(NotNull(&output), new_size);
+  return new_size - size * 2;
+}
 
+// Writes the formatted string to [|target|, |end|) truncating it, returns the
+// end of the written part.
+char* FormatToRange(const char* format, const Nullable<const Arg*> values,
+                    const size_t size, char* target, char* const end) {
   size_t arg_idx = 0;
-  auto target = output.data();
   for (auto c = '\0'; (c = *format) != '\0'; format++) {
     switch (c) {
       case '{': {
         switch (RST_LIKELY_EQ(*(format + 1), '}')) {
           case '{': {
             format++;
-            *target++ = '{';
+            if (target != end)
+              *target++ = '{';
             break;
           }
           case '}': {
             RST_DCHECK(arg_idx < size && "Extra arguments");
-            const auto src = values[arg_idx].view();
-            target = std::copy_n(src.data(), src.size(), target);
+            RST_DCHECK(values != nullptr);
+            target = CopyTruncated(values[arg_idx].view(), target, end);
             format++;
             arg_idx++;
             break;
@@ -84,7 +90,8 @@ std::string FormatAndReturnString(const NotNull<const char*> not_null_format,
         switch (*(format + 1)) {
           case '}': {
             format++;
-            *target++ = '}';
+            if (target != end)
+              *target++ = '}';
             break;
           }
           default: {
@@ -94,17 +101,108 @@ std::string FormatAndReturnString(const NotNull<const char*> not_null_format,
         break;
       }
       default: {
-        *target++ = c;
+        if (target != end)
+          *target++ = c;
         break;
       }
     }
   }
 
   RST_DCHECK(arg_idx == size && "Numbers of parameters should match");
+  return target;
+}
+
+char* FormatParsedToRange(const char* literals,
+                          const NotNull<const size_t*> segment_sizes,
+                          const Nullable<const Arg*> values, const size_t size,
+                          char* target, char* const end) {
+  for (size_t i = 0; i < size; i++) {
+    RST_DCHECK(values != nullptr);
+    target = CopyTruncated({literals, segment_sizes[i]}, target, end);
+    literals += segment_sizes[i];
+    target = CopyTruncated(values[i].view(), target, end);
+  }
+  return CopyTruncated({literals, segment_sizes[size]}, target, end);
+}
+
+}  // namespace
+
+void FormatAndAppend(const NotNull<std::string*> output,
+                     const NotNull<const char*> format,
+                     const size_t format_size,
+                     const Nullable<const Arg*> values, const size_t size) {
+  RST_DCHECK(format_size == std::strlen(format.get()));
+  const auto new_size = FormattedSize(format_size, values, size);
+
+  const auto old_size = output->size();
+  std::string grown;
+  const auto str = GrowForAppend(output, new_size, values, size, &grown);
+
+  const auto end = FormatToRange(format.get(), values, size,
+                                 str->data() + old_size,
+                                 str->data() + str->size());
+  str->resize(static_cast<size_t>(end - str->data()));
+  if (str != output)
+    output->swap(*str);
+}
 
-  output.resize(static_cast<size_t>(target - output.data()));
+std::string FormatAndReturnString(const NotNull<const char*> format,
+                                  const size_t format_size,
+                                  const Nullable<const Arg*> values,
+                                  const size_t size) {
+  std::string output;
+  FormatAndAppend(&output, format, format_size, values, size);
   return output;
 }
 
+std::string_view FormatToBuffer(const NotNull<char*> buffer,
+                                const size_t buffer_size,
+                                const NotNull<const char*> format,
+                                const size_t format_size,
+                                const Nullable<const Arg*> values,
+                                const size_t size) {
+  RST_DCHECK(format_size == std::strlen(format.get()));
+  const auto end = FormatToRange(format.get(), values, size, buffer.get(),
+                                 buffer.get() + buffer_size);
+  return std::string_view(buffer.get(),
+                          static_cast<size_t>(end - buffer.get()));
+}
+
+void FormatParsedAndAppend(const NotNull<std::string*> output,
+                           const NotNull<const char*> literals,
+                           const size_t literals_size,
+                           const NotNull<const size_t*> segment_sizes,
+                           const Nullable<const Arg*> values,
+                           const size_t size) {
+  auto new_size = literals_size;
+  for (size_t i = 0; i < size; i++) {
+    RST_DCHECK(values != nullptr);
+    new_size += values[i].size();
+  }
+
+  const auto old_size = output->size();
+  std::string grown;
+  const auto str = GrowForAppend(output, new_size, values, size, &grown);
+
+  const auto end = FormatParsedToRange(
+      literals.get(), segment_sizes, values, size, str->data() + old_size,
+      str->data() + str->size());
+  RST_DCHECK(end == str->data() + str->size());
+  if (str != output)
+    output->swap(*str);
+}
+
+std::string_view FormatParsedToBuffer(
+    const NotNull<char*> buffer, const size_t buffer_size,
+    const NotNull<const char*> literals,
+    const NotNull<const size_t*> segment_sizes,
+    const Nullable<const Arg*> values, const size_t size) {
+  const auto end =
+      FormatParsedToRange(literals.get(), segment_sizes, values, size,
+                          buffer.get(), buffer.get() + buffer_size);
+  return std::string_view(buffer.get(),
+                          static_cast<size_t>(end - buffer.get()));
+}
+
 }  // namespace internal
 }  // namespace rst
@@ -31,6 +31,7 @@
 #include <cstddef>
 #include <initializer_list>
 #include <string>
+#include <string_view>
 
 #include "rst/not_null/not_null.h"
 #include "rst/strings/arg.h"
@@ -60,20 +61,146 @@
 //   * std::string_view, std::string, const char*
 //   * short, unsigned short, int, unsigned int, long, unsigned long, long long,
 //     unsigned long long
-//   * float, double, long double (printed as if %g is specified for printf())
+//   * float, double, long double (printed with the shortest representation
+//     that reads back to the same value)
+//   * FixedPrecision (printed as if %.*f is specified for printf())
 //   * bool (printed as "true" or "false")
 //   * char
 //   * enums (printed as underlying integer type)
 //
 // If an invalid format string is provided, Format() asserts in a debug build.
+//
+// FormatTo() appends the formatted string to an existing one growing it at
+// most once, the arguments can refer to the string itself. FormatToBuffer()
+// writes it to a caller-provided buffer truncating it if it doesn't fit and
+// returns the written part, the arguments must not overlap the buffer:
+//   std::string s = "Result: ";
+//   FormatTo(&s, "{} purchased {} {}", {"Bob", 5, "Apples"});
+//
+//   char buffer[64];
+//   std::string_view v =
+//       FormatToBuffer(buffer, sizeof(buffer), "{} + {}", {1, 2});
+//
+// A format string wrapped into RST_FORMAT_STRING() is parsed at compile time:
+// an invalid string or a wrong number of arguments is a compile error and the
+// formatting only copies the pre-split literal segments and the arguments:
+//   std::string s = Format(RST_FORMAT_STRING("{} purchased {} {}"), "Bob", 5,
+//                          "Apples");
+
+// Makes a compile time format string from a string literal.
+#define RST_FORMAT_STRING(str)                                         \
+  ([] {                                                                \
+    struct RstFormatString {                                           \
+      static constexpr std::string_view value() { return str; }       \
+    };                                                                 \
+    return ::rst::FormatString<RstFormatString>();                     \
+  }())
+
 namespace rst {
 namespace internal {
 
+// Appends the formatted string to |output| growing it only once.
+void FormatAndAppend(NotNull<std::string*> output, NotNull<const char*> format,
+                     size_t format_size, Nullable<const Arg*> values,
+                     size_t size);
+
 std::string FormatAndReturnString(NotNull<const char*> format,
                                   size_t format_size,
                                   Nullable<const Arg*> values, size_t size);
+
+std::string_view FormatToBuffer(NotNull<char*> buffer, size_t buffer_size,
+                                NotNull<const char*> format,
+                                size_t format_size,
+                                Nullable<const Arg*> values, size_t size);
+
+// Appends the |values| interleaved with the |size| + 1 literal segments that
+// are stored one after another in |literals|.
+void FormatParsedAndAppend(NotNull<std::string*> output,
+                           NotNull<const char*> literals,
+                           size_t literals_size,
+                           NotNull<const size_t*> segment_sizes,
+                           Nullable<const Arg*> values, size_t size);
+
+std::string_view FormatParsedToBuffer(NotNull<char*> buffer,
+                                      size_t buffer_size,
+                                      NotNull<const char*> literals,
+                                      NotNull<const size_t*> segment_sizes,
+                                      Nullable<const Arg*> values,
+                                      size_t size);
+
+struct FormatCounts {
+  bool is_valid = true;
+  // The size of the literal text with "{{" and "}}" unescaped.
+  size_t literals_size = 0;
+  size_t placeholder_count = 0;
+};
+
+constexpr FormatCounts CountFormat(const std::string_view format) {
+  FormatCounts counts;
+  for (size_t i = 0; i < format.size(); i++) {
+    const auto c = format[i];
+    const auto next = i + 1 < format.size() ? format[i + 1] : '\0';
+    if (c == '{' && next == '}') {
+      counts.placeholder_count++;
+      i++;
+    } else if ((c == '{' && next == '{') || (c == '}' && next == '}')) {
+      counts.literals_size++;
+      i++;
+    } else if (c == '{' || c == '}') {
+      counts.is_valid = false;
+    } else {
+      counts.literals_size++;
+    }
+  }
+  return counts;
+}
+
+template <size_t LiteralsSize, size_t PlaceholderCount>
+struct ParsedFormat {
+  // One more to not have zero sized arrays.
+  char literals[LiteralsSize + 1] = {};
+  size_t segment_sizes[PlaceholderCount + 1] = {};
+};
+
+template <class Str>
+constexpr auto ParseFormat() {
+  constexpr auto kCounts = CountFormat(Str::value());
+  ParsedFormat<kCounts.literals_size, kCounts.placeholder_count> parsed;
+  if (!kCounts.is_valid)
+    return parsed;
+
+  const auto format = Str::value();
+  size_t literal = 0;
+  size_t segment = 0;
+  for (size_t i = 0; i < format.size(); i++) {
+    const auto c = format[i];
+    const auto next = i + 1 < format.size() ? format[i + 1] : '\0';
+    if (c == '{' && next == '}') {
+      segment++;
+      i++;
+      continue;
+    }
+    if (c == next && (c == '{' || c == '}'))
+      i++;
+    parsed.literals[literal++] = c;
+    parsed.segment_sizes[segment]++;
+  }
+  return parsed;
+}
+
 }  // namespace internal
 
+// A format string parsed at compile time, see RST_FORMAT_STRING. |Str| has a
+// static constexpr value() returning the string.
+template <class Str>
+class FormatString {
+ public:
+  static constexpr auto kCounts = internal::CountFormat(Str::value());
+  static constexpr auto kParsed = internal::ParseFormat<Str>();
+
+  static_assert(kCounts.is_valid, "Invalid format string");
+};
+
 template <size_t N>
 inline std::string Format(const char (&format)[N]) {
   return internal::FormatAndReturnString(format, N - 1, nullptr, 0);
@@ -86,6 +213,74 @@ inline std::string Format(const char (&format)[N],
                                          values.size());
 }
 
+template <size_t N>
+inline void FormatTo(const NotNull<std::string*> output,
+                     const char (&format)[N]) {
+  internal::FormatAndAppend(output, format, N - 1, nullptr, 0);
+}
+
+template <size_t N>
+inline void FormatTo(const NotNull<std::string*> output,
+                     const char (&format)[N],
+                     const std::initializer_list<internal::Arg> values) {
+  internal::FormatAndAppend(output, format, N - 1, values.begin(),
+                            values.size());
+}
+
+template <size_t N>
+inline std::string_view FormatToBuffer(
+    const NotNull<char*> buffer, const size_t buffer_size,
+    const char (&format)[N],
+    const std::initializer_list<internal::Arg> values = {}) {
+  return internal::FormatToBuffer(buffer, buffer_size, format, N - 1,
+                                  values.begin(), values.size());
+}
+
+template <class Str, class... Args>
+void FormatTo(const NotNull<std::string*> output, FormatString<Str>,
+              const Args&... args) {
+  using Parsed = FormatString<Str>;
+  static_assert(Parsed::kCounts.placeholder_count == sizeof...(Args),
+                "Numbers of placeholders and arguments should match");
+
+  if constexpr (sizeof...(Args) == 0) {
+    output->append(Parsed::kParsed.literals, Parsed::kCounts.literals_size);
+  } else {
+    const internal::Arg values[] = {args...};
+    internal::FormatParsedAndAppend(
+        output, Parsed::kParsed.literals, Parsed::kCounts.literals_size,
+        Parsed::kParsed.segment_sizes, values, sizeof...(Args));
+  }
+}
+
+template <class Str, class... Args>
+std::string_view FormatToBuffer(const NotNull<char*> buffer,
+                                const size_t buffer_size,
+                                const FormatString<Str>, const Args&... args) {
+  using Parsed = FormatString<Str>;
+  static_assert(Parsed::kCounts.placeholder_count == sizeof...(Args),
+                "Numbers of placeholders and arguments should match");
+
+  if constexpr (sizeof...(Args) == 0) {
+    return internal::FormatParsedToBuffer(buffer, buffer_size,
+                                          Parsed::kParsed.literals,
+                                          Parsed::kParsed.segment_sizes,
+                                          nullptr, 0);
+  } else {
+    const internal::Arg values[] = {args...};
+    return internal::FormatParsedToBuffer(
+        buffer, buffer_size, Parsed::kParsed.literals,
+        Parsed::kParsed.segment_sizes, values, sizeof...(Args));
+  }
+}
+
+template <class Str, class... Args>
+std::string Format(const FormatString<Str> format, const Args&... args) {
+  std::string output;
+  FormatTo(&output, format, args...);
+  return output;
+}
+
 }  // namespace rst
 
 #endif  // RST_STRINGS_FORMAT_H_
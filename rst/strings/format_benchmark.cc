@@ -0,0 +1,100 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdio>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "rst/check/check.h"
+#include "rst/strings/format.h"
+
+// Compares the format string parsed at compile time with the one scanned on
+// every call and with snprintf(3) into a std::string.
+
+namespace rst {
+namespace {
+
+void BM_FormatRuntime(benchmark::State& state) {
+  for (auto _ : state) {
+    auto str = Format("{} purchased {} {} for {}", {"Bob", 5, "Apples", 42});
+    benchmark::DoNotOptimize(str);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatRuntime);
+
+void BM_FormatCompileTime(benchmark::State& state) {
+  for (auto _ : state) {
+    auto str = Format(RST_FORMAT_STRING("{} purchased {} {} for {}"), "Bob", 5,
+                      "Apples", 42);
+    benchmark::DoNotOptimize(str);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatCompileTime);
+
+// Reuses the capacity of the string, so no allocation happens per call.
+void BM_FormatToReused(benchmark::State& state) {
+  std::string str;
+  for (auto _ : state) {
+    str.clear();
+    FormatTo(&str, "{} purchased {} {} for {}", {"Bob", 5, "Apples", 42});
+    benchmark::DoNotOptimize(str.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatToReused);
+
+void BM_FormatToBuffer(benchmark::State& state) {
+  char buffer[64];
+  for (auto _ : state) {
+    auto view = FormatToBuffer(buffer, sizeof(buffer),
+                               RST_FORMAT_STRING("{} purchased {} {} for {}"),
+                               "Bob", 5, "Apples", 42);
+    benchmark::DoNotOptimize(view);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatToBuffer);
+
+void BM_Snprintf(benchmark::State& state) {
+  for (auto _ : state) {
+    char buffer[64];
+    const auto size = std::snprintf(buffer, sizeof(buffer),
+                                    "%s purchased %d %s for %d", "Bob", 5,
+                                    "Apples", 42);
+    RST_DCHECK(size >= 0 && static_cast<size_t>(size) < sizeof(buffer));
+    std::string str(buffer, static_cast<size_t>(size));
+    benchmark::DoNotOptimize(str);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Snprintf);
+
+}  // namespace
+}  // namespace rst
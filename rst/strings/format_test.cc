@@ -142,6 +142,11 @@ TEST(Format, Numbers) {
       "012345678910");
 }
 
+TEST(Format, Negative) {
+  EXPECT_EQ(Format("{} {} {} {}", {short{-42}, -42, -42L, -42LL}),  // NOLINT
+            "-42 -42 -42 -42");
+}
+
 TEST(Format, MinMax) {
   const auto string = Format(
       "{} {} {} {} {} {} {} {} {} {} {} {} {} {} {} {} {} {} {} {} {} {}",
@@ -214,22 +219,18 @@ TEST(Format, MinMax) {
       std::numeric_limits<unsigned long long>::max());  // NOLINT(runtime/int)
   result += ' ';
 
-  std::ostringstream stream;
-  stream << std::numeric_limits<float>::min();
-  stream << ' ';
-  stream << std::numeric_limits<float>::max();
-  stream << ' ';
-  stream << std::numeric_limits<double>::min();
-  stream << ' ';
-  stream << std::numeric_limits<double>::max();
-  stream << ' ';
-  stream << std::numeric_limits<long double>::min();
-  stream << ' ';
-  stream << std::numeric_limits<long double>::max();
-
-  result += stream.str();
-
-  EXPECT_EQ(string, result);
+  // The shortest representations that read back to the same values.
+  result += "1.1754944e-38 3.4028235e+38 2.2250738585072014e-308 "
+            "1.7976931348623157e+308 ";
+  ASSERT_EQ(string.substr(0, result.size()), result);
+
+  // The long double representation depends on the platform.
+  std::istringstream stream(string.substr(result.size()));
+  long double min = 0;
+  long double max = 0;
+  ASSERT_TRUE(stream >> min >> max);
+  EXPECT_EQ(min, std::numeric_limits<long double>::min());
+  EXPECT_EQ(max, std::numeric_limits<long double>::max());
 }
 
 TEST(Format, EmptyStdString) {
@@ -340,4 +341,103 @@ TEST(Format, NotNullStr) {
   EXPECT_EQ(Format("{}", {NotNull(kStr)}), kStr);
 }
 
+TEST(Format, CompileTime) {
+  EXPECT_EQ(Format(RST_FORMAT_STRING("")), "");
+  EXPECT_EQ(Format(RST_FORMAT_STRING("test")), "test");
+  EXPECT_EQ(Format(RST_FORMAT_STRING("{}"), 1), "1");
+  EXPECT_EQ(Format(RST_FORMAT_STRING("{}{}"), "a", "b"), "ab");
+  EXPECT_EQ(Format(RST_FORMAT_STRING("{} purchased {} {}"), "Bob", 5,
+                   std::string("Apples")),
+            "Bob purchased 5 Apples");
+  EXPECT_EQ(Format(RST_FORMAT_STRING("before {} after"), 'c'),
+            "before c after");
+  EXPECT_EQ(Format(RST_FORMAT_STRING("{}"), std::string_view()), "");
+}
+
+TEST(Format, CompileTimeEscape) {
+  EXPECT_EQ(Format(RST_FORMAT_STRING("{{")), "{");
+  EXPECT_EQ(Format(RST_FORMAT_STRING("}}")), "}");
+  EXPECT_EQ(Format(RST_FORMAT_STRING("{{}}")), "{}");
+  EXPECT_EQ(Format(RST_FORMAT_STRING("{{{}}}"), 1), "{1}");
+  EXPECT_EQ(Format(RST_FORMAT_STRING("}}{}{{"), true), "}true{");
+}
+
+TEST(Format, CompileTimeMatchesRuntime) {
+  EXPECT_EQ(Format(RST_FORMAT_STRING("{} {} {} {}"), -1, 2.5, false,
+                   NotNull("abc")),
+            Format("{} {} {} {}", {-1, 2.5, false, NotNull("abc")}));
+}
+
+TEST(Format, CompileTimeParse) {
+  auto format = RST_FORMAT_STRING("a{}b{{c}}{}");
+  using Format = decltype(format);
+  static_assert(Format::kCounts.is_valid);
+  static_assert(Format::kCounts.literals_size == 5);
+  static_assert(Format::kCounts.placeholder_count == 2);
+  static_assert(Format::kParsed.segment_sizes[0] == 1);
+  static_assert(Format::kParsed.segment_sizes[1] == 4);
+  static_assert(Format::kParsed.segment_sizes[2] == 0);
+  EXPECT_EQ(std::string_view(Format::kParsed.literals), "ab{c}");
+
+  static_assert(!internal::CountFormat("{").is_valid);
+  static_assert(!internal::CountFormat("a}b").is_valid);
+  static_assert(!internal::CountFormat("{{}").is_valid);
+}
+
+TEST(FormatTo, Append) {
+  std::string str = "Result: ";
+  FormatTo(&str, "{} purchased {} {}", {"Bob", 5, "Apples"});
+  EXPECT_EQ(str, "Result: Bob purchased 5 Apples");
+  FormatTo(&str, " {{}}");
+  EXPECT_EQ(str, "Result: Bob purchased 5 Apples {}");
+}
+
+TEST(FormatTo, Self) {
+  std::string str = "0123456789abcdef";
+  FormatTo(&str, "{}", {str});
+  EXPECT_EQ(str, "0123456789abcdef0123456789abcdef");
+
+  str = "0123456789abcdef";
+  FormatTo(&str, RST_FORMAT_STRING(" {} {}"), std::string_view(str).substr(10),
+           str);
+  EXPECT_EQ(str, "0123456789abcdef abcdef 0123456789abcdef");
+}
+
+TEST(FormatTo, CompileTime) {
+  std::string str = "Result: ";
+  FormatTo(&str, RST_FORMAT_STRING("{} purchased {} {}"), "Bob", 5, "Apples");
+  EXPECT_EQ(str, "Result: Bob purchased 5 Apples");
+  FormatTo(&str, RST_FORMAT_STRING(" {{}}"));
+  EXPECT_EQ(str, "Result: Bob purchased 5 Apples {}");
+}
+
+TEST(FormatToBuffer, Fits) {
+  char buffer[32];
+  EXPECT_EQ(FormatToBuffer(buffer, sizeof(buffer), "{} + {} = {{{}}}",
+                           {1, 2, 3}),
+            "1 + 2 = {3}");
+  EXPECT_EQ(FormatToBuffer(buffer, sizeof(buffer), "test"), "test");
+  EXPECT_EQ(FormatToBuffer(buffer, sizeof(buffer), ""), "");
+}
+
+TEST(FormatToBuffer, Truncates) {
+  char buffer[6];
+  EXPECT_EQ(FormatToBuffer(buffer, sizeof(buffer), "{} + {}", {100, 200}),
+            "100 + ");
+  EXPECT_EQ(FormatToBuffer(buffer, sizeof(buffer), "{}{{}}", {"abcde"}),
+            "abcde{");
+  EXPECT_EQ(FormatToBuffer(buffer, 0, "{}", {1}), "");
+}
+
+TEST(FormatToBuffer, CompileTime) {
+  char buffer[32];
+  EXPECT_EQ(FormatToBuffer(buffer, sizeof(buffer),
+                           RST_FORMAT_STRING("{} + {} = {{{}}}"), 1, 2, 3),
+            "1 + 2 = {3}");
+  EXPECT_EQ(FormatToBuffer(buffer, sizeof(buffer), RST_FORMAT_STRING("a")),
+            "a");
+  EXPECT_EQ(FormatToBuffer(buffer, 6, RST_FORMAT_STRING("{} + {}"), 100, 200),
+            "100 + ");
+}
+
 }  // namespace rst
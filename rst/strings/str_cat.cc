@@ -32,26 +32,50 @@
 
 #include "rst/check/check.h"
 #include "rst/not_null/not_null.h"
-#include "rst/stl/resize_uninitialized.h"
 
 namespace rst {
 
-std::string StrCat(std::initializer_list<internal::Arg> values) {
+std::string StrCat(const std::initializer_list<internal::Arg> values) {
+  std::string output;
+  StrAppend(&output, values);
+  return output;
+}
+
+void StrAppend(const NotNull<std::string*> output,
+               const std::initializer_list<internal::Arg> values) {
   size_t new_size = 0;
   for (const auto& val : values)
     new_size += val.size();
 
-  std::string output;
-  StringResizeUninitialized(NotNull(&output), new_size);
+  const auto old_size = output->size();
+  std::string grown;
+  const auto target = internal::GrowForAppend(output, new_size, values.begin(),
+                                              values.size(), &grown);
 
-  auto out = output.data();
+  auto out = target->data() + old_size;
   for (const auto& val : values) {
     const auto src = val.view();
     out = std::copy_n(src.data(), src.size(), out);
   }
 
-  RST_DCHECK(out == output.data() + output.size());
-  return output;
+  RST_DCHECK(out == target->data() + target->size());
+  if (target != output)
+    output->swap(*target);
+}
+
+std::string_view StrCatToBuffer(
+    const NotNull<char*> buffer, const size_t buffer_size,
+    const std::initializer_list<internal::Arg> values) {
+  auto out = buffer.get();
+  auto left = buffer_size;
+  for (const auto& val : values) {
+    const auto src = val.view();
+    const auto count = std::min(src.size(), left);
+    out = std::copy_n(src.data(), count, out);
+    left -= count;
+  }
+
+  return std::string_view(buffer.get(), buffer_size - left);
 }
 
 }  // namespace rst
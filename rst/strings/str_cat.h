@@ -28,9 +28,12 @@
 #ifndef RST_STRINGS_STR_CAT_H_
 #define RST_STRINGS_STR_CAT_H_
 
+#include <cstddef>
 #include <initializer_list>
 #include <string>
+#include <string_view>
 
+#include "rst/not_null/not_null.h"
 #include "rst/strings/arg.h"
 
 // This component is for efficiently performing merging an arbitrary number of
@@ -49,11 +52,22 @@
 //   std::string s = StrCat({"Bob", " purchased ", 5, " ", Apples"});
 //   assert(s == "Bob purchased 5 Apples");
 //
+// StrAppend() appends to an existing string growing it at most once, the
+// arguments can refer to the string itself. StrCatToBuffer() writes to a
+// caller-provided buffer truncating the result if it doesn't fit and returns
+// the written part, the arguments must not overlap the buffer:
+//   StrAppend(&s, {" for ", 10, "$"});
+//
+//   char buffer[32];
+//   std::string_view v = StrCatToBuffer(buffer, sizeof(buffer), {"id", 42});
+//
 // Supported types:
 //   * std::string_view, std::string, const char*
 //   * short, unsigned short, int, unsigned int, long, unsigned long, long long,
 //     unsigned long long
-//   * float, double, long double (printed as if %g is specified for printf())
+//   * float, double, long double (printed with the shortest representation
+//     that reads back to the same value)
+//   * FixedPrecision (printed as if %.*f is specified for printf())
 //   * bool (printed as "true" or "false")
 //   * char
 //   * enums (printed as underlying integer type)
@@ -61,6 +75,12 @@ namespace rst {
 
 std::string StrCat(std::initializer_list<internal::Arg> values);
 
+void StrAppend(NotNull<std::string*> output,
+               std::initializer_list<internal::Arg> values);
+
+std::string_view StrCatToBuffer(NotNull<char*> buffer, size_t buffer_size,
+                                std::initializer_list<internal::Arg> values);
+
 }  // namespace rst
 
 #endif  // RST_STRINGS_STR_CAT_H_
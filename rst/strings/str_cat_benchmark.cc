@@ -0,0 +1,76 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "rst/strings/str_cat.h"
+
+// Compares building a record from several pieces with StrCat() and a string
+// concatenation against appending them to a reused string or buffer.
+
+namespace rst {
+namespace {
+
+void BM_StrCatConcatenation(benchmark::State& state) {
+  for (auto _ : state) {
+    std::string str = StrCat({"id=", 42});
+    str += StrCat({" name=", "Bob"});
+    str += StrCat({" count=", 5});
+    benchmark::DoNotOptimize(str);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StrCatConcatenation);
+
+void BM_StrAppendReused(benchmark::State& state) {
+  std::string str;
+  for (auto _ : state) {
+    str.clear();
+    StrAppend(&str, {"id=", 42});
+    StrAppend(&str, {" name=", "Bob"});
+    StrAppend(&str, {" count=", 5});
+    benchmark::DoNotOptimize(str.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StrAppendReused);
+
+void BM_StrCatToBuffer(benchmark::State& state) {
+  char buffer[64];
+  for (auto _ : state) {
+    auto view = StrCatToBuffer(buffer, sizeof(buffer),
+                               {"id=", 42, " name=", "Bob", " count=", 5});
+    benchmark::DoNotOptimize(view);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StrCatToBuffer);
+
+}  // namespace
+}  // namespace rst
@@ -181,22 +181,18 @@ TEST(StrCat, MinMax) {
       std::numeric_limits<unsigned long long>::max());  // NOLINT(runtime/int)
   result += ' ';
 
-  std::ostringstream stream;
-  stream << std::numeric_limits<float>::min();
-  stream << ' ';
-  stream << std::numeric_limits<float>::max();
-  stream << ' ';
-  stream << std::numeric_limits<double>::min();
-  stream << ' ';
-  stream << std::numeric_limits<double>::max();
-  stream << ' ';
-  stream << std::numeric_limits<long double>::min();
-  stream << ' ';
-  stream << std::numeric_limits<long double>::max();
-
-  result += stream.str();
-
-  EXPECT_EQ(string, result);
+  // The shortest representations that read back to the same values.
+  result += "1.1754944e-38 3.4028235e+38 2.2250738585072014e-308 "
+            "1.7976931348623157e+308 ";
+  ASSERT_EQ(string.substr(0, result.size()), result);
+
+  // The long double representation depends on the platform.
+  std::istringstream stream(string.substr(result.size()));
+  long double min = 0;
+  long double max = 0;
+  ASSERT_TRUE(stream >> min >> max);
+  EXPECT_EQ(min, std::numeric_limits<long double>::min());
+  EXPECT_EQ(max, std::numeric_limits<long double>::max());
 }
 
 TEST(StrCat, EmptyStdString) {
@@ -306,4 +302,62 @@ TEST(StrCat, NotNullStr) {
   EXPECT_EQ(StrCat({NotNull(kStr)}), kStr);
 }
 
+TEST(StrAppend, Empty) {
+  std::string str;
+  StrAppend(&str, {});
+  EXPECT_EQ(str, "");
+  StrAppend(&str, {"", std::string()});
+  EXPECT_EQ(str, "");
+}
+
+TEST(StrAppend, Append) {
+  std::string str = "Bob";
+  StrAppend(&str, {" purchased ", 5, ' ', "Apples"});
+  EXPECT_EQ(str, "Bob purchased 5 Apples");
+  StrAppend(&str, {" for ", 10, true});
+  EXPECT_EQ(str, "Bob purchased 5 Apples for 10true");
+}
+
+TEST(StrAppend, Big) {
+  const std::string big(1000, 'a');
+  std::string str = big;
+  StrAppend(&str, {big, big});
+  EXPECT_EQ(str, big + big + big);
+}
+
+TEST(StrAppend, Self) {
+  std::string str = "0123456789abcdef";
+  StrAppend(&str, {str});
+  EXPECT_EQ(str, "0123456789abcdef0123456789abcdef");
+
+  str = "0123456789abcdef";
+  StrAppend(&str, {std::string_view(str).substr(10), "-", str});
+  EXPECT_EQ(str, "0123456789abcdefabcdef-0123456789abcdef");
+
+  // Enough capacity, nothing is reallocated.
+  str = "abc";
+  str.reserve(100);
+  StrAppend(&str, {str, str});
+  EXPECT_EQ(str, "abcabcabc");
+}
+
+TEST(StrCatToBuffer, Fits) {
+  char buffer[32];
+  EXPECT_EQ(StrCatToBuffer(buffer, sizeof(buffer), {"id", 42, '-', -1}),
+            "id42--1");
+  EXPECT_EQ(StrCatToBuffer(buffer, sizeof(buffer), {}), "");
+}
+
+TEST(StrCatToBuffer, Exact) {
+  char buffer[4];
+  EXPECT_EQ(StrCatToBuffer(buffer, sizeof(buffer), {"ab", "cd"}), "abcd");
+}
+
+TEST(StrCatToBuffer, Truncates) {
+  char buffer[5];
+  EXPECT_EQ(StrCatToBuffer(buffer, sizeof(buffer), {"abc", 1234, "x"}),
+            "abc12");
+  EXPECT_EQ(StrCatToBuffer(buffer, 0, {"abc"}), "");
+}
+
 }  // namespace rst
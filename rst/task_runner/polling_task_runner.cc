@@ -48,7 +48,7 @@ void PollingTaskRunner::PostDelayedTask(std::function<void()>&& task,
 
   const auto now = time_function_();
   const auto future_time_point = now + delay;
-  std::lock_guard lock(mutex_);
+  MutexLock lock(&mutex_);
   queue_.emplace_back(future_time_point, task_id_, std::move(task));
   c_push_heap(queue_, std::greater<>());
   task_id_++;
@@ -56,7 +56,7 @@ void PollingTaskRunner::PostDelayedTask(std::function<void()>&& task,
 
 void PollingTaskRunner::RunPendingTasks() {
   {
-    std::lock_guard lock(mutex_);
+    MutexLock lock(&mutex_);
 
     const auto now = time_function_();
     while (!queue_.empty()) {
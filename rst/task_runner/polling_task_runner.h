@@ -31,12 +31,12 @@
 #include <chrono>
 #include <cstdint>
 #include <functional>
-#include <mutex>
 #include <vector>
 
 #include "rst/macros/macros.h"
 #include "rst/task_runner/item.h"
 #include "rst/task_runner/task_runner.h"
+#include "rst/threading/mutex.h"
 
 namespace rst {
 
@@ -69,7 +69,7 @@ class PollingTaskRunner : public TaskRunner {
   const std::function<std::chrono::milliseconds()> time_function_;
   // Used to not to allocate memory on every RunPendingTasks() call.
   std::vector<std::function<void()>> pending_tasks_;
-  std::mutex mutex_;
+  Mutex mutex_{"PollingTaskRunner"};
   // Priority queue of tasks.
   std::vector<internal::Item> queue_;
   // Increasing task counter.
@@ -31,6 +31,7 @@
 
 #include "rst/check/check.h"
 #include "rst/stl/algorithm.h"
+#include "rst/threading/notification.h"
 
 namespace chrono = std::chrono;
 
@@ -45,7 +46,7 @@ ThreadTaskRunner::InternalTaskRunner::~InternalTaskRunner() = default;
 void ThreadTaskRunner::InternalTaskRunner::WaitAndRunTasks() {
   while (true) {
     {
-      std::unique_lock lock(thread_mutex_);
+      MutexLock lock(&thread_mutex_);
 
       if (should_exit_)
         return;
@@ -55,10 +56,10 @@ void ThreadTaskRunner::InternalTaskRunner::WaitAndRunTasks() {
         const auto now = time_function_();
         if (now < item.time_point) {
           const auto wait_duration = item.time_point - now;
-          thread_cv_.wait_for(lock, wait_duration);
+          thread_cv_.WaitFor(&lock, wait_duration);
         }
       } else {
-        thread_cv_.wait(lock);
+        thread_cv_.Wait(&lock);
       }
 
       if (should_exit_)
@@ -93,28 +94,17 @@ ThreadTaskRunner::ThreadTaskRunner(
 
 ThreadTaskRunner::~ThreadTaskRunner() {
   if (thread_.joinable()) {
-    std::mutex ending_task_mutex;
-    std::condition_variable ending_task_cv;
-    auto should_continue = false;
-
-    PostTask(
-        std::bind([&ending_task_mutex, &ending_task_cv, &should_continue]() {
-          std::lock_guard lock(ending_task_mutex);
-          should_continue = true;
-          ending_task_cv.notify_one();
-        }));
-
-    std::unique_lock lock(ending_task_mutex);
-    while (!should_continue)
-      ending_task_cv.wait(lock);
+    Notification ending_task_done;
+    PostTask([&ending_task_done]() { ending_task_done.Notify(); });
+    ending_task_done.WaitForNotification();
   }
 
   {
-    std::lock_guard lock(task_runner_->thread_mutex_);
+    MutexLock lock(&task_runner_->thread_mutex_);
     task_runner_->should_exit_ = true;
   }
 
-  task_runner_->thread_cv_.notify_one();
+  task_runner_->thread_cv_.NotifyOne();
   if (thread_.joinable())
     thread_.join();
 }
@@ -126,13 +116,13 @@ void ThreadTaskRunner::PostDelayedTask(std::function<void()>&& task,
   const auto now = task_runner_->time_function_();
   const auto future_time_point = now + delay;
   {
-    std::lock_guard lock(task_runner_->thread_mutex_);
+    MutexLock lock(&task_runner_->thread_mutex_);
     task_runner_->queue_.emplace_back(future_time_point, task_runner_->task_id_,
                                       std::move(task));
     c_push_heap(task_runner_->queue_, std::greater<>());
     task_runner_->task_id_++;
   }
-  task_runner_->thread_cv_.notify_one();
+  task_runner_->thread_cv_.NotifyOne();
 }
 
 void ThreadTaskRunner::Detach() { thread_.detach(); }
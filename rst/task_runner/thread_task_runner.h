@@ -29,11 +29,9 @@
 #define RST_TASK_RUNNER_THREAD_TASK_RUNNER_H_
 
 #include <chrono>
-#include <condition_variable>
 #include <cstdint>
 #include <functional>
 #include <memory>
-#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -41,6 +39,7 @@
 #include "rst/not_null/not_null.h"
 #include "rst/task_runner/item.h"
 #include "rst/task_runner/task_runner.h"
+#include "rst/threading/mutex.h"
 
 namespace rst {
 
@@ -82,8 +81,8 @@ class ThreadTaskRunner : public TaskRunner {
     // Returns current time.
     const std::function<std::chrono::milliseconds()> time_function_;
 
-    std::mutex thread_mutex_;
-    std::condition_variable thread_cv_;
+    Mutex thread_mutex_{"ThreadTaskRunner"};
+    ConditionVariable thread_cv_;
     bool should_exit_ = false;
 
     // Priority queue of tasks.
@@ -27,32 +27,57 @@
 
 #include "rst/threading/barrier.h"
 
+#include <utility>
+
 #include "rst/check/check.h"
+#include "rst/threading/spin_pause.h"
 
 namespace rst {
 
-Barrier::Barrier(const size_t counter) : counter_(counter) {
+Barrier::Barrier(const size_t counter) : Barrier(counter, nullptr) {}
+
+Barrier::Barrier(const size_t counter, std::function<void()>&& completion)
+    : counter_(counter),
+      completion_(std::move(completion)),
+      remaining_(counter) {
   RST_DCHECK(counter > 0);
 }
 
 Barrier::~Barrier() {
-#if RST_BUILDFLAG(DCHECK_IS_ON)
-  std::lock_guard lock(mutex_);
-  RST_DCHECK(counter_ == 0);
-#endif  // RST_BUILDFLAG(DCHECK_IS_ON)
+  RST_DCHECK(remaining_.load(std::memory_order_relaxed) == counter_ &&
+             "Barrier is destroyed in the middle of a phase");
 }
 
 void Barrier::CountDownAndWait() {
-  {
-    std::unique_lock lock(mutex_);
-    RST_DCHECK(counter_ > 0);
+  const auto generation = generation_.load(std::memory_order_acquire);
+
+  const auto remaining = remaining_.fetch_sub(1, std::memory_order_acq_rel);
+  RST_DCHECK(remaining > 0);
 
-    counter_--;
-    while (counter_ != 0)
-      cv_.wait(lock);
+  if (remaining == 1) {
+    if (completion_ != nullptr)
+      completion_();
+
+    // Resets the counter before publishing the new generation, so released
+    // threads see the fresh counter when they arrive to the next phase.
+    remaining_.store(counter_, std::memory_order_relaxed);
+    {
+      MutexLock lock(&mutex_);
+      generation_.store(generation + 1, std::memory_order_release);
+    }
+    cv_.NotifyAll();
+    return;
   }
 
-  cv_.notify_one();
+  const auto is_released = [this, generation]() {
+    return generation_.load(std::memory_order_acquire) != generation;
+  };
+  if (internal::SpinUntil(is_released))
+    return;
+
+  MutexLock lock(&mutex_);
+  while (!is_released())
+    cv_.Wait(&lock);
 }
 
 }  // namespace rst
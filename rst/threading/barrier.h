@@ -28,18 +28,27 @@
 #ifndef RST_THREADING_BARRIER_H_
 #define RST_THREADING_BARRIER_H_
 
-#include <condition_variable>
+#include <atomic>
 #include <cstddef>
-#include <mutex>
+#include <cstdint>
+#include <functional>
 
 #include "rst/macros/macros.h"
+#include "rst/threading/mutex.h"
 
 namespace rst {
 
 // Provides a thread-coordination mechanism that allows a set of participating
 // threads to block until an operation is completed. The value of the counter
 // is initialized on creation. Threads block until the counter is decremented
-// to zero.
+// to zero, then all of them are released at once and the counter is reset, so
+// the barrier can be reused for the next phase.
+//
+// Optional |completion| function is called by the last arriving thread of
+// each phase before the other threads are released.
+//
+// Waiting threads spin for a short time before parking, so tight phase loops
+// usually don't enter the kernel at all.
 //
 // Example:
 //
@@ -55,17 +64,26 @@ namespace rst {
 class Barrier {
  public:
   explicit Barrier(size_t counter);
+  Barrier(size_t counter, std::function<void()>&& completion);
   ~Barrier();
 
   // Atomically decrements the internal counter by 1 and (if necessary) blocks
-  // the calling thread until the counter reaches zero. Asserts that the
-  // internal counter is already zero.
+  // the calling thread until the counter of the current phase reaches zero.
   void CountDownAndWait();
 
  private:
-  size_t counter_ = 0;
-  std::mutex mutex_;
-  std::condition_variable cv_;
+  // Number of threads participating in each phase.
+  const size_t counter_;
+  const std::function<void()> completion_;
+
+  // Number of threads that haven't arrived yet in the current phase.
+  std::atomic<size_t> remaining_;
+  // Incremented every time a phase completes.
+  std::atomic<uint32_t> generation_{0};
+
+  // Used only to park threads that have spun for too long.
+  Mutex mutex_{"Barrier"};
+  ConditionVariable cv_;
 
   RST_DISALLOW_COPY_AND_ASSIGN(Barrier);
 };
@@ -27,8 +27,8 @@
 
 #include "rst/threading/barrier.h"
 
+#include <atomic>
 #include <cstddef>
-#include <optional>
 #include <thread>
 #include <vector>
 
@@ -55,13 +55,69 @@ TEST(Barrier, Normal) {
 
 TEST(Barrier, ZeroCounter) { EXPECT_DEATH(Barrier(0), ""); }
 
-TEST(Barrier, CalledMoreTimesThanNeeded) {
-  Barrier barrier(1);
+TEST(Barrier, Reuse) {
+  static constexpr size_t kThreadNumber = 8;
+  static constexpr size_t kPhaseNumber = 1000;
 
-  barrier.CountDownAndWait();
-  EXPECT_DEATH(barrier.CountDownAndWait(), "");
+  std::atomic<size_t> counter = 0;
+  Barrier barrier(kThreadNumber);
+
+  std::vector<std::thread> threads;
+  threads.reserve(kThreadNumber);
+  for (size_t i = 0; i < kThreadNumber; i++) {
+    threads.emplace_back([&barrier, &counter]() {
+      for (size_t phase = 0; phase < kPhaseNumber; phase++) {
+        counter++;
+        barrier.CountDownAndWait();
+        // All the threads must have finished the current phase.
+        EXPECT_GE(counter.load(), (phase + 1) * kThreadNumber);
+        barrier.CountDownAndWait();
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(counter, kThreadNumber * kPhaseNumber);
 }
 
-TEST(Barrier, CalledLessTimesThanNeeded) { EXPECT_DEATH(Barrier(1), ""); }
+TEST(Barrier, Completion) {
+  static constexpr size_t kThreadNumber = 4;
+  static constexpr size_t kPhaseNumber = 100;
+
+  size_t completions = 0;
+  std::atomic<size_t> arrivals = 0;
+  Barrier barrier(kThreadNumber, [&completions, &arrivals]() {
+    completions++;
+    EXPECT_EQ(arrivals.load(), completions * kThreadNumber);
+  });
+
+  std::vector<std::thread> threads;
+  threads.reserve(kThreadNumber);
+  for (size_t i = 0; i < kThreadNumber; i++) {
+    threads.emplace_back([&barrier, &arrivals]() {
+      for (size_t phase = 0; phase < kPhaseNumber; phase++) {
+        arrivals++;
+        barrier.CountDownAndWait();
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(completions, kPhaseNumber);
+}
+
+TEST(Barrier, SingleThreadReuse) {
+  auto completions = 0;
+  Barrier barrier(1, [&completions]() { completions++; });
+
+  barrier.CountDownAndWait();
+  barrier.CountDownAndWait();
+  barrier.CountDownAndWait();
+  EXPECT_EQ(completions, 3);
+}
 
 }  // namespace rst
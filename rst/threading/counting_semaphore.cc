@@ -0,0 +1,100 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/threading/counting_semaphore.h"
+
+#include <limits>
+
+#include "rst/check/check.h"
+#include "rst/threading/futex.h"
+#include "rst/threading/spin_pause.h"
+
+namespace chrono = std::chrono;
+
+namespace rst {
+
+CountingSemaphore::CountingSemaphore(const uint32_t counter)
+    : counter_(counter) {}
+
+CountingSemaphore::~CountingSemaphore() {
+  RST_DCHECK(waiters_.load() == 0);
+}
+
+void CountingSemaphore::Release(const uint32_t n) {
+  RST_DCHECK(n > 0);
+  const auto counter = counter_.fetch_add(n);
+  RST_DCHECK(counter <= std::numeric_limits<uint32_t>::max() - n &&
+             "Semaphore counter overflow");
+  (void)counter;
+
+  if (waiters_.load() > 0)
+    internal::FutexWake(&counter_, n);
+}
+
+bool CountingSemaphore::TryAcquire() {
+  auto counter = counter_.load(std::memory_order_relaxed);
+  while (counter > 0) {
+    if (counter_.compare_exchange_weak(counter, counter - 1,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void CountingSemaphore::Acquire() {
+  if (internal::SpinUntil([this]() { return TryAcquire(); }))
+    return;
+
+  waiters_.fetch_add(1);
+  while (!TryAcquire())
+    internal::FutexWait(&counter_, 0);
+  waiters_.fetch_sub(1);
+}
+
+bool CountingSemaphore::TryAcquireFor(const chrono::nanoseconds timeout) {
+  if (internal::SpinUntil([this]() { return TryAcquire(); }))
+    return true;
+
+  const auto deadline = chrono::steady_clock::now() + timeout;
+  auto acquired = true;
+  waiters_.fetch_add(1);
+  while (!TryAcquire()) {
+    if (!internal::FutexWaitFor(&counter_, 0,
+                                deadline - chrono::steady_clock::now())) {
+      acquired = TryAcquire();
+      break;
+    }
+  }
+  waiters_.fetch_sub(1);
+
+  return acquired;
+}
+
+}  // namespace rst
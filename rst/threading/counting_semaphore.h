@@ -0,0 +1,86 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_THREADING_COUNTING_SEMAPHORE_H_
+#define RST_THREADING_COUNTING_SEMAPHORE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "rst/macros/macros.h"
+
+namespace rst {
+
+// A semaphore that maintains an internal counter of available resources.
+// Acquire() decrements the counter blocking the calling thread while it's
+// zero, Release() increments it.
+//
+// Acquiring an available resource and releasing without waiters never enter
+// the kernel.
+//
+// Example:
+//
+//   // Allows at most 4 concurrent connections.
+//   CountingSemaphore semaphore(4);
+//
+//   void Connect() {
+//     semaphore.Acquire();
+//     ...
+//     semaphore.Release();
+//   }
+//
+class CountingSemaphore {
+ public:
+  explicit CountingSemaphore(uint32_t counter);
+  ~CountingSemaphore();
+
+  // Increments the internal counter by |n| and wakes up the waiters.
+  void Release(uint32_t n = 1);
+
+  // Decrements the internal counter if it's greater than zero without
+  // blocking. Returns false if there is no available resource.
+  bool TryAcquire();
+
+  // Decrements the internal counter blocking the calling thread until it's
+  // greater than zero.
+  void Acquire();
+
+  // Like Acquire() but gives up after |timeout|. Returns false on timeout.
+  bool TryAcquireFor(std::chrono::nanoseconds timeout);
+
+ private:
+  std::atomic<uint32_t> counter_;
+  // Number of threads parked or going to be parked on |counter_|.
+  std::atomic<uint32_t> waiters_{0};
+
+  RST_DISALLOW_COPY_AND_ASSIGN(CountingSemaphore);
+};
+
+}  // namespace rst
+
+#endif  // RST_THREADING_COUNTING_SEMAPHORE_H_
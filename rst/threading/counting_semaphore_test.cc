@@ -0,0 +1,106 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/threading/counting_semaphore.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace chrono = std::chrono;
+
+namespace rst {
+
+TEST(CountingSemaphore, TryAcquire) {
+  CountingSemaphore semaphore(2);
+  EXPECT_TRUE(semaphore.TryAcquire());
+  EXPECT_TRUE(semaphore.TryAcquire());
+  EXPECT_FALSE(semaphore.TryAcquire());
+
+  semaphore.Release();
+  EXPECT_TRUE(semaphore.TryAcquire());
+  EXPECT_FALSE(semaphore.TryAcquire());
+
+  semaphore.Release(2);
+  EXPECT_TRUE(semaphore.TryAcquire());
+  EXPECT_TRUE(semaphore.TryAcquire());
+  EXPECT_FALSE(semaphore.TryAcquire());
+}
+
+TEST(CountingSemaphore, LimitsConcurrency) {
+  static constexpr size_t kThreadNumber = 10;
+  static constexpr size_t kIterationNumber = 1000;
+  static constexpr uint32_t kMaxConcurrency = 3;
+
+  CountingSemaphore semaphore(kMaxConcurrency);
+  std::atomic<uint32_t> concurrency = 0;
+
+  std::vector<std::thread> threads;
+  threads.reserve(kThreadNumber);
+  for (size_t i = 0; i < kThreadNumber; i++) {
+    threads.emplace_back([&semaphore, &concurrency]() {
+      for (size_t j = 0; j < kIterationNumber; j++) {
+        semaphore.Acquire();
+        EXPECT_LE(++concurrency, kMaxConcurrency);
+        concurrency--;
+        semaphore.Release();
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  for (uint32_t i = 0; i < kMaxConcurrency; i++)
+    EXPECT_TRUE(semaphore.TryAcquire());
+  EXPECT_FALSE(semaphore.TryAcquire());
+}
+
+TEST(CountingSemaphore, ReleaseWakesWaiter) {
+  CountingSemaphore semaphore(0);
+
+  std::thread thread([&semaphore]() { semaphore.Acquire(); });
+  semaphore.Release();
+  thread.join();
+
+  EXPECT_FALSE(semaphore.TryAcquire());
+}
+
+TEST(CountingSemaphore, TryAcquireForTimeout) {
+  CountingSemaphore semaphore(0);
+  EXPECT_FALSE(semaphore.TryAcquireFor(chrono::milliseconds(10)));
+
+  std::thread thread([&semaphore]() { semaphore.Release(); });
+  EXPECT_TRUE(semaphore.TryAcquireFor(chrono::seconds(60)));
+  thread.join();
+}
+
+}  // namespace rst
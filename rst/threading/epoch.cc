@@ -0,0 +1,118 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/threading/epoch.h"
+
+#include <thread>
+
+#include "rst/check/check.h"
+
+namespace rst {
+namespace internal {
+
+// Starts from 1 since 0 marks quiescent records.
+std::atomic<uint64_t> g_global_epoch{1};
+
+namespace {
+
+std::atomic<EpochRecord*> g_records{nullptr};
+
+NotNull<EpochRecord*> AcquireRecord() {
+  for (auto record = g_records.load(std::memory_order_acquire);
+       record != nullptr; record = record->next) {
+    auto in_use = false;
+    if (record->in_use.compare_exchange_strong(in_use, true))
+      return record;
+  }
+
+  auto record = new EpochRecord;
+  record->in_use.store(true, std::memory_order_relaxed);
+  record->next = g_records.load(std::memory_order_relaxed);
+  while (!g_records.compare_exchange_weak(record->next, record,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+  }
+
+  return record;
+}
+
+// Returns the record to the pool when the thread exits.
+class ThreadRecord {
+ public:
+  ThreadRecord() = default;
+  ~ThreadRecord() {
+    if (record_ == nullptr)
+      return;
+
+    RST_DCHECK(record_->nesting == 0);
+    record_->in_use.store(false, std::memory_order_release);
+  }
+
+  NotNull<EpochRecord*> get() {
+    if (record_ == nullptr)
+      record_ = AcquireRecord().get();
+    return record_;
+  }
+
+ private:
+  EpochRecord* record_ = nullptr;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(ThreadRecord);
+};
+
+}  // namespace
+
+NotNull<EpochRecord*> GetThreadEpochRecord() {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+  thread_local ThreadRecord record;
+#pragma clang diagnostic pop
+  return record.get();
+}
+
+void EpochSynchronize() {
+  // Checked in release too: waiting inside of a read-side critical section
+  // deadlocks, and this is only on the writer path.
+  RST_CHECK(GetThreadEpochRecord()->nesting == 0 &&
+            "Can't wait for readers inside of a read-side critical section");
+
+  const auto epoch = g_global_epoch.fetch_add(1) + 1;
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  for (auto record = g_records.load(std::memory_order_acquire);
+       record != nullptr; record = record->next) {
+    while (true) {
+      const auto record_epoch = record->epoch.load(std::memory_order_acquire);
+      if (record_epoch == 0 || record_epoch >= epoch)
+        break;
+      std::this_thread::yield();
+    }
+  }
+}
+
+}  // namespace internal
+}  // namespace rst
@@ -0,0 +1,95 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_THREADING_EPOCH_H_
+#define RST_THREADING_EPOCH_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "rst/macros/macros.h"
+#include "rst/not_null/not_null.h"
+#include "rst/threading/cache_line.h"
+
+// Epoch-based reclamation shared by all the read-mostly containers.
+//
+// A reader announces the global epoch in its own per-thread record while it
+// holds pointers to shared data. A writer unlinks old data, advances the
+// global epoch and waits until every record is either quiescent or has
+// observed the new epoch. After that no reader can hold the old data.
+namespace rst {
+namespace internal {
+
+// Each record occupies its own cache line, so readers write only to memory
+// nobody else writes to.
+struct alignas(kCacheLineSize) EpochRecord {
+  // Zero while the owning thread is outside of a read-side critical section.
+  std::atomic<uint64_t> epoch{0};
+  // Accessed by the owning thread only.
+  uint32_t nesting = 0;
+  // Records are never freed, they are reused by new threads.
+  std::atomic<bool> in_use{false};
+  // Immutable after the record is published.
+  EpochRecord* next = nullptr;
+};
+
+extern std::atomic<uint64_t> g_global_epoch;
+
+// Returns the record of the calling thread.
+NotNull<EpochRecord*> GetThreadEpochRecord();
+
+// Blocks until all the read-side critical sections that have started before
+// the call finish. Must not be called inside of a read-side critical section.
+void EpochSynchronize();
+
+// Read-side critical section. Can be nested.
+class EpochGuard {
+ public:
+  EpochGuard() : record_(GetThreadEpochRecord()) {
+    if (record_->nesting++ != 0)
+      return;
+
+    record_->epoch.store(g_global_epoch.load(), std::memory_order_relaxed);
+    // Orders the announcement before the following reads of shared pointers.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  ~EpochGuard() {
+    if (--record_->nesting == 0)
+      record_->epoch.store(0, std::memory_order_release);
+  }
+
+ private:
+  const NotNull<EpochRecord*> record_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(EpochGuard);
+};
+
+}  // namespace internal
+}  // namespace rst
+
+#endif  // RST_THREADING_EPOCH_H_
@@ -0,0 +1,102 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_THREADING_EVENT_COUNT_H_
+#define RST_THREADING_EVENT_COUNT_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "rst/macros/macros.h"
+#include "rst/threading/futex.h"
+
+namespace rst {
+namespace internal {
+
+// Lets lock-free data structures park threads waiting for a condition without
+// adding syscalls to the non-blocking paths. Notifying without waiters costs a
+// fence and a load.
+//
+// Example:
+//
+//   while (!TryPop(&value)) {
+//     const auto key = not_empty.PrepareWait();
+//     if (TryPop(&value)) {
+//       not_empty.CancelWait();
+//       break;
+//     }
+//     not_empty.Wait(key);
+//   }
+//
+//   // Producer.
+//   TryPush(value);
+//   not_empty.NotifyAll();
+//
+class EventCount {
+ public:
+  EventCount() = default;
+  ~EventCount() = default;
+
+  // Registers the calling thread as a waiter. The condition must be rechecked
+  // after this call and before Wait().
+  uint32_t PrepareWait() {
+    waiters_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return epoch_.load();
+  }
+
+  // Unregisters the calling thread if the condition became true.
+  void CancelWait() { waiters_.fetch_sub(1); }
+
+  // Blocks until NotifyAll() is called after PrepareWait() has returned |key|.
+  void Wait(const uint32_t key) {
+    while (epoch_.load() == key)
+      FutexWait(&epoch_, key);
+    waiters_.fetch_sub(1);
+  }
+
+  // Wakes up all the waiters if there are any.
+  void NotifyAll() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) == 0)
+      return;
+
+    epoch_.fetch_add(1);
+    FutexWakeAll(&epoch_);
+  }
+
+ private:
+  std::atomic<uint32_t> epoch_{0};
+  std::atomic<uint32_t> waiters_{0};
+
+  RST_DISALLOW_COPY_AND_ASSIGN(EventCount);
+};
+
+}  // namespace internal
+}  // namespace rst
+
+#endif  // RST_THREADING_EVENT_COUNT_H_
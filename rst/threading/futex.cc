@@ -0,0 +1,164 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/threading/futex.h"
+
+#include <limits>
+
+#include "rst/check/check.h"
+#include "rst/macros/macros.h"
+#include "rst/macros/os.h"
+
+#if RST_BUILDFLAG(OS_LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <ctime>
+#else
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+
+#include "rst/no_destructor/no_destructor.h"
+#endif  // RST_BUILDFLAG(OS_LINUX)
+
+namespace chrono = std::chrono;
+
+namespace rst {
+namespace internal {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+#if RST_BUILDFLAG(OS_LINUX)
+
+namespace {
+
+long Futex(const NotNull<std::atomic<uint32_t>*> address, const int op,
+           const uint32_t value, const Nullable<const timespec*> timeout) {
+  return syscall(SYS_futex, reinterpret_cast<uint32_t*>(address.get()), op,
+                 value, timeout.get(), nullptr, 0);
+}
+
+}  // namespace
+
+void FutexWait(const NotNull<std::atomic<uint32_t>*> address,
+               const uint32_t expected) {
+  (void)Futex(address, FUTEX_WAIT_PRIVATE, expected, nullptr);
+}
+
+bool FutexWaitFor(const NotNull<std::atomic<uint32_t>*> address,
+                  const uint32_t expected, const chrono::nanoseconds timeout) {
+  if (timeout <= chrono::nanoseconds::zero())
+    return false;
+
+  const auto seconds = chrono::duration_cast<chrono::seconds>(timeout);
+  timespec ts = {};
+  ts.tv_sec = static_cast<time_t>(seconds.count());
+  ts.tv_nsec = static_cast<long>((timeout - seconds).count());  // NOLINT(*)
+
+  const auto result = Futex(address, FUTEX_WAIT_PRIVATE, expected, &ts);
+  return !(result == -1 && errno == ETIMEDOUT);
+}
+
+void FutexWake(const NotNull<std::atomic<uint32_t>*> address,
+               const uint32_t count) {
+  RST_DCHECK(count > 0);
+  const auto max_count =
+      static_cast<uint32_t>(std::numeric_limits<int>::max());
+  (void)Futex(address, FUTEX_WAKE_PRIVATE, count < max_count ? count : max_count,
+              nullptr);
+}
+
+void FutexWakeAll(const NotNull<std::atomic<uint32_t>*> address) {
+  FutexWake(address, std::numeric_limits<uint32_t>::max());
+}
+
+#else  // RST_BUILDFLAG(OS_LINUX)
+
+namespace {
+
+// Waiters on different addresses can share a bucket, so wakers always notify
+// all of its waiters and let them recheck their values.
+struct Bucket {
+  std::mutex mutex;
+  std::condition_variable cv;
+};
+
+constexpr size_t kBucketNumber = 64;
+
+Bucket& GetBucket(const NotNull<std::atomic<uint32_t>*> address) {
+  static NoDestructor<std::array<Bucket, kBucketNumber>> buckets;
+  const auto hash = std::hash<const void*>()(address.get());
+  return (*buckets)[hash % kBucketNumber];
+}
+
+}  // namespace
+
+void FutexWait(const NotNull<std::atomic<uint32_t>*> address,
+               const uint32_t expected) {
+  auto& bucket = GetBucket(address);
+  std::unique_lock lock(bucket.mutex);
+  if (address->load() == expected)
+    bucket.cv.wait(lock);
+}
+
+bool FutexWaitFor(const NotNull<std::atomic<uint32_t>*> address,
+                  const uint32_t expected, const chrono::nanoseconds timeout) {
+  if (timeout <= chrono::nanoseconds::zero())
+    return false;
+
+  auto& bucket = GetBucket(address);
+  std::unique_lock lock(bucket.mutex);
+  if (address->load() != expected)
+    return true;
+
+  return bucket.cv.wait_for(lock, timeout) == std::cv_status::no_timeout;
+}
+
+void FutexWake(const NotNull<std::atomic<uint32_t>*> address,
+               const uint32_t count) {
+  RST_DCHECK(count > 0);
+  FutexWakeAll(address);
+}
+
+void FutexWakeAll(const NotNull<std::atomic<uint32_t>*> address) {
+  auto& bucket = GetBucket(address);
+  {
+    std::lock_guard lock(bucket.mutex);
+  }
+  bucket.cv.notify_all();
+}
+
+#endif  // RST_BUILDFLAG(OS_LINUX)
+
+}  // namespace internal
+}  // namespace rst
@@ -0,0 +1,61 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_THREADING_FUTEX_H_
+#define RST_THREADING_FUTEX_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "rst/not_null/not_null.h"
+
+// Thin wrappers around Linux futexes used to build the synchronization
+// primitives. On other platforms futexes are emulated by a hashed table of
+// mutexes and condition variables.
+namespace rst {
+namespace internal {
+
+// Blocks the calling thread while |*address| is equal to |expected|. Can
+// return spuriously, so the caller must recheck its condition.
+void FutexWait(NotNull<std::atomic<uint32_t>*> address, uint32_t expected);
+
+// Like FutexWait() but gives up after |timeout|. Returns false only if the
+// timeout has expired.
+bool FutexWaitFor(NotNull<std::atomic<uint32_t>*> address, uint32_t expected,
+                  std::chrono::nanoseconds timeout);
+
+// Wakes up at most |count| threads blocked on |address|.
+void FutexWake(NotNull<std::atomic<uint32_t>*> address, uint32_t count);
+
+// Wakes up all the threads blocked on |address|.
+void FutexWakeAll(NotNull<std::atomic<uint32_t>*> address);
+
+}  // namespace internal
+}  // namespace rst
+
+#endif  // RST_THREADING_FUTEX_H_
@@ -0,0 +1,82 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/threading/latch.h"
+
+#include "rst/check/check.h"
+#include "rst/threading/futex.h"
+#include "rst/threading/spin_pause.h"
+
+namespace chrono = std::chrono;
+
+namespace rst {
+
+Latch::Latch(const uint32_t counter) : counter_(counter) {}
+
+Latch::~Latch() = default;
+
+void Latch::CountDown(const uint32_t n) {
+  const auto counter = counter_.fetch_sub(n);
+  RST_DCHECK(counter >= n && "Latch counter went below zero");
+  if (counter == n && has_waiters_.load())
+    internal::FutexWakeAll(&counter_);
+}
+
+void Latch::Wait() {
+  if (internal::SpinUntil([this]() { return TryWait(); }))
+    return;
+
+  has_waiters_.store(true);
+  for (auto counter = counter_.load(); counter != 0;
+       counter = counter_.load()) {
+    internal::FutexWait(&counter_, counter);
+  }
+}
+
+bool Latch::WaitFor(const chrono::nanoseconds timeout) {
+  if (internal::SpinUntil([this]() { return TryWait(); }))
+    return true;
+
+  const auto deadline = chrono::steady_clock::now() + timeout;
+  has_waiters_.store(true);
+  for (auto counter = counter_.load(); counter != 0;
+       counter = counter_.load()) {
+    if (!internal::FutexWaitFor(&counter_, counter,
+                                deadline - chrono::steady_clock::now())) {
+      return TryWait();
+    }
+  }
+
+  return true;
+}
+
+void Latch::ArriveAndWait(const uint32_t n) {
+  CountDown(n);
+  Wait();
+}
+
+}  // namespace rst
@@ -0,0 +1,93 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_THREADING_LATCH_H_
+#define RST_THREADING_LATCH_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "rst/macros/macros.h"
+
+namespace rst {
+
+// A single-use downward counter that blocks threads until it reaches zero.
+// Unlike Barrier, the threads that count down don't have to wait.
+//
+// Counting down and waiting on an already released latch never enter the
+// kernel.
+//
+// Example:
+//
+//   Latch latch(5);
+//
+//   std::vector<std::thread> threads;
+//   for (auto i = 0; i < 5; i++)
+//     threads.emplace_back([&latch]() {
+//       Init();
+//       latch.CountDown();
+//       ...
+//     });
+//
+//   latch.Wait();
+//   // All the threads have been initialized.
+//
+class Latch {
+ public:
+  explicit Latch(uint32_t counter);
+  ~Latch();
+
+  // Atomically decrements the internal counter by |n| without blocking.
+  // Asserts that the counter doesn't go below zero.
+  void CountDown(uint32_t n = 1);
+
+  // Returns true if the internal counter has reached zero.
+  bool TryWait() const {
+    return counter_.load(std::memory_order_acquire) == 0;
+  }
+
+  // Blocks the calling thread until the internal counter reaches zero.
+  void Wait();
+
+  // Like Wait() but gives up after |timeout|. Returns false on timeout.
+  bool WaitFor(std::chrono::nanoseconds timeout);
+
+  // Like CountDown(n) followed by Wait().
+  void ArriveAndWait(uint32_t n = 1);
+
+ private:
+  std::atomic<uint32_t> counter_;
+  // Set when at least one thread is going to be parked.
+  std::atomic<bool> has_waiters_{false};
+
+  RST_DISALLOW_COPY_AND_ASSIGN(Latch);
+};
+
+}  // namespace rst
+
+#endif  // RST_THREADING_LATCH_H_
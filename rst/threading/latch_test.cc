@@ -0,0 +1,118 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/threading/latch.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace chrono = std::chrono;
+
+namespace rst {
+
+TEST(Latch, Normal) {
+  static constexpr size_t kThreadNumber = 10;
+
+  std::atomic<size_t> counter = 0;
+  Latch latch(kThreadNumber);
+
+  std::vector<std::thread> threads;
+  threads.reserve(kThreadNumber);
+  for (size_t i = 0; i < kThreadNumber; i++) {
+    threads.emplace_back([&latch, &counter]() {
+      counter++;
+      latch.CountDown();
+    });
+  }
+
+  latch.Wait();
+  EXPECT_EQ(counter, kThreadNumber);
+  EXPECT_TRUE(latch.TryWait());
+
+  for (auto& thread : threads)
+    thread.join();
+}
+
+TEST(Latch, ArriveAndWait) {
+  static constexpr size_t kThreadNumber = 10;
+
+  std::atomic<size_t> counter = 0;
+  Latch latch(kThreadNumber);
+
+  std::vector<std::thread> threads;
+  threads.reserve(kThreadNumber);
+  for (size_t i = 0; i < kThreadNumber; i++) {
+    threads.emplace_back([&latch, &counter]() {
+      counter++;
+      latch.ArriveAndWait();
+      EXPECT_EQ(counter.load(), kThreadNumber);
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+}
+
+TEST(Latch, CountDownByMany) {
+  Latch latch(5);
+  EXPECT_FALSE(latch.TryWait());
+
+  latch.CountDown(3);
+  EXPECT_FALSE(latch.TryWait());
+
+  latch.CountDown(2);
+  EXPECT_TRUE(latch.TryWait());
+  latch.Wait();
+}
+
+TEST(Latch, Zero) {
+  Latch latch(0);
+  EXPECT_TRUE(latch.TryWait());
+  latch.Wait();
+  EXPECT_TRUE(latch.WaitFor(chrono::milliseconds(0)));
+}
+
+TEST(Latch, WaitForTimeout) {
+  Latch latch(1);
+  EXPECT_FALSE(latch.WaitFor(chrono::milliseconds(10)));
+
+  std::thread thread([&latch]() { latch.CountDown(); });
+  EXPECT_TRUE(latch.WaitFor(chrono::seconds(60)));
+  thread.join();
+}
+
+TEST(Latch, CountDownBelowZero) {
+  Latch latch(1);
+  EXPECT_DEATH(latch.CountDown(2), "");
+}
+
+}  // namespace rst
@@ -0,0 +1,255 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_THREADING_MPMC_RING_H_
+#define RST_THREADING_MPMC_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "rst/check/check.h"
+#include "rst/macros/macros.h"
+#include "rst/not_null/not_null.h"
+#include "rst/threading/cache_line.h"
+#include "rst/threading/event_count.h"
+#include "rst/threading/ring_slot.h"
+#include "rst/threading/spin_pause.h"
+
+namespace rst {
+
+// Bounded lock-free multi-producer multi-consumer queue by Dmitry Vyukov. Each
+// slot carries a sequence number that tells whether it's ready to be written
+// or read on the current lap, so producers and consumers contend only on
+// their own index.
+//
+// Try* methods never block. Push() and Pop() spin for a short time and then
+// park the calling thread until the queue becomes non-full or non-empty.
+//
+// Example:
+//
+//   MpmcRing<Task> ring(1024);
+//
+//   // Any thread.
+//   ring.Push(Task(...));
+//
+//   // Any thread.
+//   Task task;
+//   if (ring.TryPop(&task))
+//     task.Run();
+//
+template <class T>
+class MpmcRing {
+ public:
+  // Rounds |capacity| up to the next power of two, at least 2.
+  explicit MpmcRing(const size_t capacity)
+      : mask_(internal::RoundUpToPowerOfTwo(capacity < 2 ? 2 : capacity) - 1),
+        cells_(new Cell[mask_ + 1]) {
+    for (size_t i = 0; i <= mask_; i++)
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  ~MpmcRing() {
+    const auto enqueue_pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+         pos != enqueue_pos; pos++) {
+      cells_[pos & mask_].slot.Destroy();
+    }
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+  // Returns false if the queue is full.
+  template <class U>
+  bool TryPush(U&& value) {
+    size_t pos = 0;
+    if (ClaimForPush(&pos, 1) == 0)
+      return false;
+
+    auto& cell = cells_[pos & mask_];
+    cell.slot.Construct(std::forward<U>(value));
+    cell.sequence.store(pos + 1, std::memory_order_release);
+    not_empty_.NotifyAll();
+    return true;
+  }
+
+  // Returns false if the queue is empty.
+  bool TryPop(const NotNull<T*> value) {
+    size_t pos = 0;
+    if (ClaimForPop(&pos, 1) == 0)
+      return false;
+
+    auto& cell = cells_[pos & mask_];
+    cell.slot.MoveTo(value);
+    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+    not_full_.NotifyAll();
+    return true;
+  }
+
+  // Moves at most |count| elements from |values| to the queue claiming their
+  // slots with a single CAS. Returns the number of pushed elements.
+  size_t TryPushBatch(const NotNull<T*> values, const size_t count) {
+    size_t pos = 0;
+    const auto n = ClaimForPush(&pos, count);
+    for (size_t i = 0; i < n; i++) {
+      auto& cell = cells_[(pos + i) & mask_];
+      cell.slot.Construct(std::move(values[i]));
+      cell.sequence.store(pos + i + 1, std::memory_order_release);
+    }
+
+    if (n != 0)
+      not_empty_.NotifyAll();
+    return n;
+  }
+
+  // Moves at most |count| elements from the queue to |values| claiming their
+  // slots with a single CAS. Returns the number of popped elements.
+  size_t TryPopBatch(const NotNull<T*> values, const size_t count) {
+    size_t pos = 0;
+    const auto n = ClaimForPop(&pos, count);
+    for (size_t i = 0; i < n; i++) {
+      auto& cell = cells_[(pos + i) & mask_];
+      cell.slot.MoveTo(&values[i]);
+      cell.sequence.store(pos + i + mask_ + 1, std::memory_order_release);
+    }
+
+    if (n != 0)
+      not_full_.NotifyAll();
+    return n;
+  }
+
+  // Blocks while the queue is full.
+  template <class U>
+  void Push(U&& value) {
+    // |value| is moved only on success.
+    const auto try_push = [this, &value]() {
+      return TryPush(std::forward<U>(value));
+    };
+    if (internal::SpinUntil(try_push))
+      return;
+
+    while (!try_push()) {
+      const auto key = not_full_.PrepareWait();
+      if (try_push()) {
+        not_full_.CancelWait();
+        return;
+      }
+      not_full_.Wait(key);
+    }
+  }
+
+  // Blocks while the queue is empty.
+  void Pop(const NotNull<T*> value) {
+    if (internal::SpinUntil([this, value]() { return TryPop(value); }))
+      return;
+
+    while (!TryPop(value)) {
+      const auto key = not_empty_.PrepareWait();
+      if (TryPop(value)) {
+        not_empty_.CancelWait();
+        return;
+      }
+      not_empty_.Wait(key);
+    }
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    internal::RingSlot<T> slot;
+  };
+
+  // Claims at most |count| consecutive slots ready for writing. Stores the
+  // position of the first one to |pos| and returns the number of claimed
+  // slots.
+  size_t ClaimForPush(const NotNull<size_t*> pos, const size_t count) {
+    return Claim(&enqueue_pos_, pos, count, 0);
+  }
+
+  // Like ClaimForPush() but for slots ready for reading.
+  size_t ClaimForPop(const NotNull<size_t*> pos, const size_t count) {
+    return Claim(&dequeue_pos_, pos, count, 1);
+  }
+
+  // A slot at position p is ready when its sequence is p + |lag|. Such a slot
+  // can be changed only by the thread that moves |index| past it, so the
+  // scanned slots stay ready until the CAS.
+  size_t Claim(const NotNull<std::atomic<size_t>*> index,
+               const NotNull<size_t*> pos, const size_t count,
+               const size_t lag) {
+    if (count == 0)
+      return 0;
+
+    auto current = index->load(std::memory_order_relaxed);
+    while (true) {
+      size_t n = 0;
+      for (; n < count && n <= mask_; n++) {
+        const auto sequence = cells_[(current + n) & mask_].sequence.load(
+            std::memory_order_acquire);
+        const auto diff = static_cast<intptr_t>(sequence) -
+                          static_cast<intptr_t>(current + n + lag);
+        if (diff == 0)
+          continue;
+
+        // The queue is full or empty.
+        if (n == 0 && diff < 0)
+          return 0;
+
+        break;
+      }
+
+      // Another thread has claimed the first slot.
+      if (n == 0) {
+        current = index->load(std::memory_order_relaxed);
+        continue;
+      }
+
+      if (index->compare_exchange_weak(current, current + n,
+                                       std::memory_order_relaxed)) {
+        *pos = current;
+        return n;
+      }
+    }
+  }
+
+  alignas(internal::kCacheLineSize) std::atomic<size_t> enqueue_pos_{0};
+  alignas(internal::kCacheLineSize) std::atomic<size_t> dequeue_pos_{0};
+
+  alignas(internal::kCacheLineSize) const size_t mask_;
+  const std::unique_ptr<Cell[]> cells_;
+
+  alignas(internal::kCacheLineSize) internal::EventCount not_full_;
+  alignas(internal::kCacheLineSize) internal::EventCount not_empty_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(MpmcRing);
+};
+
+}  // namespace rst
+
+#endif  // RST_THREADING_MPMC_RING_H_
@@ -0,0 +1,179 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/threading/mpmc_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace rst {
+
+TEST(MpmcRing, Capacity) {
+  EXPECT_EQ(MpmcRing<int>(1).capacity(), 2U);
+  EXPECT_EQ(MpmcRing<int>(3).capacity(), 4U);
+  EXPECT_EQ(MpmcRing<int>(1000).capacity(), 1024U);
+}
+
+TEST(MpmcRing, TryPushTryPop) {
+  MpmcRing<int> ring(4);
+
+  int value = 0;
+  EXPECT_FALSE(ring.TryPop(&value));
+
+  for (auto i = 0; i < 4; i++)
+    EXPECT_TRUE(ring.TryPush(i));
+  EXPECT_FALSE(ring.TryPush(4));
+
+  for (auto i = 0; i < 4; i++) {
+    EXPECT_TRUE(ring.TryPop(&value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(ring.TryPop(&value));
+}
+
+TEST(MpmcRing, Batch) {
+  MpmcRing<std::string> ring(4);
+
+  std::string input[] = {"a", "b", "c", "d", "e", "f"};
+  EXPECT_EQ(ring.TryPushBatch(input, 0), 0U);
+  EXPECT_EQ(ring.TryPushBatch(input, 6), 4U);
+  EXPECT_EQ(ring.TryPushBatch(input + 4, 2), 0U);
+
+  std::string output[6];
+  EXPECT_EQ(ring.TryPopBatch(output, 3), 3U);
+  EXPECT_EQ(output[0], "a");
+  EXPECT_EQ(output[1], "b");
+  EXPECT_EQ(output[2], "c");
+
+  EXPECT_EQ(ring.TryPushBatch(input + 4, 2), 2U);
+  EXPECT_EQ(ring.TryPopBatch(output, 6), 3U);
+  EXPECT_EQ(output[0], "d");
+  EXPECT_EQ(output[1], "e");
+  EXPECT_EQ(output[2], "f");
+
+  EXPECT_EQ(ring.TryPopBatch(output, 6), 0U);
+}
+
+TEST(MpmcRing, DestroysRemainingElements) {
+  auto value = std::make_shared<int>(0);
+  {
+    MpmcRing<std::shared_ptr<int>> ring(4);
+    EXPECT_TRUE(ring.TryPush(value));
+    EXPECT_TRUE(ring.TryPush(value));
+    EXPECT_EQ(value.use_count(), 3);
+  }
+  EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(MpmcRing, Concurrently) {
+  static constexpr size_t kThreadNumber = 4;
+  static constexpr size_t kNumberPerThread = 20000;
+
+  MpmcRing<size_t> ring(32);
+  std::mutex mutex;
+  std::vector<size_t> popped;
+  popped.reserve(kThreadNumber * kNumberPerThread);
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreadNumber; i++) {
+    threads.emplace_back([&ring, i]() {
+      for (size_t j = 0; j < kNumberPerThread; j++)
+        ring.Push(i * kNumberPerThread + j);
+    });
+    threads.emplace_back([&ring, &mutex, &popped]() {
+      std::vector<size_t> local;
+      size_t value = 0;
+      for (size_t j = 0; j < kNumberPerThread; j++) {
+        ring.Pop(&value);
+        local.emplace_back(value);
+      }
+
+      std::lock_guard lock(mutex);
+      popped.insert(popped.end(), local.cbegin(), local.cend());
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  std::sort(popped.begin(), popped.end());
+  for (size_t i = 0; i < popped.size(); i++)
+    EXPECT_EQ(popped[i], i);
+  EXPECT_EQ(popped.size(), kThreadNumber * kNumberPerThread);
+}
+
+TEST(MpmcRing, BatchConcurrently) {
+  static constexpr size_t kThreadNumber = 4;
+  static constexpr size_t kNumberPerThread = 20000;
+  static constexpr size_t kBatchSize = 5;
+
+  MpmcRing<size_t> ring(32);
+  std::atomic<size_t> sum = 0;
+  std::atomic<size_t> count = 0;
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreadNumber; i++) {
+    threads.emplace_back([&ring]() {
+      size_t batch[kBatchSize];
+      for (size_t j = 0; j < kNumberPerThread; j += kBatchSize) {
+        for (size_t k = 0; k < kBatchSize; k++)
+          batch[k] = j + k;
+        for (size_t pushed = 0; pushed < kBatchSize;) {
+          pushed += ring.TryPushBatch(batch + pushed, kBatchSize - pushed);
+          std::this_thread::yield();
+        }
+      }
+    });
+    threads.emplace_back([&ring, &sum, &count]() {
+      size_t batch[kBatchSize];
+      while (count.load() < kThreadNumber * kNumberPerThread) {
+        const auto n = ring.TryPopBatch(batch, kBatchSize);
+        for (size_t k = 0; k < n; k++)
+          sum += batch[k];
+        count += n;
+        if (n == 0)
+          std::this_thread::yield();
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(count, kThreadNumber * kNumberPerThread);
+  EXPECT_EQ(sum, kThreadNumber * kNumberPerThread * (kNumberPerThread - 1) / 2);
+}
+
+}  // namespace rst
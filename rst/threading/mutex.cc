@@ -0,0 +1,239 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/threading/mutex.h"
+
+#include "rst/check/check.h"
+#include "rst/no_destructor/no_destructor.h"
+
+namespace chrono = std::chrono;
+
+namespace rst {
+
+#if RST_BUILDFLAG(MUTEX_PROFILING)
+
+namespace {
+
+// Guards the registry of the alive mutexes. It's a plain std::mutex to not
+// profile itself.
+std::mutex& GetRegistryMutex() {
+  static NoDestructor<std::mutex> mutex;
+  return *mutex;
+}
+
+Mutex* g_registry_head = nullptr;
+
+size_t GetHistogramBucket(const chrono::nanoseconds duration) {
+  auto ns = static_cast<uint64_t>(duration.count() > 0 ? duration.count() : 0);
+  size_t bucket = 0;
+  while (ns > 1 && bucket < kMutexHistogramSize - 1) {
+    ns >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+void Increment(const NotNull<std::atomic<uint64_t>*> counter) {
+  // Only the owner of the mutex writes, so no read-modify-write is needed.
+  counter->store(counter->load(std::memory_order_relaxed) + 1,
+                 std::memory_order_relaxed);
+}
+
+}  // namespace
+
+Mutex::Mutex(const char* name) : name_(name) {
+  for (auto& site : sites_) {
+    for (auto& bucket : site.wait_time_histogram)
+      bucket.store(0, std::memory_order_relaxed);
+    for (auto& bucket : site.hold_time_histogram)
+      bucket.store(0, std::memory_order_relaxed);
+  }
+
+  std::lock_guard lock(GetRegistryMutex());
+  next_ = g_registry_head;
+  if (next_ != nullptr)
+    next_->prev_ = this;
+  g_registry_head = this;
+}
+
+Mutex::~Mutex() {
+  std::lock_guard lock(GetRegistryMutex());
+  if (prev_ != nullptr)
+    prev_->next_ = next_;
+  else
+    g_registry_head = next_;
+
+  if (next_ != nullptr)
+    next_->prev_ = prev_;
+}
+
+void Mutex::Lock(const char* file, const int line) {
+  if (mutex_.try_lock()) {
+    OnAcquired(file, line, false, chrono::nanoseconds::zero());
+    return;
+  }
+
+  const auto start = chrono::steady_clock::now();
+  mutex_.lock();
+  OnAcquired(file, line, true, chrono::steady_clock::now() - start);
+}
+
+bool Mutex::TryLock(const char* file, const int line) {
+  if (!mutex_.try_lock())
+    return false;
+
+  OnAcquired(file, line, false, chrono::nanoseconds::zero());
+  return true;
+}
+
+void Mutex::Unlock() {
+  OnReleasing();
+  mutex_.unlock();
+}
+
+void Mutex::OnAcquired(const char* file, const int line, const bool contended,
+                       const chrono::nanoseconds wait_time) {
+  auto site = &sites_.back();
+  for (auto& s : sites_) {
+    const auto site_file = s.file.load(std::memory_order_relaxed);
+    if (site_file == nullptr && &s != &sites_.back()) {
+      s.file.store(file, std::memory_order_relaxed);
+      s.line.store(line, std::memory_order_relaxed);
+      site = &s;
+      break;
+    }
+
+    if (site_file == file && s.line.load(std::memory_order_relaxed) == line) {
+      site = &s;
+      break;
+    }
+  }
+
+  Increment(&site->acquisitions);
+  if (contended) {
+    Increment(&site->contended_acquisitions);
+    Increment(&site->wait_time_histogram[GetHistogramBucket(wait_time)]);
+  }
+
+  owner_site_ = site;
+  acquired_time_ = chrono::steady_clock::now();
+}
+
+void Mutex::OnReleasing() {
+  RST_DCHECK(owner_site_ != nullptr);
+  const auto hold_time = chrono::steady_clock::now() - acquired_time_;
+  Increment(&owner_site_->hold_time_histogram[GetHistogramBucket(hold_time)]);
+  owner_site_ = nullptr;
+}
+
+MutexProfile Mutex::GetProfile() const {
+  MutexProfile profile;
+  profile.name = name_;
+
+  for (const auto& site : sites_) {
+    const auto acquisitions = site.acquisitions.load(std::memory_order_relaxed);
+    if (acquisitions == 0)
+      continue;
+
+    MutexSiteProfile site_profile;
+    site_profile.file = site.file.load(std::memory_order_relaxed);
+    site_profile.line = site.line.load(std::memory_order_relaxed);
+    site_profile.acquisitions = acquisitions;
+    site_profile.contended_acquisitions =
+        site.contended_acquisitions.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kMutexHistogramSize; i++) {
+      site_profile.wait_time_histogram[i] =
+          site.wait_time_histogram[i].load(std::memory_order_relaxed);
+      site_profile.hold_time_histogram[i] =
+          site.hold_time_histogram[i].load(std::memory_order_relaxed);
+    }
+    profile.sites.emplace_back(site_profile);
+  }
+
+  return profile;
+}
+
+std::vector<MutexProfile> GetMutexProfiles() {
+  std::vector<MutexProfile> profiles;
+
+  std::lock_guard lock(GetRegistryMutex());
+  for (auto mutex = g_registry_head; mutex != nullptr; mutex = mutex->next_)
+    profiles.emplace_back(mutex->GetProfile());
+
+  return profiles;
+}
+
+#else  // RST_BUILDFLAG(MUTEX_PROFILING)
+
+std::vector<MutexProfile> GetMutexProfiles() {
+  return std::vector<MutexProfile>();
+}
+
+#endif  // RST_BUILDFLAG(MUTEX_PROFILING)
+
+ConditionVariable::ConditionVariable() = default;
+
+ConditionVariable::~ConditionVariable() = default;
+
+void ConditionVariable::Wait(const NotNull<MutexLock*> lock) {
+  const auto mutex = lock->mutex_;
+#if RST_BUILDFLAG(MUTEX_PROFILING)
+  const auto site = mutex->owner_site_;
+  mutex->OnReleasing();
+#endif  // RST_BUILDFLAG(MUTEX_PROFILING)
+
+  std::unique_lock unique_lock(mutex->mutex_, std::adopt_lock);
+  cv_.wait(unique_lock);
+  unique_lock.release();
+
+#if RST_BUILDFLAG(MUTEX_PROFILING)
+  mutex->owner_site_ = site;
+  mutex->acquired_time_ = chrono::steady_clock::now();
+#endif  // RST_BUILDFLAG(MUTEX_PROFILING)
+}
+
+std::cv_status ConditionVariable::WaitFor(const NotNull<MutexLock*> lock,
+                                          const chrono::nanoseconds timeout) {
+  const auto mutex = lock->mutex_;
+#if RST_BUILDFLAG(MUTEX_PROFILING)
+  const auto site = mutex->owner_site_;
+  mutex->OnReleasing();
+#endif  // RST_BUILDFLAG(MUTEX_PROFILING)
+
+  std::unique_lock unique_lock(mutex->mutex_, std::adopt_lock);
+  const auto status = cv_.wait_for(unique_lock, timeout);
+  unique_lock.release();
+
+#if RST_BUILDFLAG(MUTEX_PROFILING)
+  mutex->owner_site_ = site;
+  mutex->acquired_time_ = chrono::steady_clock::now();
+#endif  // RST_BUILDFLAG(MUTEX_PROFILING)
+
+  return status;
+}
+
+}  // namespace rst
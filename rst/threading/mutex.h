@@ -0,0 +1,220 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_THREADING_MUTEX_H_
+#define RST_THREADING_MUTEX_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "rst/macros/macros.h"
+#include "rst/not_null/not_null.h"
+
+// Set by the RST_ENABLE_MUTEX_PROFILING CMake option.
+#if defined(RST_ENABLE_MUTEX_PROFILING)
+#define RST_BUILDFLAG_MUTEX_PROFILING() (true)
+#else
+#define RST_BUILDFLAG_MUTEX_PROFILING() (false)
+#endif
+
+namespace rst {
+
+// Number of power-of-two buckets in the time histograms. Bucket i counts
+// durations in [2^i, 2^(i + 1)) nanoseconds, the last one counts all the
+// longer durations.
+constexpr size_t kMutexHistogramSize = 32;
+
+// Contention statistics of one place in the code that acquires a mutex.
+struct MutexSiteProfile {
+  // Acquire site. |file| is nullptr for the sites that didn't fit into the
+  // per-mutex table.
+  const char* file = nullptr;
+  int line = 0;
+
+  uint64_t acquisitions = 0;
+  // Acquisitions that had to wait for another owner.
+  uint64_t contended_acquisitions = 0;
+
+  std::array<uint64_t, kMutexHistogramSize> wait_time_histogram = {};
+  std::array<uint64_t, kMutexHistogramSize> hold_time_histogram = {};
+};
+
+struct MutexProfile {
+  const char* name = nullptr;
+  std::vector<MutexSiteProfile> sites;
+};
+
+// A std::mutex wrapper that can collect contention statistics. Without the
+// MUTEX_PROFILING build flag it's a plain std::mutex with no overhead.
+//
+// Example:
+//
+//   class Foo {
+//    public:
+//     void Bar() {
+//       MutexLock lock(&mutex_);
+//       ...
+//     }
+//
+//    private:
+//     Mutex mutex_{"Foo"};
+//   };
+//
+//   // Finds hot locks.
+//   for (const auto& profile : GetMutexProfiles())
+//     ...
+//
+class Mutex {
+ public:
+#if RST_BUILDFLAG(MUTEX_PROFILING)
+  // |name| must outlive the mutex. It's used only in profiles.
+  explicit Mutex(const char* name = nullptr);
+  ~Mutex();
+
+  void Lock(const char* file = __builtin_FILE(), int line = __builtin_LINE());
+  bool TryLock(const char* file = __builtin_FILE(),
+               int line = __builtin_LINE());
+  void Unlock();
+
+  // Returns a snapshot of the statistics.
+  MutexProfile GetProfile() const;
+#else
+  explicit Mutex(const char* = nullptr) {}
+  ~Mutex() = default;
+
+  void Lock() { mutex_.lock(); }
+  bool TryLock() { return mutex_.try_lock(); }
+  void Unlock() { mutex_.unlock(); }
+
+  MutexProfile GetProfile() const { return MutexProfile(); }
+#endif  // RST_BUILDFLAG(MUTEX_PROFILING)
+
+ private:
+  friend class ConditionVariable;
+
+  std::mutex mutex_;
+
+#if RST_BUILDFLAG(MUTEX_PROFILING)
+  friend std::vector<MutexProfile> GetMutexProfiles();
+
+  struct Site {
+    std::atomic<const char*> file{nullptr};
+    std::atomic<int> line{0};
+    std::atomic<uint64_t> acquisitions{0};
+    std::atomic<uint64_t> contended_acquisitions{0};
+    std::array<std::atomic<uint64_t>, kMutexHistogramSize> wait_time_histogram;
+    std::array<std::atomic<uint64_t>, kMutexHistogramSize> hold_time_histogram;
+  };
+
+  static constexpr size_t kMaxSiteNumber = 8;
+
+  // Called with |mutex_| held.
+  void OnAcquired(const char* file, int line, bool contended,
+                  std::chrono::nanoseconds wait_time);
+  void OnReleasing();
+
+  const char* const name_;
+
+  // Written only with |mutex_| held, read by GetProfile() at any time. The
+  // last site collects all the sites that didn't fit into the table.
+  std::array<Site, kMaxSiteNumber> sites_;
+
+  // The site and the time of the current acquisition.
+  Site* owner_site_ = nullptr;
+  std::chrono::steady_clock::time_point acquired_time_;
+
+  // Registry of the alive mutexes.
+  Mutex* prev_ = nullptr;
+  Mutex* next_ = nullptr;
+#endif  // RST_BUILDFLAG(MUTEX_PROFILING)
+
+  RST_DISALLOW_COPY_AND_ASSIGN(Mutex);
+};
+
+// Returns snapshots of all the alive mutexes. Empty without the
+// MUTEX_PROFILING build flag.
+std::vector<MutexProfile> GetMutexProfiles();
+
+// RAII lock of a Mutex. In profiling builds records the place where it's
+// constructed as the acquire site.
+class MutexLock {
+ public:
+#if RST_BUILDFLAG(MUTEX_PROFILING)
+  explicit MutexLock(const NotNull<Mutex*> mutex,
+                     const char* file = __builtin_FILE(),
+                     const int line = __builtin_LINE())
+      : mutex_(mutex) {
+    mutex_->Lock(file, line);
+  }
+#else
+  explicit MutexLock(const NotNull<Mutex*> mutex) : mutex_(mutex) {
+    mutex_->Lock();
+  }
+#endif  // RST_BUILDFLAG(MUTEX_PROFILING)
+
+  ~MutexLock() { mutex_->Unlock(); }
+
+ private:
+  friend class ConditionVariable;
+
+  const NotNull<Mutex*> mutex_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(MutexLock);
+};
+
+// A condition variable that works with MutexLock. Time spent in waiting is not
+// counted as the mutex hold time.
+class ConditionVariable {
+ public:
+  ConditionVariable();
+  ~ConditionVariable();
+
+  // Atomically releases the mutex and blocks until notified. Can wake up
+  // spuriously.
+  void Wait(NotNull<MutexLock*> lock);
+
+  // Like Wait() but also wakes up after |timeout|.
+  std::cv_status WaitFor(NotNull<MutexLock*> lock,
+                         std::chrono::nanoseconds timeout);
+
+  void NotifyOne() { cv_.notify_one(); }
+  void NotifyAll() { cv_.notify_all(); }
+
+ private:
+  std::condition_variable cv_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(ConditionVariable);
+};
+
+}  // namespace rst
+
+#endif  // RST_THREADING_MUTEX_H_
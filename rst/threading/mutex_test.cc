@@ -0,0 +1,192 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/threading/mutex.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace chrono = std::chrono;
+
+namespace rst {
+
+TEST(Mutex, LockUnlock) {
+  Mutex mutex;
+  mutex.Lock();
+  EXPECT_FALSE(mutex.TryLock());
+  mutex.Unlock();
+
+  EXPECT_TRUE(mutex.TryLock());
+  mutex.Unlock();
+}
+
+TEST(Mutex, MutexLock) {
+  static constexpr size_t kThreadNumber = 4;
+  static constexpr size_t kIterationNumber = 1000;
+
+  Mutex mutex;
+  size_t counter = 0;
+
+  std::vector<std::thread> threads;
+  threads.reserve(kThreadNumber);
+  for (size_t i = 0; i < kThreadNumber; i++) {
+    threads.emplace_back([&mutex, &counter]() {
+      for (size_t j = 0; j < kIterationNumber; j++) {
+        MutexLock lock(&mutex);
+        counter++;
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(counter, kThreadNumber * kIterationNumber);
+}
+
+TEST(ConditionVariable, Wait) {
+  Mutex mutex;
+  ConditionVariable cv;
+  auto is_ready = false;
+
+  std::thread thread([&mutex, &cv, &is_ready]() {
+    {
+      MutexLock lock(&mutex);
+      is_ready = true;
+    }
+    cv.NotifyOne();
+  });
+
+  {
+    MutexLock lock(&mutex);
+    while (!is_ready)
+      cv.Wait(&lock);
+  }
+
+  thread.join();
+}
+
+TEST(ConditionVariable, WaitFor) {
+  Mutex mutex;
+  ConditionVariable cv;
+
+  MutexLock lock(&mutex);
+  EXPECT_EQ(cv.WaitFor(&lock, chrono::milliseconds(1)),
+            std::cv_status::timeout);
+  // The lock is held again.
+  EXPECT_FALSE(mutex.TryLock());
+}
+
+#if RST_BUILDFLAG(MUTEX_PROFILING)
+TEST(Mutex, Profile) {
+  Mutex mutex("Test");
+
+  for (auto i = 0; i < 3; i++) {
+    MutexLock lock(&mutex);
+  }
+  EXPECT_TRUE(mutex.TryLock());
+  mutex.Unlock();
+
+  const auto profile = mutex.GetProfile();
+  EXPECT_EQ(std::strcmp(profile.name, "Test"), 0);
+  ASSERT_EQ(profile.sites.size(), 2U);
+
+  uint64_t acquisitions = 0;
+  for (const auto& site : profile.sites) {
+    ASSERT_NE(site.file, nullptr);
+    EXPECT_NE(std::strstr(site.file, "mutex_test.cc"), nullptr);
+    EXPECT_EQ(site.contended_acquisitions, 0U);
+
+    uint64_t hold_count = 0;
+    for (const auto count : site.hold_time_histogram)
+      hold_count += count;
+    EXPECT_EQ(hold_count, site.acquisitions);
+
+    acquisitions += site.acquisitions;
+  }
+  EXPECT_EQ(acquisitions, 4U);
+}
+
+TEST(Mutex, Contention) {
+  Mutex mutex("Contended");
+  auto is_locked = false;
+
+  mutex.Lock();
+  std::thread thread([&mutex, &is_locked]() {
+    MutexLock lock(&mutex);
+    is_locked = true;
+  });
+  std::this_thread::sleep_for(chrono::milliseconds(10));
+  mutex.Unlock();
+  thread.join();
+
+  EXPECT_TRUE(is_locked);
+
+  uint64_t contended_acquisitions = 0;
+  for (const auto& site : mutex.GetProfile().sites)
+    contended_acquisitions += site.contended_acquisitions;
+  EXPECT_EQ(contended_acquisitions, 1U);
+}
+
+TEST(Mutex, Registry) {
+  auto count_test_mutexes = []() {
+    size_t count = 0;
+    for (const auto& profile : GetMutexProfiles()) {
+      if (profile.name != nullptr &&
+          std::strcmp(profile.name, "Registry") == 0) {
+        count++;
+      }
+    }
+    return count;
+  };
+
+  EXPECT_EQ(count_test_mutexes(), 0U);
+  {
+    Mutex mutex1("Registry");
+    Mutex mutex2("Registry");
+    EXPECT_EQ(count_test_mutexes(), 2U);
+  }
+  EXPECT_EQ(count_test_mutexes(), 0U);
+}
+#else
+TEST(Mutex, NoProfile) {
+  Mutex mutex("Test");
+  {
+    MutexLock lock(&mutex);
+  }
+  EXPECT_TRUE(mutex.GetProfile().sites.empty());
+  EXPECT_TRUE(GetMutexProfiles().empty());
+}
+#endif  // RST_BUILDFLAG(MUTEX_PROFILING)
+
+}  // namespace rst
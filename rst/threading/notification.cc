@@ -0,0 +1,86 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/threading/notification.h"
+
+#include "rst/check/check.h"
+#include "rst/threading/futex.h"
+#include "rst/threading/spin_pause.h"
+
+namespace chrono = std::chrono;
+
+namespace rst {
+
+Notification::Notification() = default;
+
+Notification::~Notification() = default;
+
+void Notification::Notify() {
+  const auto state = state_.exchange(kNotified, std::memory_order_acq_rel);
+  RST_DCHECK(state != kNotified && "Notify() is called more than once");
+  if (state == kWaiting)
+    internal::FutexWakeAll(&state_);
+}
+
+bool Notification::PrepareToWait() {
+  if (internal::SpinUntil([this]() { return HasBeenNotified(); }))
+    return false;
+
+  auto state = kNotNotified;
+  if (!state_.compare_exchange_strong(state, kWaiting,
+                                      std::memory_order_acquire)) {
+    return state != kNotified;
+  }
+
+  return true;
+}
+
+void Notification::WaitForNotification() {
+  if (!PrepareToWait())
+    return;
+
+  while (!HasBeenNotified())
+    internal::FutexWait(&state_, kWaiting);
+}
+
+bool Notification::WaitForNotificationWithTimeout(
+    const chrono::nanoseconds timeout) {
+  if (!PrepareToWait())
+    return true;
+
+  const auto deadline = chrono::steady_clock::now() + timeout;
+  while (!HasBeenNotified()) {
+    if (!internal::FutexWaitFor(&state_, kWaiting,
+                                deadline - chrono::steady_clock::now())) {
+      return HasBeenNotified();
+    }
+  }
+
+  return true;
+}
+
+}  // namespace rst
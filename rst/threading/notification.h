@@ -0,0 +1,91 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_THREADING_NOTIFICATION_H_
+#define RST_THREADING_NOTIFICATION_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "rst/macros/macros.h"
+
+namespace rst {
+
+// Abseil-like one-shot event. Threads can block until Notify() is called once.
+// Notifying without waiters and checking an already notified object never
+// enter the kernel.
+//
+// Example:
+//
+//   Notification shutdown;
+//
+//   std::thread worker([&shutdown]() {
+//     while (!shutdown.HasBeenNotified())
+//       DoWork();
+//   });
+//
+//   shutdown.Notify();
+//   worker.join();
+//
+class Notification {
+ public:
+  Notification();
+  ~Notification();
+
+  // Sets the notification and wakes up all the waiters. Asserts that it's
+  // called only once.
+  void Notify();
+
+  bool HasBeenNotified() const {
+    return state_.load(std::memory_order_acquire) == kNotified;
+  }
+
+  // Blocks the calling thread until Notify() is called.
+  void WaitForNotification();
+
+  // Like WaitForNotification() but gives up after |timeout|. Returns false on
+  // timeout.
+  bool WaitForNotificationWithTimeout(std::chrono::nanoseconds timeout);
+
+ private:
+  static constexpr uint32_t kNotNotified = 0;
+  static constexpr uint32_t kWaiting = 1;
+  static constexpr uint32_t kNotified = 2;
+
+  // Returns false if the notification has already happened, true if the
+  // calling thread should be parked.
+  bool PrepareToWait();
+
+  std::atomic<uint32_t> state_{kNotNotified};
+
+  RST_DISALLOW_COPY_AND_ASSIGN(Notification);
+};
+
+}  // namespace rst
+
+#endif  // RST_THREADING_NOTIFICATION_H_
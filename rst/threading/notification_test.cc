@@ -0,0 +1,89 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/threading/notification.h"
+
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace chrono = std::chrono;
+
+namespace rst {
+
+TEST(Notification, Normal) {
+  static constexpr size_t kThreadNumber = 10;
+
+  Notification notification;
+  EXPECT_FALSE(notification.HasBeenNotified());
+
+  std::vector<std::thread> threads;
+  threads.reserve(kThreadNumber);
+  for (size_t i = 0; i < kThreadNumber; i++) {
+    threads.emplace_back([&notification]() {
+      notification.WaitForNotification();
+      EXPECT_TRUE(notification.HasBeenNotified());
+    });
+  }
+
+  notification.Notify();
+  EXPECT_TRUE(notification.HasBeenNotified());
+
+  for (auto& thread : threads)
+    thread.join();
+}
+
+TEST(Notification, AlreadyNotified) {
+  Notification notification;
+  notification.Notify();
+
+  notification.WaitForNotification();
+  EXPECT_TRUE(
+      notification.WaitForNotificationWithTimeout(chrono::milliseconds(0)));
+}
+
+TEST(Notification, Timeout) {
+  Notification notification;
+  EXPECT_FALSE(
+      notification.WaitForNotificationWithTimeout(chrono::milliseconds(10)));
+  EXPECT_FALSE(notification.HasBeenNotified());
+
+  std::thread thread([&notification]() { notification.Notify(); });
+  EXPECT_TRUE(notification.WaitForNotificationWithTimeout(chrono::seconds(60)));
+  thread.join();
+}
+
+TEST(Notification, NotifyTwice) {
+  Notification notification;
+  notification.Notify();
+  EXPECT_DEATH(notification.Notify(), "");
+}
+
+}  // namespace rst
@@ -0,0 +1,196 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_THREADING_READ_MOSTLY_H_
+#define RST_THREADING_READ_MOSTLY_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "rst/defer/defer.h"
+#include "rst/macros/macros.h"
+#include "rst/not_null/not_null.h"
+#include "rst/threading/cache_line.h"
+#include "rst/threading/epoch.h"
+#include "rst/threading/mutex.h"
+#include "rst/threading/seqlock.h"
+
+namespace rst {
+namespace internal {
+
+// Small trivially copyable values are cheaper to copy under a SeqLock than to
+// reclaim.
+template <class T>
+constexpr bool kUseSeqLock = std::is_trivially_copyable<T>::value &&
+                             std::is_default_constructible<T>::value &&
+                             sizeof(T) <= 4 * kCacheLineSize;
+
+}  // namespace internal
+
+// A container for data that is read on every request but updated rarely, like
+// configuration. Readers are wait-free and never take a lock. Writers copy the
+// current value, modify the copy and publish it.
+//
+// Small trivially copyable types are stored in a SeqLock. Other types are
+// published by a pointer and the old values are freed with epoch-based
+// reclamation after all the readers that could see them have finished.
+//
+// Example:
+//
+//   struct Config {
+//     std::string host;
+//     std::vector<std::string> blacklist;
+//   };
+//
+//   ReadMostly<Config> config(Config{...});
+//
+//   // Any thread.
+//   const auto host_size =
+//       config.Read([](const Config& config) { return config.host.size(); });
+//
+//   // Any thread.
+//   config.Update([](NotNull<Config*> config) { config->host = "localhost"; });
+//
+template <class T, bool = internal::kUseSeqLock<T>>
+class ReadMostly;
+
+// Epoch-based implementation.
+template <class T>
+class ReadMostly<T, false> {
+ public:
+  template <class... Args>
+  explicit ReadMostly(Args&&... args)
+      : current_(new T(std::forward<Args>(args)...)) {}
+  ~ReadMostly() { delete current_.load(std::memory_order_relaxed); }
+
+  // Calls |reader| with the current value and returns its result. The value
+  // stays valid until |reader| returns even if it's replaced concurrently.
+  template <class Reader>
+  auto Read(Reader&& reader) const {
+    internal::EpochGuard guard;
+    return reader(std::as_const(*current_.load(std::memory_order_acquire)));
+  }
+
+  // Returns a copy of the current value.
+  T Load() const {
+    return Read([](const T& value) { return value; });
+  }
+
+  // Like Read() but async-signal-safe: instead of the epoch record of the
+  // thread, which can be allocated on the first use, the reader is counted in
+  // |signal_readers_| that writers wait for too. Only for signal handlers.
+  template <class Reader>
+  auto ReadSignalSafe(Reader&& reader) const {
+    // Sequentially consistent with the exchange in PublishLocked(): either the
+    // writer sees the counter or the reader sees the new value.
+    signal_readers_.fetch_add(1);
+    RST_DEFER([this]() { signal_readers_.fetch_sub(1); });
+    return reader(std::as_const(*current_.load()));
+  }
+
+  // Replaces the value and blocks until the old one can be freed.
+  void Store(T&& value) { Publish(std::make_unique<T>(std::move(value))); }
+
+  // Calls |modifier| with a copy of the current value and publishes it.
+  template <class Modifier>
+  void Update(Modifier&& modifier) {
+    MutexLock lock(&writer_mutex_);
+    auto value =
+        std::make_unique<T>(*current_.load(std::memory_order_relaxed));
+    modifier(NotNull(value.get()));
+    PublishLocked(std::move(value));
+  }
+
+ private:
+  void Publish(std::unique_ptr<T> value) {
+    MutexLock lock(&writer_mutex_);
+    PublishLocked(std::move(value));
+  }
+
+  void PublishLocked(std::unique_ptr<T> value) {
+    std::unique_ptr<T> old(current_.exchange(value.release()));
+    internal::EpochSynchronize();
+    while (signal_readers_.load() != 0)
+      std::this_thread::yield();
+  }
+
+  alignas(internal::kCacheLineSize) std::atomic<T*> current_;
+  // Number of the ReadSignalSafe() calls in progress.
+  mutable std::atomic<int> signal_readers_{0};
+  alignas(internal::kCacheLineSize) Mutex writer_mutex_{"ReadMostly"};
+
+  RST_DISALLOW_COPY_AND_ASSIGN(ReadMostly);
+};
+
+// SeqLock implementation.
+template <class T>
+class ReadMostly<T, true> {
+ public:
+  template <class... Args>
+  explicit ReadMostly(Args&&... args) : value_(T{std::forward<Args>(args)...}) {}
+  ~ReadMostly() = default;
+
+  // Calls |reader| with a consistent copy of the current value and returns its
+  // result.
+  template <class Reader>
+  auto Read(Reader&& reader) const {
+    const auto value = value_.Load();
+    return reader(value);
+  }
+
+  // Returns a copy of the current value.
+  T Load() const { return value_.Load(); }
+
+  // Replaces the value.
+  void Store(T&& value) {
+    MutexLock lock(&writer_mutex_);
+    value_.Store(value);
+  }
+
+  // Calls |modifier| with a copy of the current value and publishes it.
+  template <class Modifier>
+  void Update(Modifier&& modifier) {
+    MutexLock lock(&writer_mutex_);
+    auto value = value_.Load();
+    modifier(NotNull(&value));
+    value_.Store(value);
+  }
+
+ private:
+  SeqLock<T> value_;
+  alignas(internal::kCacheLineSize) Mutex writer_mutex_{"ReadMostly"};
+
+  RST_DISALLOW_COPY_AND_ASSIGN(ReadMostly);
+};
+
+}  // namespace rst
+
+#endif  // RST_THREADING_READ_MOSTLY_H_
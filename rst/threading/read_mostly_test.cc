@@ -0,0 +1,196 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/threading/read_mostly.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace rst {
+namespace {
+
+struct Config {
+  std::string name;
+  std::vector<int> values;
+};
+
+class Counted {
+ public:
+  explicit Counted(const NotNull<std::atomic<int>*> alive) : alive_(alive) {
+    (*alive_)++;
+  }
+  Counted(const Counted& other) : alive_(other.alive_) { (*alive_)++; }
+  Counted& operator=(const Counted&) = delete;
+  ~Counted() { (*alive_)--; }
+
+ private:
+  const NotNull<std::atomic<int>*> alive_;
+};
+
+}  // namespace
+
+TEST(ReadMostly, Implementation) {
+  EXPECT_TRUE(internal::kUseSeqLock<int>);
+  EXPECT_FALSE(internal::kUseSeqLock<std::string>);
+  EXPECT_FALSE(internal::kUseSeqLock<char[1024]>);
+}
+
+TEST(ReadMostly, SeqLock) {
+  ReadMostly<int> value(10);
+  EXPECT_EQ(value.Load(), 10);
+  EXPECT_EQ(value.Read([](const int i) { return i + 1; }), 11);
+
+  value.Store(20);
+  EXPECT_EQ(value.Load(), 20);
+
+  value.Update([](const NotNull<int*> i) { *i += 5; });
+  EXPECT_EQ(value.Load(), 25);
+}
+
+TEST(ReadMostly, Epoch) {
+  ReadMostly<Config> config(Config{"name", {1, 2, 3}});
+  EXPECT_EQ(config.Load().name, "name");
+  EXPECT_EQ(config.Read([](const Config& c) { return c.values.size(); }), 3U);
+
+  config.Update(
+      [](const NotNull<Config*> c) { c->values.emplace_back(4); });
+  EXPECT_EQ(config.Read([](const Config& c) { return c.values.size(); }), 4U);
+  EXPECT_EQ(config.Load().name, "name");
+
+  config.Store(Config{"other", {}});
+  EXPECT_EQ(config.Load().name, "other");
+  EXPECT_TRUE(config.Load().values.empty());
+}
+
+TEST(ReadMostly, ReadSignalSafe) {
+  ReadMostly<Config> config(Config{"name", {1, 2, 3}});
+  EXPECT_EQ(config.ReadSignalSafe([](const Config& c) { return c.name; }),
+            "name");
+
+  config.Store(Config{"other", {}});
+  EXPECT_EQ(config.ReadSignalSafe([](const Config& c) { return c.name; }),
+            "other");
+}
+
+TEST(ReadMostly, NestedRead) {
+  ReadMostly<std::string> first("first");
+  ReadMostly<std::string> second("second");
+
+  const auto result = first.Read([&second](const std::string& f) {
+    return second.Read([&f](const std::string& s) { return f + s; });
+  });
+  EXPECT_EQ(result, "firstsecond");
+}
+
+TEST(ReadMostly, FreesOldValues) {
+  std::atomic<int> alive = 0;
+  {
+    ReadMostly<Counted> value(&alive);
+    EXPECT_EQ(alive, 1);
+
+    value.Update([](NotNull<Counted*>) {});
+    EXPECT_EQ(alive, 1);
+
+    value.Store(Counted(&alive));
+    EXPECT_EQ(alive, 1);
+  }
+  EXPECT_EQ(alive, 0);
+}
+
+TEST(ReadMostly, ReadSignalSafeKeepsValue) {
+  std::atomic<int> alive = 0;
+  ReadMostly<Counted> value(&alive);
+
+  std::atomic<bool> copied = false;
+  std::thread writer;
+  value.ReadSignalSafe([&value, &alive, &copied, &writer](const Counted&) {
+    writer = std::thread([&value, &copied]() {
+      value.Update([&copied](NotNull<Counted*>) { copied = true; });
+    });
+
+    // The copy gets published but the old value isn't freed while it's read.
+    while (!copied.load())
+      std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(alive.load(), 2);
+    return 0;
+  });
+
+  writer.join();
+  EXPECT_EQ(alive.load(), 1);
+}
+
+TEST(ReadMostly, Concurrently) {
+  static constexpr size_t kReaderNumber = 4;
+  static constexpr int kUpdateNumber = 200;
+
+  ReadMostly<Config> config(Config{"0", {0}});
+  std::atomic<bool> done = false;
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kReaderNumber; i++) {
+    threads.emplace_back([&config, &done]() {
+      while (!done.load()) {
+        config.Read([](const Config& c) {
+          EXPECT_EQ(c.name, std::to_string(c.values.back()));
+          return 0;
+        });
+        std::this_thread::yield();
+      }
+    });
+  }
+
+  for (auto i = 1; i <= kUpdateNumber; i++) {
+    config.Update([i](const NotNull<Config*> c) {
+      c->name = std::to_string(i);
+      c->values.emplace_back(i);
+    });
+  }
+  done = true;
+
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(config.Load().values.size(), static_cast<size_t>(kUpdateNumber + 1));
+}
+
+TEST(ReadMostly, UpdateInsideRead) {
+  ReadMostly<std::string> value("value");
+  EXPECT_DEATH(value.Read([&value](const std::string&) {
+    value.Store("other");
+    return 0;
+  }),
+               "");
+}
+
+}  // namespace rst
@@ -0,0 +1,79 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_THREADING_RING_SLOT_H_
+#define RST_THREADING_RING_SLOT_H_
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include "rst/check/check.h"
+#include "rst/not_null/not_null.h"
+
+namespace rst {
+namespace internal {
+
+// Uninitialized storage for one element of a ring buffer.
+template <class T>
+class RingSlot {
+ public:
+  template <class U>
+  void Construct(U&& value) {
+    new (storage_) T(std::forward<U>(value));
+  }
+
+  // Moves the stored element to |value| and destroys it.
+  void MoveTo(const NotNull<T*> value) {
+    *value = std::move(*get());
+    Destroy();
+  }
+
+  void Destroy() { get()->~T(); }
+
+  NotNull<T*> get() { return std::launder(reinterpret_cast<T*>(storage_)); }
+
+ private:
+  alignas(T) unsigned char storage_[sizeof(T)];
+};
+
+// Ring buffers index slots with a mask, so their capacity is a power of two.
+inline size_t RoundUpToPowerOfTwo(const size_t value) {
+  RST_DCHECK(value > 0);
+  size_t result = 1;
+  while (result < value) {
+    RST_DCHECK(result << 1 != 0);
+    result <<= 1;
+  }
+
+  return result;
+}
+
+}  // namespace internal
+}  // namespace rst
+
+#endif  // RST_THREADING_RING_SLOT_H_
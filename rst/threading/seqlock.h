@@ -0,0 +1,133 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_THREADING_SEQLOCK_H_
+#define RST_THREADING_SEQLOCK_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "rst/macros/macros.h"
+#include "rst/threading/cache_line.h"
+#include "rst/threading/spin_pause.h"
+
+namespace rst {
+
+// Holds a trivially copyable value that is read much more often than written.
+// Readers never write shared memory: they copy the value and retry if a
+// writer has changed it meanwhile. Writers don't wait for readers.
+//
+// The value is kept as an array of atomic words, so concurrent copying is not
+// a data race.
+//
+// Example:
+//
+//   struct Limits {
+//     int max_connections;
+//     int max_requests;
+//   };
+//
+//   SeqLock<Limits> limits(Limits{10, 100});
+//
+//   // Any thread.
+//   const auto current = limits.Load();
+//
+//   // Any thread.
+//   limits.Store(Limits{20, 200});
+//
+template <class T>
+class SeqLock {
+ public:
+  static_assert(std::is_trivially_copyable<T>::value);
+  static_assert(std::is_default_constructible<T>::value);
+
+  explicit SeqLock(const T& value = T()) { Write(value); }
+  ~SeqLock() = default;
+
+  // Returns a consistent copy of the value. Wait-free unless a writer is in
+  // progress.
+  T Load() const {
+    uint64_t buffer[kWordCount];
+    while (true) {
+      const auto sequence = sequence_.load(std::memory_order_acquire);
+      if ((sequence & 1) != 0) {
+        internal::SpinPause();
+        continue;
+      }
+
+      for (size_t i = 0; i < kWordCount; i++)
+        buffer[i] = words_[i].load(std::memory_order_relaxed);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == sequence)
+        break;
+    }
+
+    T value;
+    std::memcpy(&value, buffer, sizeof(T));
+    return value;
+  }
+
+  // Replaces the value. Concurrent writers are serialized.
+  void Store(const T& value) {
+    auto sequence = sequence_.load(std::memory_order_relaxed);
+    while ((sequence & 1) != 0 ||
+           !sequence_.compare_exchange_weak(sequence, sequence + 1,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+      internal::SpinPause();
+      sequence = sequence_.load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+    Write(value);
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+ private:
+  static constexpr size_t kWordCount =
+      (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  void Write(const T& value) {
+    uint64_t buffer[kWordCount] = {};
+    std::memcpy(buffer, &value, sizeof(T));
+    for (size_t i = 0; i < kWordCount; i++)
+      words_[i].store(buffer[i], std::memory_order_relaxed);
+  }
+
+  // Odd while a writer is in progress.
+  alignas(internal::kCacheLineSize) std::atomic<uint64_t> sequence_{0};
+  std::atomic<uint64_t> words_[kWordCount];
+
+  RST_DISALLOW_COPY_AND_ASSIGN(SeqLock);
+};
+
+}  // namespace rst
+
+#endif  // RST_THREADING_SEQLOCK_H_
@@ -0,0 +1,94 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/threading/seqlock.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace rst {
+namespace {
+
+struct Pair {
+  uint64_t first = 0;
+  uint64_t second = 0;
+  char tail[3] = {};
+};
+
+}  // namespace
+
+TEST(SeqLock, Default) {
+  SeqLock<int> value;
+  EXPECT_EQ(value.Load(), 0);
+}
+
+TEST(SeqLock, LoadStore) {
+  SeqLock<Pair> value(Pair{1, 2, {'a', 'b', 'c'}});
+  auto pair = value.Load();
+  EXPECT_EQ(pair.first, 1U);
+  EXPECT_EQ(pair.second, 2U);
+  EXPECT_EQ(pair.tail[2], 'c');
+
+  value.Store(Pair{3, 4, {'d', 'e', 'f'}});
+  pair = value.Load();
+  EXPECT_EQ(pair.first, 3U);
+  EXPECT_EQ(pair.second, 4U);
+  EXPECT_EQ(pair.tail[2], 'f');
+}
+
+TEST(SeqLock, Consistency) {
+  static constexpr size_t kReaderNumber = 4;
+  static constexpr uint64_t kWriteNumber = 10000;
+
+  SeqLock<Pair> value(Pair{0, ~uint64_t{0}, {}});
+  std::atomic<bool> done = false;
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kReaderNumber; i++) {
+    threads.emplace_back([&value, &done]() {
+      while (!done.load()) {
+        const auto pair = value.Load();
+        EXPECT_EQ(pair.second, ~pair.first);
+        std::this_thread::yield();
+      }
+    });
+  }
+
+  for (uint64_t i = 0; i < kWriteNumber; i++)
+    value.Store(Pair{i, ~i, {}});
+  done = true;
+
+  for (auto& thread : threads)
+    thread.join();
+}
+
+}  // namespace rst
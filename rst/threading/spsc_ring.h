@@ -0,0 +1,232 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RST_THREADING_SPSC_RING_H_
+#define RST_THREADING_SPSC_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "rst/check/check.h"
+#include "rst/macros/macros.h"
+#include "rst/not_null/not_null.h"
+#include "rst/threading/cache_line.h"
+#include "rst/threading/event_count.h"
+#include "rst/threading/ring_slot.h"
+#include "rst/threading/spin_pause.h"
+
+namespace rst {
+
+// Bounded lock-free single-producer single-consumer queue. Only one thread can
+// push and only one thread can pop at a time.
+//
+// The producer and consumer indices live on separate cache lines and each
+// side caches the index of the other side, so the shared lines are touched
+// only when the cached view is exhausted.
+//
+// Try* methods never block. Push() and Pop() spin for a short time and then
+// park the calling thread until the queue becomes non-full or non-empty.
+//
+// Example:
+//
+//   SpscRing<std::string> ring(1024);
+//
+//   std::thread producer([&ring]() {
+//     for (auto i = 0; i < 100; i++)
+//       ring.Push(std::to_string(i));
+//   });
+//
+//   std::string value;
+//   for (auto i = 0; i < 100; i++)
+//     ring.Pop(&value);
+//
+template <class T>
+class SpscRing {
+ public:
+  // Rounds |capacity| up to the next power of two.
+  explicit SpscRing(const size_t capacity)
+      : mask_(internal::RoundUpToPowerOfTwo(capacity) - 1),
+        slots_(new internal::RingSlot<T>[mask_ + 1]) {}
+
+  ~SpscRing() {
+    const auto tail = producer_.tail.load(std::memory_order_relaxed);
+    for (auto head = consumer_.head.load(std::memory_order_relaxed);
+         head != tail; head++) {
+      slots_[head & mask_].Destroy();
+    }
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+  // Returns false if the queue is full.
+  template <class U>
+  bool TryPush(U&& value) {
+    const auto tail = producer_.tail.load(std::memory_order_relaxed);
+    if (ProducerSpace(tail, 1) == 0)
+      return false;
+
+    slots_[tail & mask_].Construct(std::forward<U>(value));
+    producer_.tail.store(tail + 1, std::memory_order_release);
+    not_empty_.NotifyAll();
+    return true;
+  }
+
+  // Returns false if the queue is empty.
+  bool TryPop(const NotNull<T*> value) {
+    const auto head = consumer_.head.load(std::memory_order_relaxed);
+    if (ConsumerSize(head, 1) == 0)
+      return false;
+
+    slots_[head & mask_].MoveTo(value);
+    consumer_.head.store(head + 1, std::memory_order_release);
+    not_full_.NotifyAll();
+    return true;
+  }
+
+  // Moves at most |count| elements from |values| to the queue publishing them
+  // at once. Returns the number of pushed elements.
+  size_t TryPushBatch(const NotNull<T*> values, const size_t count) {
+    const auto tail = producer_.tail.load(std::memory_order_relaxed);
+    const auto space = ProducerSpace(tail, count);
+    const auto n = count < space ? count : space;
+    if (n == 0)
+      return 0;
+
+    for (size_t i = 0; i < n; i++)
+      slots_[(tail + i) & mask_].Construct(std::move(values[i]));
+    producer_.tail.store(tail + n, std::memory_order_release);
+    not_empty_.NotifyAll();
+    return n;
+  }
+
+  // Moves at most |count| elements from the queue to |values| releasing their
+  // slots at once. Returns the number of popped elements.
+  size_t TryPopBatch(const NotNull<T*> values, const size_t count) {
+    const auto head = consumer_.head.load(std::memory_order_relaxed);
+    const auto size = ConsumerSize(head, count);
+    const auto n = count < size ? count : size;
+    if (n == 0)
+      return 0;
+
+    for (size_t i = 0; i < n; i++)
+      slots_[(head + i) & mask_].MoveTo(&values[i]);
+    consumer_.head.store(head + n, std::memory_order_release);
+    not_full_.NotifyAll();
+    return n;
+  }
+
+  // Blocks while the queue is full.
+  template <class U>
+  void Push(U&& value) {
+    if (internal::SpinUntil([this]() { return HasSpace(); })) {
+      RST_CHECK(TryPush(std::forward<U>(value)));
+      return;
+    }
+
+    while (!HasSpace()) {
+      const auto key = not_full_.PrepareWait();
+      if (HasSpace()) {
+        not_full_.CancelWait();
+        break;
+      }
+      not_full_.Wait(key);
+    }
+    RST_CHECK(TryPush(std::forward<U>(value)));
+  }
+
+  // Blocks while the queue is empty.
+  void Pop(const NotNull<T*> value) {
+    if (internal::SpinUntil([this, value]() { return TryPop(value); }))
+      return;
+
+    while (!TryPop(value)) {
+      const auto key = not_empty_.PrepareWait();
+      if (TryPop(value)) {
+        not_empty_.CancelWait();
+        return;
+      }
+      not_empty_.Wait(key);
+    }
+  }
+
+ private:
+  // Number of free slots as seen by the producer. Rereads the consumer index
+  // only if the cached one doesn't give |wanted| slots.
+  size_t ProducerSpace(const size_t tail, const size_t wanted) {
+    auto space = capacity() - (tail - producer_.cached_head);
+    if (space < wanted) {
+      producer_.cached_head = consumer_.head.load(std::memory_order_acquire);
+      space = capacity() - (tail - producer_.cached_head);
+    }
+    return space;
+  }
+
+  // Number of elements as seen by the consumer. Rereads the producer index
+  // only if the cached one doesn't give |wanted| elements.
+  size_t ConsumerSize(const size_t head, const size_t wanted) {
+    auto size = consumer_.cached_tail - head;
+    if (size < wanted) {
+      consumer_.cached_tail = producer_.tail.load(std::memory_order_acquire);
+      size = consumer_.cached_tail - head;
+    }
+    return size;
+  }
+
+  bool HasSpace() {
+    const auto tail = producer_.tail.load(std::memory_order_relaxed);
+    return ProducerSpace(tail, 1) != 0;
+  }
+
+  // Written by the producer only.
+  struct alignas(internal::kCacheLineSize) Producer {
+    std::atomic<size_t> tail{0};
+    size_t cached_head = 0;
+  };
+
+  // Written by the consumer only.
+  struct alignas(internal::kCacheLineSize) Consumer {
+    std::atomic<size_t> head{0};
+    size_t cached_tail = 0;
+  };
+
+  Producer producer_;
+  Consumer consumer_;
+
+  alignas(internal::kCacheLineSize) const size_t mask_;
+  const std::unique_ptr<internal::RingSlot<T>[]> slots_;
+
+  alignas(internal::kCacheLineSize) internal::EventCount not_full_;
+  alignas(internal::kCacheLineSize) internal::EventCount not_empty_;
+
+  RST_DISALLOW_COPY_AND_ASSIGN(SpscRing);
+};
+
+}  // namespace rst
+
+#endif  // RST_THREADING_SPSC_RING_H_
@@ -0,0 +1,163 @@
+// Copyright (c) 2020, Sergey Abbakumov
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rst/threading/spsc_ring.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace rst {
+
+TEST(SpscRing, Capacity) {
+  EXPECT_EQ(SpscRing<int>(1).capacity(), 1U);
+  EXPECT_EQ(SpscRing<int>(3).capacity(), 4U);
+  EXPECT_EQ(SpscRing<int>(4).capacity(), 4U);
+  EXPECT_EQ(SpscRing<int>(1000).capacity(), 1024U);
+}
+
+TEST(SpscRing, TryPushTryPop) {
+  SpscRing<int> ring(4);
+
+  int value = 0;
+  EXPECT_FALSE(ring.TryPop(&value));
+
+  for (auto i = 0; i < 4; i++)
+    EXPECT_TRUE(ring.TryPush(i));
+  EXPECT_FALSE(ring.TryPush(4));
+
+  for (auto i = 0; i < 4; i++) {
+    EXPECT_TRUE(ring.TryPop(&value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(ring.TryPop(&value));
+}
+
+TEST(SpscRing, Wraparound) {
+  SpscRing<int> ring(4);
+
+  int value = 0;
+  for (auto i = 0; i < 100; i++) {
+    EXPECT_TRUE(ring.TryPush(i));
+    EXPECT_TRUE(ring.TryPush(i + 1));
+    EXPECT_TRUE(ring.TryPop(&value));
+    EXPECT_EQ(value, i);
+    EXPECT_TRUE(ring.TryPop(&value));
+    EXPECT_EQ(value, i + 1);
+  }
+}
+
+TEST(SpscRing, Batch) {
+  SpscRing<std::string> ring(4);
+
+  std::string input[] = {"a", "b", "c", "d", "e", "f"};
+  EXPECT_EQ(ring.TryPushBatch(input, 6), 4U);
+  EXPECT_EQ(ring.TryPushBatch(input + 4, 2), 0U);
+
+  std::string output[6];
+  EXPECT_EQ(ring.TryPopBatch(output, 3), 3U);
+  EXPECT_EQ(output[0], "a");
+  EXPECT_EQ(output[1], "b");
+  EXPECT_EQ(output[2], "c");
+
+  EXPECT_EQ(ring.TryPushBatch(input + 4, 2), 2U);
+  EXPECT_EQ(ring.TryPopBatch(output, 6), 3U);
+  EXPECT_EQ(output[0], "d");
+  EXPECT_EQ(output[1], "e");
+  EXPECT_EQ(output[2], "f");
+
+  EXPECT_EQ(ring.TryPopBatch(output, 6), 0U);
+}
+
+TEST(SpscRing, DestroysRemainingElements) {
+  auto value = std::make_shared<int>(0);
+  {
+    SpscRing<std::shared_ptr<int>> ring(4);
+    EXPECT_TRUE(ring.TryPush(value));
+    EXPECT_TRUE(ring.TryPush(value));
+    EXPECT_EQ(value.use_count(), 3);
+  }
+  EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(SpscRing, Blocking) {
+  static constexpr size_t kNumber = 100000;
+
+  SpscRing<size_t> ring(16);
+
+  std::thread producer([&ring]() {
+    for (size_t i = 0; i < kNumber; i++)
+      ring.Push(i);
+  });
+
+  size_t value = 0;
+  for (size_t i = 0; i < kNumber; i++) {
+    ring.Pop(&value);
+    EXPECT_EQ(value, i);
+  }
+
+  producer.join();
+}
+
+TEST(SpscRing, BatchConcurrently) {
+  static constexpr size_t kNumber = 100000;
+  static constexpr size_t kBatchSize = 7;
+
+  SpscRing<size_t> ring(64);
+
+  std::thread producer([&ring]() {
+    size_t batch[kBatchSize];
+    for (size_t i = 0; i < kNumber;) {
+      size_t n = 0;
+      for (; n < kBatchSize && i + n < kNumber; n++)
+        batch[n] = i + n;
+
+      for (size_t pushed = 0; pushed < n;) {
+        pushed += ring.TryPushBatch(batch + pushed, n - pushed);
+        std::this_thread::yield();
+      }
+      i += n;
+    }
+  });
+
+  size_t batch[kBatchSize];
+  for (size_t expected = 0; expected < kNumber;) {
+    const auto n = ring.TryPopBatch(batch, kBatchSize);
+    for (size_t i = 0; i < n; i++)
+      EXPECT_EQ(batch[i], expected++);
+    if (n == 0)
+      std::this_thread::yield();
+  }
+
+  producer.join();
+}
+
+}  // namespace rst